@@ -0,0 +1,377 @@
+#include <memory>
+#include <random>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+#include "matcher/matching_engine.h" // the stub in benchmarks/stub, see CMakeLists.txt
+#include "utils/latency_histogram.h"
+
+// Drives one MEOrderBook directly, no queues, sockets or sleeps, with one workload per fresh book:
+// passive adds at the touch, adds deep in the book, cancels of random resting orders, aggressive orders sweeping
+// N levels and a seeded mix of all of them. Every timed call is bracketed by rdtsc and recorded in a
+// LatencyHistogram, so the percentiles include the ~20 cycles of the two reads.
+// The workloads of the other request types and time in forces also check what the book emitted against the stub
+// engine's counters by type, and abort if a path regressed into publishing or trading what it must not.
+
+using namespace Exchange;
+
+constexpr TickerId TICKER = 0;
+constexpr Price MID = 10 * 1000; // bids at and below, asks above
+constexpr Qty QTY = 100;
+constexpr ClientId NUM_CLIENTS = 16;
+constexpr Price DEEP_LEVELS = 100; // on each side
+constexpr Price WIDE_LEVELS = 6000; // on each side, wider than the ME_PRICE_LADDER_LEVELS window
+constexpr size_t NUM_ADDS = 500 * 1000;
+constexpr size_t NUM_SWEEPS = 20 * 1000;
+constexpr size_t NUM_MIXED_OPS = 2 * 1000 * 1000;
+constexpr size_t NUM_TYPED_OPS = 200 * 1000; // per workload of the other request types
+
+struct OrderKey {
+    ClientId client_id_;
+    OrderId client_order_id_;
+};
+
+// Spreads orders over NUM_CLIENTS, each with its own increasing client order ids.
+class OrderKeys final {
+public:
+    auto next() noexcept {
+        const OrderKey key = {next_ % NUM_CLIENTS, next_ / NUM_CLIENTS};
+        ++next_;
+        return key;
+    }
+
+private:
+    uint64_t next_ = 0;
+};
+
+class BookBenchmark final {
+public:
+    explicit BookBenchmark(Logger* logger) : book_(std::make_unique<MEOrderBook>(TICKER, logger, &engine_)) {}
+
+    auto add(Side side, Price price, Qty qty) noexcept {
+        const auto key = keys_.next();
+        book_->add(key.client_id_, key.client_order_id_, TICKER, side, price, qty);
+        return key;
+    }
+
+    // For the workloads that need orders of one given client.
+    auto add(const OrderKey& key, Side side, Price price, Qty qty) noexcept {
+        book_->add(key.client_id_, key.client_order_id_, TICKER, side, price, qty);
+    }
+
+    auto timedAdd(Side side, Price price, Qty qty, OrderType order_type = OrderType::LIMIT, TimeInForce time_in_force = TimeInForce::GTC) noexcept {
+        const auto key = keys_.next();
+        const auto start = Common::rdtsc();
+        book_->add(key.client_id_, key.client_order_id_, TICKER, side, price, qty, order_type, time_in_force);
+        histogram_.record(Common::rdtsc() - start);
+        return key;
+    }
+
+    auto timedCancel(const OrderKey& key) noexcept {
+        const auto start = Common::rdtsc();
+        book_->cancel(key.client_id_, key.client_order_id_, TICKER);
+        histogram_.record(Common::rdtsc() - start);
+    }
+
+    auto timedModify(const OrderKey& key, Side side, Price price, Qty qty) noexcept {
+        const auto start = Common::rdtsc();
+        book_->modify(key.client_id_, key.client_order_id_, TICKER, side, price, qty);
+        histogram_.record(Common::rdtsc() - start);
+    }
+
+    auto quote(ClientId client_id, OrderId quote_id, Price bid_price, Qty bid_qty, Price ask_price, Qty ask_qty) noexcept {
+        book_->quote(client_id, quote_id, TICKER, bid_price, bid_qty, ask_price, ask_qty);
+    }
+
+    auto timedQuote(ClientId client_id, OrderId quote_id, Price bid_price, Qty bid_qty, Price ask_price, Qty ask_qty) noexcept {
+        const auto start = Common::rdtsc();
+        book_->quote(client_id, quote_id, TICKER, bid_price, bid_qty, ask_price, ask_qty);
+        histogram_.record(Common::rdtsc() - start);
+    }
+
+    auto massCancel(ClientId client_id, Side side) noexcept {
+        book_->massCancel(client_id, TICKER, side);
+    }
+
+    auto timedMassCancel(ClientId client_id, Side side) noexcept {
+        const auto start = Common::rdtsc();
+        book_->massCancel(client_id, TICKER, side);
+        histogram_.record(Common::rdtsc() - start);
+    }
+
+    auto engine() const noexcept -> const MatchingEngine& { return engine_; }
+
+    auto report(const std::string& name) const {
+        const auto snapshot = histogram_.snapshot(Common::TscClock::instance().nsPerTick());
+        std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+                  << " ops:" << std::setw(8) << snapshot.count_ << " ns/op:" << std::setw(8) << snapshot.mean_
+                  << " p50:" << std::setw(8) << snapshot.p50_ << " p90:" << std::setw(8) << snapshot.p90_
+                  << " p99:" << std::setw(8) << snapshot.p99_ << " p99.9:" << std::setw(9) << snapshot.p999_
+                  << " max:" << std::setw(10) << snapshot.max_
+                  << " responses:" << engine_.numClientResponses() << " updates:" << engine_.numMarketUpdates() << std::endl;
+    }
+
+    BookBenchmark(const BookBenchmark&) = delete;
+    BookBenchmark(const BookBenchmark&&) = delete;
+    BookBenchmark& operator=(const BookBenchmark&) = delete;
+    BookBenchmark& operator=(const BookBenchmark&&) = delete;
+
+private:
+    MatchingEngine engine_;
+    std::unique_ptr<MEOrderBook> book_;
+    OrderKeys keys_;
+    Common::LatencyHistogram histogram_;
+};
+
+// Alternating bids at MID and asks at MID + 1: every add joins the back of the best level's queue.
+auto passiveAddsAtTouch(Logger* logger) {
+    BookBenchmark benchmark(logger);
+    for (size_t i = 0; i < NUM_ADDS; ++i)
+        benchmark.timedAdd((i & 1 ? Side::SELL : Side::BUY), (i & 1 ? MID + 1 : MID), QTY);
+    benchmark.report("passive adds at touch");
+}
+
+// Uniformly over DEEP_LEVELS levels per side, so most adds walk the price-level list away from the top.
+auto deepBookAdds(Logger* logger, std::mt19937_64& rng) {
+    BookBenchmark benchmark(logger);
+    for (size_t i = 0; i < NUM_ADDS; ++i) {
+        const auto depth = static_cast<Price>(rng() % DEEP_LEVELS);
+        benchmark.timedAdd((i & 1 ? Side::SELL : Side::BUY), (i & 1 ? MID + 1 + depth : MID - depth), QTY);
+    }
+    benchmark.report("deep book adds");
+}
+
+// Uniformly over WIDE_LEVELS levels per side: the levels beyond the ladder window around the touch go to its map.
+auto wideBookAdds(Logger* logger, std::mt19937_64& rng) {
+    BookBenchmark benchmark(logger);
+    for (size_t i = 0; i < NUM_ADDS; ++i) {
+        const auto depth = static_cast<Price>(rng() % WIDE_LEVELS);
+        benchmark.timedAdd((i & 1 ? Side::SELL : Side::BUY), (i & 1 ? MID + 1 + depth : MID - depth), QTY);
+    }
+    benchmark.report("wide book adds");
+}
+
+// Fills a deep book untimed, then cancels every resting order in random order.
+auto randomCancels(Logger* logger, std::mt19937_64& rng) {
+    BookBenchmark benchmark(logger);
+    std::vector<OrderKey> resting;
+    resting.reserve(NUM_ADDS);
+    for (size_t i = 0; i < NUM_ADDS; ++i) {
+        const auto depth = static_cast<Price>(rng() % DEEP_LEVELS);
+        resting.push_back(benchmark.add((i & 1 ? Side::SELL : Side::BUY), (i & 1 ? MID + 1 + depth : MID - depth), QTY));
+    }
+    std::shuffle(resting.begin(), resting.end(), rng);
+    for (const auto& key : resting)
+        benchmark.timedCancel(key);
+    benchmark.report("random cancels");
+}
+
+// Rebuilds num_levels ask levels of ORDERS_PER_LEVEL orders untimed, then times one buy that takes all of them.
+auto aggressiveSweeps(Logger* logger, Price num_levels) {
+    constexpr size_t ORDERS_PER_LEVEL = 4;
+    BookBenchmark benchmark(logger);
+    for (size_t i = 0; i < NUM_SWEEPS; ++i) {
+        for (Price level = 0; level < num_levels; ++level) {
+            for (size_t j = 0; j < ORDERS_PER_LEVEL; ++j)
+                benchmark.add(Side::SELL, MID + 1 + level, QTY);
+        }
+        benchmark.timedAdd(Side::BUY, MID + num_levels, static_cast<Qty>(num_levels * ORDERS_PER_LEVEL * QTY));
+    }
+    benchmark.report("sweep " + std::to_string(num_levels) + " levels");
+}
+
+// Seeded order flow around a fixed mid: half passive adds up to 20 levels behind the touch, 40% cancels of a random
+// order this flow added (which may have been filled meanwhile, exercising the reject path) and 10% aggressive
+// orders crossing up to 3 levels, whose remainder rests.
+auto mixedFlow(Logger* logger, std::mt19937_64& rng) {
+    BookBenchmark benchmark(logger);
+    std::vector<OrderKey> live;
+    live.reserve(NUM_MIXED_OPS);
+    for (size_t i = 0; i < NUM_MIXED_OPS; ++i) {
+        const auto action = rng() % 100;
+        const auto side = (rng() & 1 ? Side::BUY : Side::SELL);
+        if (action < 50 || live.empty()) {
+            const auto depth = static_cast<Price>(rng() % 20);
+            live.push_back(benchmark.timedAdd(side, (side == Side::BUY ? MID - depth : MID + 1 + depth), QTY * static_cast<Qty>(1 + rng() % 5)));
+        } else if (action < 90) {
+            const auto idx = rng() % live.size();
+            benchmark.timedCancel(live[idx]);
+            live[idx] = live.back();
+            live.pop_back();
+        } else {
+            const auto levels = static_cast<Price>(rng() % 3);
+            live.push_back(benchmark.timedAdd(side, (side == Side::BUY ? MID + 1 + levels : MID - levels), QTY * static_cast<Qty>(1 + rng() % 10)));
+        }
+    }
+    benchmark.report("mixed flow");
+}
+
+struct RestingOrder {
+    OrderKey key_;
+    Side side_;
+    Price price_;
+};
+
+// Fills a deep book untimed, then modifies every order in random order: at its price for less quantity, which
+// must be one MODIFY keeping its place, or one level further from the touch, a CANCEL and an ADD.
+auto modifies(Logger* logger, std::mt19937_64& rng, bool reprice) {
+    BookBenchmark benchmark(logger);
+    std::vector<RestingOrder> resting;
+    resting.reserve(NUM_TYPED_OPS);
+    for (size_t i = 0; i < NUM_TYPED_OPS; ++i) {
+        const auto depth = static_cast<Price>(rng() % DEEP_LEVELS);
+        const auto side = (i & 1 ? Side::SELL : Side::BUY);
+        const auto price = (side == Side::SELL ? MID + 1 + depth : MID - depth);
+        resting.push_back({benchmark.add(side, price, QTY), side, price});
+    }
+    std::shuffle(resting.begin(), resting.end(), rng);
+    for (const auto& order : resting) {
+        if (reprice)
+            benchmark.timedModify(order.key_, order.side_, (order.side_ == Side::SELL ? order.price_ + 1 : order.price_ - 1), QTY);
+        else
+            benchmark.timedModify(order.key_, order.side_, order.price_, QTY / 2);
+    }
+    const auto& engine = benchmark.engine();
+    ASSERT(engine.numClientResponses(ClientResponseType::MODIFIED) == NUM_TYPED_OPS && engine.numMarketUpdates(MarketUpdateType::TRADE) == 0,
+           "MODIFY rejected or traded");
+    if (reprice)
+        ASSERT(engine.numMarketUpdates(MarketUpdateType::CANCEL) == NUM_TYPED_OPS && engine.numMarketUpdates(MarketUpdateType::ADD) == 2 * NUM_TYPED_OPS,
+               "repricing MODIFY is not a CANCEL and an ADD");
+    else
+        ASSERT(engine.numMarketUpdates(MarketUpdateType::MODIFY) == NUM_TYPED_OPS && engine.numMarketUpdates(MarketUpdateType::CANCEL) == 0 &&
+               engine.numMarketUpdates(MarketUpdateType::ADD) == NUM_TYPED_OPS, "same price, less quantity MODIFY lost the order's place");
+    benchmark.report(reprice ? "modify reprice" : "modify qty down");
+}
+
+// Rebuilds one ask at the touch untimed, then times an IOC buy for twice its size: the buy fills half and its
+// residual is canceled without resting, so the asks must be the only ADDs.
+auto iocPartialFills(Logger* logger) {
+    BookBenchmark benchmark(logger);
+    for (size_t i = 0; i < NUM_TYPED_OPS; ++i) {
+        benchmark.add(Side::SELL, MID + 1, QTY);
+        benchmark.timedAdd(Side::BUY, MID + 1, 2 * QTY, OrderType::LIMIT, TimeInForce::IOC);
+    }
+    const auto& engine = benchmark.engine();
+    ASSERT(engine.numMarketUpdates(MarketUpdateType::ADD) == NUM_TYPED_OPS && engine.numMarketUpdates(MarketUpdateType::TRADE) == NUM_TYPED_OPS &&
+           engine.numClientResponses(ClientResponseType::CANCELED) == NUM_TYPED_OPS, "IOC residual was published or did not trade");
+    benchmark.report("IOC partial fills");
+}
+
+// FOK buys for one order more than the FOK_LEVELS ask levels hold: each walks them all, finds too little and is
+// canceled whole, so nothing may trade and the asks stay untouched.
+auto fokShortfalls(Logger* logger) {
+    constexpr Price FOK_LEVELS = 5;
+    BookBenchmark benchmark(logger);
+    for (Price level = 0; level < FOK_LEVELS; ++level)
+        benchmark.add(Side::SELL, MID + 1 + level, QTY);
+    for (size_t i = 0; i < NUM_TYPED_OPS; ++i)
+        benchmark.timedAdd(Side::BUY, MID + FOK_LEVELS, (FOK_LEVELS + 1) * QTY, OrderType::LIMIT, TimeInForce::FOK);
+    const auto& engine = benchmark.engine();
+    ASSERT(engine.numMarketUpdates(MarketUpdateType::TRADE) == 0 && engine.numClientResponses(ClientResponseType::FILLED) == 0 &&
+           engine.numClientResponses(ClientResponseType::CANCELED) == NUM_TYPED_OPS && engine.numMarketUpdates() == static_cast<size_t>(FOK_LEVELS),
+           "FOK shortfall traded part of its quantity");
+    benchmark.report("FOK shortfalls");
+}
+
+// Rebuilds one ask untimed, then times a market buy for it: a full fill, with no ADD and no residual to cancel.
+auto marketOrders(Logger* logger) {
+    BookBenchmark benchmark(logger);
+    for (size_t i = 0; i < NUM_TYPED_OPS; ++i) {
+        benchmark.add(Side::SELL, MID + 1, QTY);
+        benchmark.timedAdd(Side::BUY, Price_INVALID, QTY, OrderType::MARKET);
+    }
+    const auto& engine = benchmark.engine();
+    ASSERT(engine.numMarketUpdates(MarketUpdateType::ADD) == NUM_TYPED_OPS && engine.numMarketUpdates(MarketUpdateType::TRADE) == NUM_TYPED_OPS &&
+           engine.numClientResponses(ClientResponseType::CANCELED) == 0, "market order rested or did not fill");
+    benchmark.report("market orders");
+}
+
+// One client requoting both sides a tick apart every time, so both legs are pulled and entered again, next to
+// a deep book of other clients' orders.
+auto massQuotes(Logger* logger, std::mt19937_64& rng) {
+    constexpr ClientId QUOTER = NUM_CLIENTS; // none of OrderKeys' clients
+    BookBenchmark benchmark(logger);
+    for (size_t i = 0; i < NUM_ADDS; ++i) {
+        const auto depth = static_cast<Price>(2 + rng() % DEEP_LEVELS); // behind the quote
+        benchmark.add((i & 1 ? Side::SELL : Side::BUY), (i & 1 ? MID + 1 + depth : MID - depth), QTY);
+    }
+    for (size_t i = 0; i < NUM_TYPED_OPS; ++i) {
+        const auto shift = static_cast<Price>(i & 1);
+        benchmark.timedQuote(QUOTER, 2 * i, MID - shift, QTY, MID + 1 + shift, QTY);
+    }
+    const auto& engine = benchmark.engine();
+    ASSERT(engine.numClientResponses(ClientResponseType::QUOTE_ACCEPTED) == 2 * NUM_TYPED_OPS &&
+           engine.numClientResponses(ClientResponseType::QUOTE_REJECTED) == 0 && engine.numMarketUpdates(MarketUpdateType::TRADE) == 0,
+           "valid mass quote rejected or traded");
+    benchmark.report("mass quote requotes");
+}
+
+// Puts a valid quote in untimed, then times a crossed one, which must pull it and answer QUOTE_REJECTED per leg.
+auto crossedQuotes(Logger* logger) {
+    constexpr ClientId QUOTER = NUM_CLIENTS;
+    BookBenchmark benchmark(logger);
+    for (size_t i = 0; i < NUM_TYPED_OPS; ++i) {
+        benchmark.quote(QUOTER, 4 * i, MID, QTY, MID + 1, QTY);
+        benchmark.timedQuote(QUOTER, 4 * i + 2, MID + 1, QTY, MID, QTY);
+    }
+    const auto& engine = benchmark.engine();
+    ASSERT(engine.numClientResponses(ClientResponseType::QUOTE_REJECTED) == 2 * NUM_TYPED_OPS && engine.numMarketUpdates(MarketUpdateType::TRADE) == 0 &&
+           engine.numMarketUpdates(MarketUpdateType::CANCEL) == engine.numMarketUpdates(MarketUpdateType::ADD),
+           "crossed mass quote accepted or left the old quote resting");
+    benchmark.report("crossed mass quotes");
+}
+
+// One client rests MASS_CANCEL_ORDERS orders per side untimed among another client's growing bids, then the timed
+// mass cancel of its bids must cancel exactly those, leaving its asks and the other client's bids alone.
+auto massCancels(Logger* logger) {
+    constexpr size_t MASS_CANCEL_ORDERS = 5;
+    constexpr ClientId CANCELER = 0, OTHER = 1;
+    BookBenchmark benchmark(logger);
+    OrderId next_order_id = 0;
+    for (size_t i = 0; i < NUM_TYPED_OPS; ++i) {
+        benchmark.add({OTHER, next_order_id++}, Side::BUY, MID - 1, QTY);
+        for (size_t j = 0; j < MASS_CANCEL_ORDERS; ++j) {
+            benchmark.add({CANCELER, next_order_id++}, Side::BUY, MID - static_cast<Price>(j), QTY);
+            benchmark.add({CANCELER, next_order_id++}, Side::SELL, MID + 1 + static_cast<Price>(j), QTY);
+        }
+        const auto& engine = benchmark.engine();
+        const auto canceled = engine.numMarketUpdates(MarketUpdateType::CANCEL);
+        benchmark.timedMassCancel(CANCELER, Side::BUY);
+        ASSERT(engine.numMarketUpdates(MarketUpdateType::CANCEL) - canceled == MASS_CANCEL_ORDERS, "mass cancel of one side out of scope");
+        benchmark.massCancel(CANCELER, Side::SELL);
+    }
+    const auto& engine = benchmark.engine();
+    ASSERT(engine.numMarketUpdates(MarketUpdateType::ADD) - engine.numMarketUpdates(MarketUpdateType::CANCEL) == NUM_TYPED_OPS,
+           "mass cancel removed another client's orders");
+    benchmark.report("mass cancel one side");
+}
+
+/// ./me_order_book_benchmark [CORE_ID]
+int main(int argc, char **argv) {
+    if (argc > 1 && !Common::setThreadCore(atoi(argv[1])))
+        FATAL("Could not pin the benchmark to core " + std::string(argv[1]));
+
+    Common::TscClock::instance();
+    Logger logger("me_order_book_benchmark.log");
+    std::mt19937_64 rng(42);
+
+    passiveAddsAtTouch(&logger);
+    deepBookAdds(&logger, rng);
+    wideBookAdds(&logger, rng);
+    randomCancels(&logger, rng);
+    for (const Price num_levels : {1, 5, 20})
+        aggressiveSweeps(&logger, num_levels);
+    mixedFlow(&logger, rng);
+    modifies(&logger, rng, false);
+    modifies(&logger, rng, true);
+    iocPartialFills(&logger);
+    fokShortfalls(&logger);
+    marketOrders(&logger);
+    massQuotes(&logger, rng);
+    crossedQuotes(&logger);
+    massCancels(&logger);
+
+    return 0;
+}
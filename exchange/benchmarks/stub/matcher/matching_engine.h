@@ -0,0 +1,57 @@
+#pragma once
+#include <array>
+#include "order_server/client_response.h"
+#include "market_data/market_update.h"
+#include "matcher/me_order_book.h"
+
+namespace Exchange {
+    /// Stands in for matcher/matching_engine.h when MEOrderBook is built into a benchmark: no queues, threads or logging,
+    /// the book's callbacks only count what it emits, in total and by type for the workloads' checks, and keep the last
+    /// message so that nothing is optimized away.
+    /// Selected by putting exchange/benchmarks/stub first on the include path of the benchmark target.
+    class MatchingEngine final {
+    public:
+        MatchingEngine() = default;
+
+        auto sendClientResponse(const MEClientResponse* client_response, TraceId = TraceId_INVALID) noexcept {
+            last_client_response_ = *client_response;
+            ++num_client_responses_;
+            ++num_client_responses_by_type_[static_cast<size_t>(client_response->type_)];
+        }
+
+        auto sendMarketUpdate(const MEMarketUpdate* market_update, TraceId = TraceId_INVALID) noexcept {
+            last_market_update_ = *market_update;
+            ++num_market_updates_;
+            ++num_market_updates_by_type_[static_cast<size_t>(market_update->type_)];
+        }
+
+        auto sendMarketUpdates(const MEMarketUpdate* market_updates, size_t num_updates) noexcept {
+            if (num_updates)
+                last_market_update_ = market_updates[num_updates - 1];
+            num_market_updates_ += num_updates;
+            for (size_t i = 0; i < num_updates; ++i)
+                ++num_market_updates_by_type_[static_cast<size_t>(market_updates[i].type_)];
+        }
+
+        auto currentTraceId() const noexcept { return TraceId_INVALID; }
+
+        auto numClientResponses() const noexcept { return num_client_responses_; }
+        auto numMarketUpdates() const noexcept { return num_market_updates_; }
+        auto numClientResponses(ClientResponseType type) const noexcept { return num_client_responses_by_type_[static_cast<size_t>(type)]; }
+        auto numMarketUpdates(MarketUpdateType type) const noexcept { return num_market_updates_by_type_[static_cast<size_t>(type)]; }
+        auto lastClientResponse() const noexcept -> const MEClientResponse& { return last_client_response_; }
+
+        MatchingEngine(const MatchingEngine&) = delete;
+        MatchingEngine(const MatchingEngine&&) = delete;
+        MatchingEngine& operator=(const MatchingEngine&) = delete;
+        MatchingEngine& operator=(const MatchingEngine&&) = delete;
+
+    private:
+        MEClientResponse last_client_response_;
+        MEMarketUpdate last_market_update_;
+        size_t num_client_responses_ = 0;
+        size_t num_market_updates_ = 0;
+        std::array<size_t, 256> num_client_responses_by_type_{}; // by the uint8_t value of the type
+        std::array<size_t, 256> num_market_updates_by_type_{};
+    };
+}
@@ -1,11 +1,15 @@
 #include <csignal> 
+#include <memory>
+#include <vector>
 
 #include "matcher/matching_engine.h"
 #include "market_data/market_data_publisher.h"
 #include "order_server/order_server.h"
 
+constexpr auto LOG_COMPONENT = Common::LogComponent::MAIN;
+
 Common::Logger* logger = nullptr;
-Exchange::MatchingEngine* matching_engine = nullptr;
+std::vector<Exchange::MatchingEngine*> matching_engines; // one per shard
 Exchange::MarketDataPublisher* market_data_publisher = nullptr;
 Exchange::OrderServer* order_server = nullptr;
 
@@ -15,8 +19,10 @@ void signal_handler(int) {
 
     delete logger;
     logger = nullptr;
-    delete matching_engine;
-    matching_engine = nullptr;
+    for (auto &matching_engine : matching_engines) {
+        delete matching_engine;
+        matching_engine = nullptr;
+    }
     delete market_data_publisher;
     market_data_publisher = nullptr;
     delete order_server;
@@ -27,42 +33,81 @@ void signal_handler(int) {
     exit(EXIT_SUCCESS);
 }
 
-int main(int, char**) {
+/// ./exchange_main [NUM_ME_SHARDS] [FIRST_ME_CORE] [CANCEL_ON_DISCONNECT] [HOUSEKEEPING_CORE] [REQUIRE_MLOCK]
+/// Tickers are spread over NUM_ME_SHARDS matching engine threads (1 by default), shard i pinned to FIRST_ME_CORE + i if given.
+/// CANCEL_ON_DISCONNECT=1 cancels a client's resting orders when its connection to the order server is lost.
+/// HOUSEKEEPING_CORE, if given, pins the log writer, clock drift, latency dump and trace threads, and must not be a shard's core.
+/// REQUIRE_MLOCK=1 makes a failed mlock() of the order books and socket buffers FATAL instead of a warning.
+int main(int argc, char **argv) {
+    const size_t num_shards = (argc > 1 ? std::stoul(argv[1]) : 1);
+    const int first_me_core = (argc > 2 ? atoi(argv[2]) : -1);
+    const bool cancel_on_disconnect = (argc > 3 && atoi(argv[3]) != 0);
+    const int housekeeping_core = (argc > 4 ? atoi(argv[4]) : -1);
+    Common::requireMemoryLock(argc > 5 && atoi(argv[5]) != 0);
+    ASSERT(num_shards >= 1 && num_shards <= Exchange::ME_MAX_SHARDS, "NUM_ME_SHARDS must be 1 to " + std::to_string(Exchange::ME_MAX_SHARDS));
+    ASSERT(housekeeping_core < 0 || first_me_core < 0 || housekeeping_core < first_me_core || 
+           housekeeping_core >= first_me_core + static_cast<int>(num_shards), "HOUSEKEEPING_CORE must not be one of the matching engine cores");
+
+    // calibrate the TSC clock before any component logs, then keep it aligned with the system clock
+    Common::TscClock::instance().startDriftCorrection(housekeeping_core, 1000); 
+    // every component's Logger is drained by this one writer thread, on the housekeeping core if given (unpinned otherwise)
+    Common::LogWriter::instance().start({.core_id_ = housekeeping_core});
     logger = new Common::Logger("exchange_main.log"); 
+    // per-tag latency percentiles, every 10s and once more on exit
+    Common::LatencyRegistry::instance().startDumping("exchange_latency.csv", 10 * 1000, housekeeping_core);
+    // per-hop (trace id, TSC) stamps, stitched with the clients' files by trace_stitcher_main
+    Common::TraceCollector::instance().start("exchange_trace.bin", housekeeping_core);
 
     std::signal(SIGINT, signal_handler); 
     
     const int sleep_time = 100 * 1000; 
     
-    Exchange::ClientRequestLFQueue client_requests(ME_MAX_CLIENT_UPDATES); 
-    Exchange::ClientReponseLFQueue client_responses(ME_MAX_CLIENT_UPDATES); 
-    Exchange::MEMarketUpdateLFQueue market_upates(ME_MAX_MARKET_UPDATES); 
+    // per shard: requests in, responses and market updates out. The publisher numbers market_updates, which a single
+    // shard writes directly and several shards reach through the publisher's merge of their own queues.
+    std::vector<std::unique_ptr<Exchange::ClientRequestLFQueue>> client_request_queues; 
+    std::vector<std::unique_ptr<Exchange::ClientResponseLFQueue>> client_response_queues; 
+    std::vector<std::unique_ptr<Exchange::MEMarketUpdateBroadcastQueue>> shard_update_queues; 
+    std::vector<Exchange::ClientRequestLFQueue*> client_requests; 
+    std::vector<Exchange::ClientResponseLFQueue*> client_responses; 
+    std::vector<Exchange::MEMarketUpdateBroadcastQueue*> shard_updates; 
+    Exchange::MEMarketUpdateBroadcastQueue market_updates(ME_MAX_MARKET_UPDATES); 
+    for (size_t shard = 0; shard < num_shards; ++shard) {
+        client_requests.push_back(client_request_queues.emplace_back(std::make_unique<Exchange::ClientRequestLFQueue>(ME_MAX_CLIENT_UPDATES)).get()); 
+        client_responses.push_back(client_response_queues.emplace_back(std::make_unique<Exchange::ClientResponseLFQueue>(ME_MAX_CLIENT_UPDATES)).get()); 
+        if (num_shards > 1)
+            shard_updates.push_back(shard_update_queues.emplace_back(std::make_unique<Exchange::MEMarketUpdateBroadcastQueue>(ME_MAX_MARKET_UPDATES)).get()); 
+    }
 
     std::string time_str; 
 
-    logger->log("%:% %() % Starting Matching Engine...\n", __FILE__, __LINE__, __FUNCTION__, 
-    Common::getCurrentTimeStr(&time_str));
-    matching_engine = new Exchange::MatchingEngine(&client_requests, &client_responses, &market_upates); 
-    matching_engine->start(); 
+    for (size_t shard = 0; shard < num_shards; ++shard) {
+        LOG_INFO((*logger), "%:% %() % Starting Matching Engine shard % of %...\n", __FILE__, __LINE__, __FUNCTION__, 
+        Common::getTscTimestamp(), shard, num_shards);
+        auto matching_engine = new Exchange::MatchingEngine(client_requests[shard], client_responses[shard], 
+                                                            (num_shards > 1 ? shard_updates[shard] : &market_updates), shard, num_shards, 
+                                                            first_me_core < 0 ? -1 : first_me_core + static_cast<int>(shard)); 
+        matching_engine->start(); 
+        matching_engines.push_back(matching_engine); 
+    }
 
     const std::string mkt_pub_iface = "lo";
     const std::string snap_pub_ip = "233.252.14.1", inc_pub_ip = "233.252.14.3";
     const int snap_pub_port = 20000, inc_pub_port = 20001;
 
-    logger->log("%:% %() % Starting Market Data Publisher...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
-    market_data_publisher = new Exchange::MarketDataPublisher(&market_updates, mkt_pub_iface, snap_pub_ip, snap_pub_port, inc_pub_ip, inc_pub_port);
+    LOG_INFO((*logger), "%:% %() % Starting Market Data Publisher...\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp());
+    market_data_publisher = new Exchange::MarketDataPublisher(&market_updates, mkt_pub_iface, snap_pub_ip, snap_pub_port, inc_pub_ip, inc_pub_port, shard_updates);
     market_data_publisher->start();
 
     const std::string order_gw_iface = "lo";
     const int order_gw_port = 12345;
 
-    logger->log("%:% %() % Starting Order Server...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
-    order_server = new Exchange::OrderServer(&client_requests, &client_responses, order_gw_iface, order_gw_port);
+    LOG_INFO((*logger), "%:% %() % Starting Order Server...\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp());
+    order_server = new Exchange::OrderServer(client_requests, client_responses, order_gw_iface, order_gw_port, cancel_on_disconnect);
     order_server->start();
 
     while (true) {
-        logger->log("%:% %() % Sleeping for a few milliseconds..\n", __FILE__, __LINE__, __FUNCTION__, 
-        Common::getCurrentTimeStr(&time_str)); 
+        LOG_DEBUG((*logger), "%:% %() % Sleeping for a few milliseconds..\n", __FILE__, __LINE__, __FUNCTION__, 
+        Common::getTscTimestamp()); 
         usleep(sleep_time * 1000); 
     } 
 }
\ No newline at end of file
@@ -2,40 +2,61 @@
 
 namespace Exchange {
 
-    MarketDataPublisher::MarketDataPublisher(MEMarketUpdateLFQueue *market_updates, const std::string &iface,
+    MarketDataPublisher::MarketDataPublisher(MEMarketUpdateBroadcastQueue *market_updates, const std::string &iface,
                                                const std::string &snapshot_ip, int snapshot_port,
-                                               const std::string &incremental_ip, int incremental_port)
-        : outgoing_md_updates_(market_updates), snapshot_md_updates_(ME_MAX_MARKET_UPDATES),
+                                               const std::string &incremental_ip, int incremental_port,
+                                               const std::vector<MEMarketUpdateBroadcastQueue *> &shard_updates)
+        : outgoing_md_updates_(market_updates), md_consumer_id_(market_updates->addConsumer()),
             run_(false), logger_("exchange_market_data_publisher.log"), incremental_socket_(logger_) {
+        for (auto shard_md_updates : shard_updates)
+            shard_md_updates_.emplace_back(shard_md_updates, shard_md_updates->addConsumer());
         ASSERT(incremental_socket_.init(incremental_ip, iface, incremental_port, /*is_listening*/ false) >= 0,
             "Unable to create incremental mcast socket. error:" + std::string(std::strerror(errno)));
-        snapshot_synthesizer_ = new SnapshotSynthesizer(&snapshot_md_updates_, iface, snapshot_ip, snapshot_port);
+        snapshot_synthesizer_ = new SnapshotSynthesizer(market_updates, iface, snapshot_ip, snapshot_port);
+    }
+
+    /// Appends every ready update of each shard to outgoing_md_updates_, shard after shard. A ticker lives in a single
+    /// shard, so its updates keep their order, and the one merged stream gets the global sequence numbers in run().
+    auto MarketDataPublisher::mergeShardUpdates() noexcept -> void {
+        for (auto &[shard_md_updates, consumer_id] : shard_md_updates_) {
+            // this thread also reads outgoing_md_updates_: never wait on room that only its own reads would free
+            const auto room = outgoing_md_updates_->capacity() - outgoing_md_updates_->size(md_consumer_id_);
+            const auto market_updates = shard_md_updates->getReadSpan(consumer_id, room);
+            for (const auto& market_update : market_updates) {
+                auto next_write = outgoing_md_updates_->getNextToWriteTo();
+                *next_write = market_update;
+                outgoing_md_updates_->updateWriteIndex();
+            }
+            if (!market_updates.empty())
+                shard_md_updates->updateReadIndex(consumer_id, market_updates.size());
+        }
     }
 
     auto MarketDataPublisher::run() noexcept -> void {
-        logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+        LOG_INFO(logger_, "%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp());
         while (run_) {
-            for (auto market_update = outgoing_md_updates_->getNextToRead();
-                outgoing_md_updates_->size() && market_update; market_update = outgoing_md_updates_->getNextToRead()) {
-                TTT_MEASURE(T5_MarketDataPublisher_LFQueue_read, logger_);
+            if (!shard_md_updates_.empty())
+                mergeShardUpdates();
 
-                logger_.log("%:% %() % Sending seq:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), next_inc_seq_num_,
-                            market_update->toString().c_str());
+            // drain every ready update, then release the whole batch with a single store
+            const auto market_updates = outgoing_md_updates_->getReadSpan(md_consumer_id_);
+            for (const auto& market_update : market_updates) {
+                TTT_TRACE(T5_MarketDataPublisher_LFQueue_read, market_update.trace_id_);
+
+                LOG_DEBUG(logger_, "%:% %() % Sending seq:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(), next_inc_seq_num_,
+                            market_update.toString().c_str());
 
                 START_MEASURE(Exchange_McastSocket_send);
                 incremental_socket_.send(&next_inc_seq_num_, sizeof(next_inc_seq_num_));
-                incremental_socket_.send(market_update, sizeof(MEMarketUpdate));
-                END_MEASURE(Exchange_McastSocket_send, logger_);
-
-                outgoing_md_updates_->updateReadIndex();
-                TTT_MEASURE(T6_MarketDataPublisher_UDP_write, logger_);
-                
-                auto next_write = snapshot_md_updates_.getNextToWriteTo();
-                next_write->seq_num_ = next_inc_seq_num_;
-                next_write->me_market_update_ = *market_update;
-                snapshot_md_updates_.updateWriteIndex();
+                incremental_socket_.send(&market_update, sizeof(MEMarketUpdate));
+                END_MEASURE(Exchange_McastSocket_send);
+
+                TTT_TRACE(T6_MarketDataPublisher_UDP_write, market_update.trace_id_);
+
                 ++next_inc_seq_num_;
             }
+            if (!market_updates.empty())
+                outgoing_md_updates_->updateReadIndex(md_consumer_id_, market_updates.size());
             incremental_socket_.sendAndRecv();
         }
     }
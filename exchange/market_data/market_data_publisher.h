@@ -1,16 +1,20 @@
 #pragma once
 
 #include <functional>
+#include <vector>
 
 #include "market_data/snapshot_synthesizer.h"
 
 namespace Exchange {
 
     class MarketDataPublisher {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::MARKET_DATA_PUBLISHER;
     private:
         size_t next_inc_seq_num_ = 1;
-        MEMarketUpdateLFQueue *outgoing_md_updates_ = nullptr;
-        MDPMarketUpdateLFQueue snapshot_md_updates_;
+        MEMarketUpdateBroadcastQueue *outgoing_md_updates_ = nullptr;
+        size_t md_consumer_id_ = 0; // this publisher's cursor on outgoing_md_updates_
+        // With sharded matching engines: each shard's updates and this publisher's cursor on them, merged into outgoing_md_updates_
+        std::vector<std::pair<MEMarketUpdateBroadcastQueue *, size_t>> shard_md_updates_;
         volatile bool run_ = false;
         std::string time_str_;
         Logger logger_;
@@ -18,9 +22,12 @@ namespace Exchange {
         SnapshotSynthesizer *snapshot_synthesizer_ = nullptr;
 
     public: 
-        MarketDataPublisher(MEMarketUpdateLFQueue *market_updates, const std::string &iface,
+        /// market_updates is the stream that gets the incremental sequence numbers. With shard_updates, the matching
+        /// engine shards write there instead and the publisher merges them into market_updates, which it then also produces.
+        MarketDataPublisher(MEMarketUpdateBroadcastQueue *market_updates, const std::string &iface,
                             const std::string &snapshot_ip, int snapshot_port,
-                            const std::string &incremental_ip, int incremental_port);
+                            const std::string &incremental_ip, int incremental_port,
+                            const std::vector<MEMarketUpdateBroadcastQueue *> &shard_updates = {});
         ~MarketDataPublisher() {
             stop();
 
@@ -44,6 +51,8 @@ namespace Exchange {
 
         auto run() noexcept -> void;
 
+        auto mergeShardUpdates() noexcept -> void;
+
         MarketDataPublisher() = delete;
         MarketDataPublisher(const MarketDataPublisher &) = delete;
         MarketDataPublisher(const MarketDataPublisher &&) = delete;
@@ -2,6 +2,8 @@
 #include <sstream> 
 #include "utils/types.h"
 #include "utils/lock_free_queue.h"
+#include "utils/broadcast_queue.h"
+#include "utils/trace.h"
 using namespace Common; 
 
 namespace Exchange {
@@ -13,10 +15,13 @@ namespace Exchange {
     }; 
     inline std::string marketUpdateTypeToString(MarketUpdateType type) {
         switch (type) {
+            case MarketUpdateType::CLEAR: return "CLEAR"; 
             case MarketUpdateType::ADD: return "ADD"; 
             case MarketUpdateType::MODIFY: return "MODIFY"; 
             case MarketUpdateType::CANCEL: return "CANCEL"; 
             case MarketUpdateType::TRADE: return "TRADE"; 
+            case MarketUpdateType::SNAPSHOT_START: return "SNAPSHOT_START"; 
+            case MarketUpdateType::SNAPSHOT_END: return "SNAPSHOT_END"; 
             case MarketUpdateType::INVALID: return "INVALID";
         }
         return "UNKNOWN"; 
@@ -31,6 +36,7 @@ namespace Exchange {
         Price price_ = Price_INVALID; 
         Qty qty_ = Qty_INVALID; 
         Priority priority_ = Priority_INVALID; // specifies the position of the order in the FIFO queue 
+        TraceId trace_id_ = TraceId_INVALID; // of the request that caused the update
         auto toString() const {
             std::stringstream ss; 
             ss << "MEMarketUpdate"
@@ -42,6 +48,7 @@ namespace Exchange {
                << " qty:" << qtyToString(qty_) 
                << " price:" << priceToString(price_) 
                << " priority:" << priorityToString(priority_)
+               << " trace:" << traceIdToString(trace_id_)
                << "]"; 
             return ss.str(); 
         }
@@ -65,5 +72,6 @@ namespace Exchange {
 #pragma pack(pop)
 
     typedef LFQueue<Exchange::MEMarketUpdate> MEMarketUpdateLFQueue; 
-    typedef Common::LFQueue<Exchange::MDPMarketUpdate> MDPMarketUpdateLFQueue; 
+    // matching engine output, read in place by the publisher, the snapshot synthesizer and any extra consumer
+    typedef Common::BroadcastQueue<Exchange::MEMarketUpdate> MEMarketUpdateBroadcastQueue; 
 }
\ No newline at end of file
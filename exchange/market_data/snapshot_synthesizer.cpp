@@ -2,9 +2,9 @@
 
 namesapce Exchange {
 
-    SnapshotSynthesizer::SnapshotSynthesizer(MDPMarketUpdateLFQueue *market_updates, const std::string &iface,
+    SnapshotSynthesizer::SnapshotSynthesizer(MEMarketUpdateBroadcastQueue *market_updates, const std::string &iface,
                                             const std::string &snapshot_ip, int snapshot_port)
-        : snapshot_md_updates_(market_updates), logger_("exchange_snapshot_synthesizer.log"), snapshot_socket_(logger_), order_pool_(ME_MAX_ORDER_IDS) {
+        : snapshot_md_updates_(market_updates), md_consumer_id_(market_updates->addConsumer()), logger_("exchange_snapshot_synthesizer.log"), snapshot_socket_(logger_), order_pool_(ME_MAX_ORDER_IDS) {
         ASSERT(snapshot_socket_.init(snapshot_ip, iface, snapshot_port, /*is_listening*/ false) >= 0,
             "Unable to create snapshot mcast socket. error:" + std::string(std::strerror(errno)));
         for(auto& orders : ticker_orders_)
@@ -25,8 +25,8 @@ namesapce Exchange {
         run_ = false;
     }
 
-    auto SnapshotSynthesizer::addToSnapshot(const MDPMarketUpdate *market_update) {
-        const auto &me_market_update = market_update->me_market_update_;
+    auto SnapshotSynthesizer::addToSnapshot(const MEMarketUpdate *market_update, size_t seq_num) {
+        const auto &me_market_update = *market_update;
         auto *orders = &ticker_orders_.at(me_market_update.ticker_id_);
 
         switch (me_market_update.type_) {
@@ -66,15 +66,15 @@ namesapce Exchange {
             break;
         }
 
-        ASSERT(market_update->seq_num_ == last_inc_seq_num_ + 1, "Expected incremental seq_nums to increase.");
-        last_inc_seq_num_ = market_update->seq_num_;
+        ASSERT(seq_num == last_inc_seq_num_ + 1, "Expected incremental seq_nums to increase.");
+        last_inc_seq_num_ = seq_num;
     }
 
     auto SnapshotSynthesizer::publishSnapshot() {
         size_t snapshot_size = 0;
 
         const MDPMarketUpdate start_market_update{snapshot_size++, {MarketUpdateType::SNAPSHOT_START, last_inc_seq_num_}};
-        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), start_market_update.toString());
+        LOG_TRACE(logger_, "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getTscTimestamp(), start_market_update.toString());
         snapshot_socket_.send(&start_market_update, sizeof(MDPMarketUpdate));
 
         for (size_t ticker_id = 0; ticker_id < ticker_orders_.size(); ++ticker_id) {
@@ -86,13 +86,13 @@ namesapce Exchange {
             me_market_update.ticker_id_ = ticker_id;
 
             const MDPMarketUpdate clear_market_update{snapshot_size++, me_market_update};
-            logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), clear_market_update.toString());
+            LOG_TRACE(logger_, "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getTscTimestamp(), clear_market_update.toString());
             snapshot_socket_.send(&clear_market_update, sizeof(MDPMarketUpdate));
 
             for (const auto order: orders) {
                 if (order) {
                     const MDPMarketUpdate market_update{snapshot_size++, *order};
-                    logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), market_update.toString());
+                    LOG_TRACE(logger_, "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getTscTimestamp(), market_update.toString());
                     snapshot_socket_.send(&market_update, sizeof(MDPMarketUpdate));
                     snapshot_socket_.sendAndRecv();
                 }
@@ -100,29 +100,33 @@ namesapce Exchange {
         }
 
         const MDPMarketUpdate end_market_update{snapshot_size++, {MarketUpdateType::SNAPSHOT_END, last_inc_seq_num_}};
-        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), end_market_update.toString());
+        LOG_TRACE(logger_, "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, getTscTimestamp(), end_market_update.toString());
         snapshot_socket_.send(&end_market_update, sizeof(MDPMarketUpdate));
         snapshot_socket_.sendAndRecv();
 
-        logger_.log("%:% %() % Published snapshot of % orders.\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_), snapshot_size - 1);
+        LOG_INFO(logger_, "%:% %() % Published snapshot of % orders.\n", __FILE__, __LINE__, __FUNCTION__, getTscTimestamp(), snapshot_size - 1);
     }
 
     void SnapshotSynthesizer::run() {
 
-        logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_));
+        LOG_INFO(logger_, "%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, getTscTimestamp());
 
         while (run_) {
 
-            for (auto market_update = snapshot_md_updates_->getNextToRead(); snapshot_md_updates_->size() && market_update; market_update = snapshot_md_updates_->getNextToRead()) {
-                logger_.log("%:% %() % Processing %\n", __FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&time_str_),
-                    market_update->toString().c_str());
+            // updates are read in place from the matching engine's ring, the publisher numbers that stream from 1
+            const auto market_updates = snapshot_md_updates_->getReadSpan(md_consumer_id_);
+            auto seq_num = snapshot_md_updates_->readIndex(md_consumer_id_) + 1;
+            for (const auto& market_update : market_updates) {
+                LOG_DEBUG(logger_, "%:% %() % Processing seq:% %\n", __FILE__, __LINE__, __FUNCTION__, getTscTimestamp(),
+                    seq_num, market_update.toString().c_str());
 
-                addToSnapshot(market_update);
-                snapshot_md_updates_->updateReadIndex();
+                addToSnapshot(&market_update, seq_num++);
             }
+            if (!market_updates.empty())
+                snapshot_md_updates_->updateReadIndex(md_consumer_id_, market_updates.size());
 
-            if (getCurrentNanos() - last_snapshot_time_ > 60 * NANOS_TO_SECS) {
-                last_snapshot_time_ = getCurrentNanos();
+            if (getTscNanos() - last_snapshot_time_ > 60 * NANOS_TO_SECS) {
+                last_snapshot_time_ = getTscNanos();
                 publishSnapshot();
             }
         }
@@ -16,13 +16,14 @@ using namespace Common;
 namespace Exchange {
 
     class SnapshotSynthesizer {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::SNAPSHOT_SYNTHESIZER;
     public: 
-        SnapshotSynthesizer(MDPMarketUpdateLFQueue *market_updates, const std::string &iface,
+        SnapshotSynthesizer(MEMarketUpdateBroadcastQueue *market_updates, const std::string &iface,
                     const std::string &snapshot_ip, int snapshot_port);
         ~SnapshotSynthesizer();
         auto start() -> void;
         auto stop() -> void;
-        auto addToSnapshot(const MDPMarketUpdate *market_update);
+        auto addToSnapshot(const MEMarketUpdate *me_market_update, size_t seq_num);
         auto publishSnapshot();
         auto run() -> void;
 
@@ -33,7 +34,8 @@ namespace Exchange {
         SnapshotSynthesizer &operator=(const SnapshotSynthesizer &&) = delete;
 
     private:
-        MDPMarketUpdateLFQueue* snapshot_md_updates_ nullptr; 
+        MEMarketUpdateBroadcastQueue* snapshot_md_updates_ = nullptr; 
+        size_t md_consumer_id_ = 0; // this synthesizer's cursor on snapshot_md_updates_
         Logger logger_;
         volatile bool run_ = false;
         std::string time_str_;
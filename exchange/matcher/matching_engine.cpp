@@ -4,13 +4,22 @@ namespace Exchange {
     MatchingEngine::MatchingEngine(
         ClientRequestLFQueue* client_requests, 
         ClientResponseLFQueue* client_responses, 
-        MEMarketUpdateLFQueue* market_updates 
-    ) : incoming_requests_(client_requests), 
+        MEMarketUpdateBroadcastQueue* market_updates, 
+        size_t shard_id, 
+        size_t num_shards, 
+        int core_id
+    ) : ticker_order_book_{}, 
+        shard_id_(shard_id), 
+        core_id_(core_id), 
+        incoming_requests_(client_requests), 
         outgoing_ogw_responses_(client_responses), 
         outgoing_md_updates_(market_updates), 
-        logger_("exchange_matching_engine.log") {
+        logger_(num_shards == 1 ? "exchange_matching_engine.log" : "exchange_matching_engine_" + std::to_string(shard_id) + ".log") {
+        ASSERT(shard_id < num_shards && num_shards <= ME_MAX_SHARDS, 
+               "Invalid matching engine shard " + std::to_string(shard_id) + " of " + std::to_string(num_shards));
         for (size_t i = 0; i < ticker_order_book_.size(); ++i) {
-            tikcker_order_book_[i] = new MEOrderBook(i, &logger_, this); 
+            if (tickerToShard(i, num_shards) == shard_id)
+                ticker_order_book_[i] = new MEOrderBook(i, &logger_, this, onCore(ME_ORDER_BOOK_MEMORY, core_id)); 
         }
     }
 
@@ -28,14 +37,14 @@ namespace Exchange {
         }
     }
 
-    auto MatchEngine::start() -> void {
+    auto MatchingEngine::start() -> void {
         run_ = true; 
-        ASSERT(Common::createAndStartThread(-1, 
-        "Exchange/MatchingEngine", [this]() {run();} ) != 
+        ASSERT(Common::createAndStartThread(core_id_, 
+        "Exchange/MatchingEngine/" + std::to_string(shard_id_), [this]() {run();} ) != 
         nullptr, "Failed to start MatchingEngine thread.");
     }
 
-    auto MatchEngine::end() -> void {
+    auto MatchingEngine::stop() -> void {
         run_ = false; 
     }
 }
\ No newline at end of file
@@ -10,18 +10,25 @@
 namespace Exchange {
 
     class MatchingEngine final {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::MATCHING_ENGINE;
         public: 
+            // Shard shard_id of num_shards: owns the order books of the tickers tickerToShard() maps to it, and is the
+            // only writer of its three queues. The books are placed on the NUMA node of core_id, the core start() pins to.
             MatchingEngine(
                 ClientRequestLFQueue* client_requests, 
-                ClientRequestLFQueue* client_responses, 
-                MEMartketUpdateLFQueue* market_updates
+                ClientResponseLFQueue* client_responses, 
+                MEMarketUpdateBroadcastQueue* market_updates,
+                size_t shard_id = 0, 
+                size_t num_shards = 1,
+                int core_id = -1
             ); 
             ~MatchingEngine(); 
-            auto start() -> void; // start ME loop execution 
+            auto start() -> void; // start ME loop execution, pinned to core_id_ if not -1 
             auto stop() -> void; // stop ME loop execution 
 
             auto processClientRequest(const MEClientRequest* client_request) noexcept {
-                auto order_book = ticker_order_book_[client_request->ticker_id_]; 
+                // nullptr for a mass cancel on every ticker
+                auto order_book = (LIKELY(client_request->ticker_id_ < ME_MAX_TICKERS) ? ticker_order_book_[client_request->ticker_id_] : nullptr); 
                 switch (client_request->type_) {
                     case ClientRequestType::NEW: {
                         START_MEASURE(Exchange_MEOrderBook_add);
@@ -31,9 +38,11 @@ namespace Exchange {
                             client_request->ticker_id_, 
                             client_request->side_, 
                             client_request->price_, 
-                            client_request->qty_
-                        )
-                        END_MEASURE(Exchange_MEOrderBook_add, logger_);
+                            client_request->qty_,
+                            client_request->order_type_,
+                            client_request->time_in_force_
+                        );
+                        END_MEASURE(Exchange_MEOrderBook_add);
                     }
                     break; 
 
@@ -44,7 +53,50 @@ namespace Exchange {
                             client_request->order_id_, 
                             client_request->ticker_id_
                         ); 
-                        END_MEASURE(Exchange_MEOrderBook_cancel, logger_);
+                        END_MEASURE(Exchange_MEOrderBook_cancel);
+                    }
+                    break; 
+
+                    case ClientRequestType::MODIFY: {
+                        START_MEASURE(Exchange_MEOrderBook_modify);
+                        order_book->modify(
+                            client_request->client_id_, 
+                            client_request->order_id_, 
+                            client_request->ticker_id_, 
+                            client_request->side_, 
+                            client_request->price_, 
+                            client_request->qty_
+                        ); 
+                        END_MEASURE(Exchange_MEOrderBook_modify);
+                    }
+                    break; 
+
+                    case ClientRequestType::MASS_QUOTE: {
+                        START_MEASURE(Exchange_MEOrderBook_quote);
+                        order_book->quote(
+                            client_request->client_id_, 
+                            client_request->order_id_, 
+                            client_request->ticker_id_, 
+                            client_request->price_, 
+                            client_request->qty_, 
+                            client_request->ask_price_, 
+                            client_request->ask_qty_
+                        ); 
+                        END_MEASURE(Exchange_MEOrderBook_quote);
+                    }
+                    break; 
+
+                    case ClientRequestType::MASS_CANCEL: {
+                        START_MEASURE(Exchange_MEOrderBook_massCancel);
+                        if (order_book) {
+                            order_book->massCancel(client_request->client_id_, client_request->ticker_id_, client_request->side_); 
+                        } else { // the books of this shard's tickers, the sequencer sent the request to every shard
+                            for (TickerId ticker_id = 0; ticker_id < ME_MAX_TICKERS; ++ticker_id) {
+                                if (ticker_order_book_[ticker_id])
+                                    ticker_order_book_[ticker_id]->massCancel(client_request->client_id_, ticker_id, client_request->side_); 
+                            }
+                        }
+                        END_MEASURE(Exchange_MEOrderBook_massCancel);
                     }
                     break; 
 
@@ -55,58 +107,96 @@ namespace Exchange {
                 }
             }
 
-            auto sendClientResponse(const MEClientResponse* client_response) noexcept {
-                logger_.log("%:% %() % Sending %\n", 
+            /// Stamped with trace_id: the book passes a resting order's own trace id for the responses and updates about it
+            /// when another client's request trades against it.
+            auto sendClientResponse(const MEClientResponse* client_response, TraceId trace_id) noexcept {
+                LOG_DEBUG(logger_, "%:% %() % Sending %\n", 
                 __FILE__, __LINE__, __FUNCTION__, 
-                Common::getCurrentTimeStr(&time_str_), client_response->toString());
+                Common::getTscTimestamp(), client_response->toString());
                 auto next_write =  outgoing_ogw_responses_->getNextToWriteTo(); 
                 *next_write = std::move(*client_response);
+                next_write->trace_id_ = trace_id; 
                 outgoing_ogw_responses_->updateWriteIndex(); 
-                TTT_MEASURE(T4t_MatchingEngine_LFQueue_write, logger_);
+                TTT_TRACE(T4t_MatchingEngine_LFQueue_write, trace_id);
             }
 
-            auto sendMarketUpdate(const MEMarketUpdate* market_update) noexcept {
-                logger_.log("%:% %() % Sending %\n", __FILE__, __LINE__, __FUNCTION__, 
-                Common::getCurrentTimeStr(&time_str_), market_update->toString()); 
+            /// Stamped with the trace id of the request being processed.
+            auto sendClientResponse(const MEClientResponse* client_response) noexcept {
+                sendClientResponse(client_response, current_trace_id_); 
+            }
+
+            auto sendMarketUpdate(const MEMarketUpdate* market_update, TraceId trace_id) noexcept {
+                LOG_DEBUG(logger_, "%:% %() % Sending %\n", __FILE__, __LINE__, __FUNCTION__, 
+                Common::getTscTimestamp(), market_update->toString()); 
                 auto next_write = outgoing_md_updates_->getNextToWriteTo(); 
                 *next_write = *market_update; 
+                next_write->trace_id_ = trace_id; 
                 outgoing_md_updates_->updateWriteIndex(); 
-                TTT_MEASURE(T4_MatchingEngine_LFQueue_write, logger_);
+                TTT_TRACE(T4_MatchingEngine_LFQueue_write, trace_id);
             }
 
+            auto sendMarketUpdate(const MEMarketUpdate* market_update) noexcept {
+                sendMarketUpdate(market_update, current_trace_id_); 
+            }
+
+            /// Writes num_updates market updates and releases each contiguous run of them to the publisher with one store.
+            auto sendMarketUpdates(const MEMarketUpdate* market_updates, size_t num_updates) noexcept {
+                for (size_t i = 0; i < num_updates;) {
+                    const auto next_writes = outgoing_md_updates_->getWriteSpan(num_updates - i); // empty while the ring is full
+                    for (auto &next_write : next_writes) {
+                        LOG_DEBUG(logger_, "%:% %() % Sending %\n", __FILE__, __LINE__, __FUNCTION__, 
+                        Common::getTscTimestamp(), market_updates[i].toString()); 
+                        next_write = market_updates[i++]; 
+                        next_write.trace_id_ = current_trace_id_; 
+                    }
+                    if (!next_writes.empty()) {
+                        outgoing_md_updates_->updateWriteIndex(next_writes.size()); 
+                        TTT_TRACE(T4_MatchingEngine_LFQueue_write, current_trace_id_);
+                    }
+                }
+            }
+
+            auto currentTraceId() const noexcept { return current_trace_id_; }
+
             auto run() noexcept {
-                logger_.log("%:% %() %\n", __FILE__,__LINE__,__FUNCTION__,
-                            Common::getCurrentTimeStr(&time_str_)); 
+                LOG_INFO(logger_, "%:% %() %\n", __FILE__,__LINE__,__FUNCTION__,
+                            Common::getTscTimestamp()); 
                 
                 while (run_) {
-                    const auto me_client_request = incoming_requests_->getNextToRead(); 
-                    if (LIKELY(me_client_request)) {
-                        TTT_MEASURE(T3_MatchingEngine_LFQueue_read, logger_);
-                        logger_.log("%:% %() % Processing %\n", 
-                        __FILE__, __LINE__, __FUNCTION__, 
-                        Common::getCurrentTimeStr(&time_str_), 
-                        me_client_request->toString()); 
+                    // process every request that is ready, then release the whole batch with a single store
+                    const auto me_client_requests = incoming_requests_->getReadSpan();
+                    for (const auto& me_client_request : me_client_requests) {
+                        TTT_TRACE(T3_MatchingEngine_LFQueue_read, me_client_request.trace_id_);
+                        current_trace_id_ = me_client_request.trace_id_; // stamped on the responses and updates it causes, see sendClientResponse()
+                        LOG_DEBUG(logger_, "%:% %() % Processing %\n",
+                        __FILE__, __LINE__, __FUNCTION__,
+                        Common::getTscTimestamp(),
+                        me_client_request.toString());
                         START_MEASURE(Exchange_MatchingEngine_processClientRequest);
-                        processClientRequest(me_client_request); 
-                        END_MEASURE(Exchange_MatchingEngine_processClientRequest, logger_);
-                        incoming_requests_->updateReadIndex(); 
+                        processClientRequest(&me_client_request);
+                        END_MEASURE(Exchange_MatchingEngine_processClientRequest);
                     }
+                    if (!me_client_requests.empty())
+                        incoming_requests_->updateReadIndex(me_client_requests.size());
                 }
             }
 
             // Deleted default, copy & move constructors and assignment-operators
             MatchingEngine() = delete; 
-            MatchingEngine(const MatchinEngine&) = delete; 
+            MatchingEngine(const MatchingEngine&) = delete; 
             MatchingEngine(const MatchingEngine&&) = delete; 
             MatchingEngine &operator=(const MatchingEngine&) = delete; 
             MatchingEngine &operator=(const MatchingEngine&&) = delete; 
 
         private: 
-            OrderBookHashMap ticker_order_book_; 
+            OrderBookHashMap ticker_order_book_; // nullptr for the tickers of other shards
+            const size_t shard_id_ = 0; 
+            const int core_id_ = -1; 
             ClientRequestLFQueue* incoming_requests_ = nullptr; 
             ClientResponseLFQueue* outgoing_ogw_responses_ = nullptr; // ogw: order gateway 
-            MEMarketUpdateLFQueue* outgoing_md_updates_ = nullptr; 
+            MEMarketUpdateBroadcastQueue* outgoing_md_updates_ = nullptr; 
             volatile bool run_ = false; 
+            TraceId current_trace_id_ = TraceId_INVALID; // of the request being processed
             std::string time_str_; 
             Logger logger_; 
     }; 
@@ -2,6 +2,8 @@
 #include <array> 
 #include <sstream> 
 #include "utils/types.h"
+#include "utils/trace.h"
+#include "utils/order_index.h"
 
 using namespace Common; 
 
@@ -17,6 +19,9 @@ namespace Exchange {
         Priority priority_ = Priority_INVALID; 
         MEOrder *prev_order_ = nullptr; 
         MEOrder *next_order_ = nullptr; 
+        MEOrder *prev_client_order_ = nullptr; // the same client's other orders in this book, for mass cancels
+        MEOrder *next_client_order_ = nullptr; 
+        TraceId trace_id_ = TraceId_INVALID; // of the request that put the order in the book, stamped on its passive fills
         
         // only needed for use with MemPool
         MEOrder() = default; 
@@ -46,15 +51,34 @@ namespace Exchange {
         auto toString() const -> std::string; 
     }; 
 
-    // For hashmap where Order ID is the key and MEOrder is the value
-    typedef std::array<MEOrder*, ME_MAX_ORDER_IDS> OrderHashMap; 
-    // For hashmap where Client ID is the key and OrderHashMap is the value 
-    typedef std::array<OrderHashMap, ME_MAX_NUM_CLIENTS> ClientOrderHashMap; 
+    // A client's resting mass quote legs on one book, nullptr for a leg that is not in the book.
+    struct MEQuote {
+        MEOrder *bid_ = nullptr; 
+        MEOrder *ask_ = nullptr; 
+
+        auto leg(Side side) noexcept -> MEOrder*& {
+            return (side == Side::BUY ? bid_ : ask_); 
+        }
+    }; 
+
+    // Live orders of one book by (client id, client order id), see clientOrderKey().
+    typedef OrderIndex<MEOrder> ClientOrderIndex; 
+
+    // Client order ids below 2^ME_CLIENT_ORDER_ID_BITS, so the client id fits in the top bits of the key.
+    constexpr size_t ME_CLIENT_ORDER_ID_BITS = 48; 
+
+    inline auto isValidClientOrder(ClientId client_id, OrderId client_order_id) noexcept {
+        return (client_id < ME_MAX_NUM_CLIENTS && client_order_id < (1ULL << ME_CLIENT_ORDER_ID_BITS)); 
+    }
+
+    inline auto clientOrderKey(ClientId client_id, OrderId client_order_id) noexcept -> uint64_t {
+        return (static_cast<uint64_t>(client_id) << ME_CLIENT_ORDER_ID_BITS) | client_order_id; 
+    }
 
     struct MEOrdersAtPrice {
         Side side_ = Side::INVALID; 
         Price price_ = Price_INVALID; 
-        MEOrder* first_me_order = nullptr; 
+        MEOrder* first_me_order_ = nullptr; 
         MEOrdersAtPrice* prev_entry_ = nullptr; 
         MEOrdersAtPrice* next_entry_ = nullptr; 
 
@@ -78,8 +102,5 @@ namespace Exchange {
         return ss.str();
         }
     };
-
-    // Mapping from price to MEOrdersAtPrice
-    typedef std::array<MEOrdersAtPrice*, ME_MAX_PRICE_LEVELS> OrdersAtPriceHashMap; 
     
 }
\ No newline at end of file
@@ -2,17 +2,18 @@
 #include "matcher/matching_engine.h"
 
 namespace Exchange {
-    MEOrderBook::MEOrderBook(TickerId ticker_id, Logger *logger, MatchingEngine *matching_engine)
-        : ticker_id_(ticker_id), matching_engine_(matching_engine), orders_at_price_pool_(ME_MAX_PRICE_LEVELS), order_pool_(ME_MAX_ORDER_IDS),
+    MEOrderBook::MEOrderBook(TickerId ticker_id, Logger *logger, MatchingEngine *matching_engine, const MemoryConfig &memory_config)
+        : ticker_id_(ticker_id), matching_engine_(matching_engine), cid_oid_to_order_(ME_MAX_ORDER_IDS, memory_config),
+        orders_at_price_pool_(ME_MAX_PRICE_LEVELS, memory_config), order_pool_(ME_MAX_ORDER_IDS, memory_config),
         logger_(logger) {}
 
     MEOrderBook::~MEOrderBook() {
-    logger_->log("%:% %() % OrderBook\n%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), toString(false, true));
+    LOG_INFO((*logger_), "%:% %() % OrderBook\n%\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(), toString(false, true));
     }
 
     auto MEOrderBook::match(TickerId ticker_id, ClientId client_id, Side side, OrderId client_order_id, OrderId new_market_order_id, MEOrder* itr, Qty* leaves_qty) noexcept {
         const auto order = itr; 
-        const auto order_qty = order->qty; 
+        const auto order_qty = order->qty_; 
         const auto fill_qty = std::min(*leaves_qty, order_qty); 
 
         *leaves_qty -= fill_qty; 
@@ -22,9 +23,10 @@ namespace Exchange {
                         new_market_order_id, side, itr->price_, fill_qty, *leaves_qty};
 
         matching_engine_->sendClientResponse(&client_response_);
+        // the resting order's fill and book updates carry its own trace id, the aggressor's acks and the trade carry the aggressor's
         client_response_ = {ClientResponseType::FILLED, order->client_id_, ticker_id, order->client_order_id_,
                         order->market_order_id_, order->side_, itr->price_, fill_qty, order->qty_};
-        matching_engine_->sendClientResponse(&client_response_);
+        matching_engine_->sendClientResponse(&client_response_, order->trace_id_);
         
         market_update_ = {MarketUpdateType::TRADE, OrderId_INVALID, ticker_id, side, itr->price_, fill_qty, Priority_INVALID};
         matching_engine_->sendMarketUpdate(&market_update_);
@@ -32,14 +34,14 @@ namespace Exchange {
         if (!order->qty_) {
             market_update_ = {MarketUpdateType::CANCEL, order->market_order_id_, ticker_id, order->side_,
                         order->price_, order_qty, Priority_INVALID};
-            matching_engine_->sendMarketUpdate(&market_update_);
+            matching_engine_->sendMarketUpdate(&market_update_, order->trace_id_);
             START_MEASURE(Exchange_MEOrderBook_removeOrder);
             removeOrder(order);
-            END_MEASURE(Exchange_MEOrderBook_removeOrder, (*logger_));
+            END_MEASURE(Exchange_MEOrderBook_removeOrder);
         } else {
             market_update_ = {MarketUpdateType::MODIFY, order->market_order_id_, ticker_id, order->side_,
                         order->price_, order->qty_, order->priority_};
-            matching_engine_->sendMarketUpdate(&market_update_);
+            matching_engine_->sendMarketUpdate(&market_update_, order->trace_id_);
         }
     }
 
@@ -50,26 +52,26 @@ namespace Exchange {
         if (side == Side::BUY) {
             while (leaves_qty && asks_by_price_) {
                 const auto ask_itr = asks_by_price_->first_me_order_; 
-                if (LIKELY(price < ask_itr->price)) {
+                if (LIKELY(price < ask_itr->price_)) {
                     break; 
                 }
 
                 START_MEASURE(Exchange_MEOrderBook_match);
                 match(ticker_id, client_id, side, client_order_id, new_market_order_id, ask_itr, &leaves_qty);
-                END_MEASURE(Exchange_MEOrderBook_match, (*logger_));
+                END_MEASURE(Exchange_MEOrderBook_match);
             }
         }
 
         if (side == Side::SELL) {
             while (leaves_qty && bids_by_price_) {
                 const auto bid_itr = bids_by_price_->first_me_order_; 
-                if (LIKELY(price > bids_itr->price)) {
+                if (LIKELY(price > bid_itr->price_)) {
                     break; 
                 }
 
                 START_MEASURE(Exchange_MEOrderBook_match);
                 match(ticker_id, client_id, side, client_order_id, new_market_order_id, bid_itr, &leaves_qty);
-                END_MEASURE(Exchange_MEOrderBook_match, (*logger_));
+                END_MEASURE(Exchange_MEOrderBook_match);
             }
         }
 
@@ -82,70 +84,212 @@ namespace Exchange {
         TickerId ticker_id, 
         Side side, 
         Price price, 
-        Qty qty
+        Qty qty,
+        OrderType order_type,
+        TimeInForce time_in_force
     ) noexcept -> void {
+        // the (client id, client order id) key would alias another client's order in cid_oid_to_order_
+        if (UNLIKELY(!isValidClientOrder(client_id, client_order_id))) {
+            client_response_ = {ClientResponseType::REJECTED, client_id, ticker_id, client_order_id, OrderId_INVALID,
+                                side, price, Qty_INVALID, Qty_INVALID};
+            matching_engine_->sendClientResponse(&client_response_);
+            return; 
+        }
+
         const auto new_market_order_id = generateNewMarketOrderId(); 
         client_response_ = {ClientResponseType::ACCEPTED, client_id, ticker_id, client_order_id, new_market_order_id, side, price, 0, qty};
         matching_engine_->sendClientResponse(&client_response_);
 
+        if (LIKELY(order_type == OrderType::LIMIT && time_in_force == TimeInForce::GTC)) {
+            matchAndRest(client_id, client_order_id, ticker_id, side, price, qty, new_market_order_id); 
+            return; 
+        }
+
+        // A market order trades at any price on the other side and, like IOC and FOK, never rests.
+        const auto limit_price = (order_type == OrderType::MARKET ?
+                                  (side == Side::BUY ? std::numeric_limits<Price>::max() : std::numeric_limits<Price>::min()) : price); 
+        auto leaves_qty = qty; 
+        if (time_in_force != TimeInForce::FOK || availableQty(side, limit_price, qty) >= qty) {
+            START_MEASURE(Exchange_MEOrderBook_checkForMatch);
+            leaves_qty = checkForMatch(client_id, client_order_id, ticker_id, side, limit_price, qty, new_market_order_id); 
+            END_MEASURE(Exchange_MEOrderBook_checkForMatch);
+        }
+
+        // the residual was never in the book: no market data, only the client hears of it
+        if (leaves_qty) {
+            client_response_ = {ClientResponseType::CANCELED, client_id, ticker_id, client_order_id, new_market_order_id, side, price,
+                                Qty_INVALID, leaves_qty};
+            matching_engine_->sendClientResponse(&client_response_);
+        }
+    }
+
+    /// Trades qty against the other side, then rests what is left at the back of its price level's queue.
+    /// Returns the resting order, nullptr if it all traded.
+    auto MEOrderBook::matchAndRest(ClientId client_id, OrderId client_order_id, TickerId ticker_id, Side side, Price price, Qty qty, 
+                                   OrderId new_market_order_id) noexcept -> MEOrder* {
         START_MEASURE(Exchange_MEOrderBook_checkForMatch);
         const auto leaves_qty = checkForMatch(client_id, client_order_id, ticker_id, side, price, qty, new_market_order_id); 
-        END_MEASURE(Exchange_MEOrderBook_checkForMatch, (*logger_));
+        END_MEASURE(Exchange_MEOrderBook_checkForMatch);
 
         if (LIKELY(leaves_qty)) {
-            const auto priority = getNextPriority(price); 
+            const auto priority = getNextPriority(side, price); 
 
             auto order = order_pool_.allocate(ticker_id, client_id, client_order_id, new_market_order_id, side, price, leaves_qty, priority, nullptr, nullptr); 
+            order->trace_id_ = matching_engine_->currentTraceId(); 
             
             START_MEASURE(Exchange_MEOrderBook_addOrder);
             addOrder(order); 
-            END_MEASURE(Exchange_MEOrderBook_addOrder, (*logger_));
+            END_MEASURE(Exchange_MEOrderBook_addOrder);
 
             market_update_ = {MarketUpdateType::ADD, new_market_order_id, ticker_id, side, price, leaves_qty, priority}; 
             matching_engine_->sendMarketUpdate(&market_update_); 
-            removeOrder(exchange_order); 
+            return order; 
+        }
+        return nullptr; 
+    }
+
+    /// Amends a resting order with a single MODIFIED response. A smaller quantity at the same price is applied in place
+    /// and keeps the order's place in its queue (market data MODIFY). Anything else takes the order out (CANCEL) and
+    /// enters it again under a new market order id, last in its queue, possibly trading first like a new order.
+    /// side is only echoed on MODIFY_REJECTED, for the client to find its order: the order keeps its own side.
+    auto MEOrderBook::modify(ClientId client_id, OrderId order_id, TickerId ticker_id, Side side, Price price, Qty qty) noexcept -> void {
+        auto exchange_order = (LIKELY(isValidClientOrder(client_id, order_id)) ? cid_oid_to_order_.find(clientOrderKey(client_id, order_id)) : nullptr); 
+        if (UNLIKELY(!exchange_order || !qty || qty == Qty_INVALID || price == Price_INVALID)) {
+            client_response_ = {ClientResponseType::MODIFY_REJECTED, client_id, ticker_id, order_id, OrderId_INVALID,
+                                side, Price_INVALID, Qty_INVALID, Qty_INVALID}; 
+            matching_engine_->sendClientResponse(&client_response_); 
+            return; 
+        }
+
+        side = exchange_order->side_; 
+        if (price == exchange_order->price_ && qty <= exchange_order->qty_) {
+            exchange_order->qty_ = qty; 
+            client_response_ = {ClientResponseType::MODIFIED, client_id, ticker_id, order_id, exchange_order->market_order_id_, side, price, 0, qty}; 
+            matching_engine_->sendClientResponse(&client_response_); 
+            market_update_ = {MarketUpdateType::MODIFY, exchange_order->market_order_id_, ticker_id, side, price, qty, exchange_order->priority_}; 
             matching_engine_->sendMarketUpdate(&market_update_); 
+            return; 
         }
+
+        market_update_ = {MarketUpdateType::CANCEL, exchange_order->market_order_id_, ticker_id, side, exchange_order->price_, 0,
+                          exchange_order->priority_}; 
+        START_MEASURE(Exchange_MEOrderBook_removeOrder);
+        removeOrder(exchange_order); 
+        END_MEASURE(Exchange_MEOrderBook_removeOrder);
+        matching_engine_->sendMarketUpdate(&market_update_); 
+
+        const auto new_market_order_id = generateNewMarketOrderId(); 
+        client_response_ = {ClientResponseType::MODIFIED, client_id, ticker_id, order_id, new_market_order_id, side, price, 0, qty}; 
         matching_engine_->sendClientResponse(&client_response_); 
+        matchAndRest(client_id, order_id, ticker_id, side, price, qty, new_market_order_id); 
     }
 
-    auto MEOrderBook::cancel(ClientId client_id, OrderId order_id, TickerId ticker_id) noexcept -> void {
-        auto is_cancelable = (client_id < cid_oid_to_order_.size()); 
-        MEOrder *exchange_order = nullptr; 
+    /// Replaces the client's quote on this book with a bid and an ask leg, client order ids quote_id and quote_id + 1, in
+    /// one step: no other request sees the book between the old legs and the new ones. A leg with qty 0 is pulled. A leg
+    /// at its old price with no more quantity keeps its priority (market data MODIFY), any other is canceled and entered
+    /// again like a new order, after both old legs are out so the quote never trades with itself. Each leg is acknowledged
+    /// with a single QUOTE_ACCEPTED instead of a CANCELED and an ACCEPTED. A quote with invalid ids, prices or
+    /// quantities, or a crossed one, pulls the client's quote and is answered with a QUOTE_REJECTED per leg.
+    auto MEOrderBook::quote(ClientId client_id, OrderId quote_id, TickerId ticker_id, Price bid_price, Qty bid_qty, 
+                            Price ask_price, Qty ask_qty) noexcept -> void {
+        // the ask leg is quote_id + 1, which must not wrap: both leg ids have to be indexable client order ids
+        const auto ask_id = (LIKELY(quote_id != OrderId_INVALID) ? quote_id + 1 : OrderId_INVALID); 
+        const auto is_valid = (isValidClientOrder(client_id, quote_id) && isValidClientOrder(client_id, ask_id) && bid_qty != Qty_INVALID && ask_qty != Qty_INVALID &&
+                               (!bid_qty || bid_price != Price_INVALID) && (!ask_qty || ask_price != Price_INVALID) &&
+                               (!bid_qty || !ask_qty || bid_price < ask_price)); 
+        if (UNLIKELY(client_id >= ME_MAX_NUM_CLIENTS)) {
+            LOG_WARN((*logger_), "%:% %() % Dropping mass quote from unknown client:%\n", __FILE__, __LINE__, __FUNCTION__,
+                     Common::getTscTimestamp(), clientIdToString(client_id));
+            return; 
+        }
 
-        if (LIKELY(is_cancelable)) {
-            auto &co_itr = cid_oid_to_order_.at(client_id); 
-            exchange_order = co_itr.at(order_id); 
-            is_cancelable = (exchange_order != nullptr); 
+        auto &quote = client_quotes_[client_id]; 
+        const auto keep_bid = (is_valid && quote.bid_ && bid_qty && quote.bid_->price_ == bid_price && bid_qty <= quote.bid_->qty_); 
+        const auto keep_ask = (is_valid && quote.ask_ && ask_qty && quote.ask_->price_ == ask_price && ask_qty <= quote.ask_->qty_); 
+        for (const auto side : {Side::BUY, Side::SELL}) {
+            const auto leg = quote.leg(side); 
+            if (leg && !(side == Side::BUY ? keep_bid : keep_ask)) {
+                market_update_ = {MarketUpdateType::CANCEL, leg->market_order_id_, ticker_id, side, leg->price_, 0, leg->priority_}; 
+                START_MEASURE(Exchange_MEOrderBook_removeOrder);
+                removeOrder(leg); 
+                END_MEASURE(Exchange_MEOrderBook_removeOrder);
+                matching_engine_->sendMarketUpdate(&market_update_); 
+            }
         }
 
-        if (UNLIKELY(!is_cancelable)) {
-            client_response_ = {ClientRequestType::CANCEL_REJECTED, client_id, 
-                ticker_id, order_id, OrderId_INVALID, Side::INVALID, Price_INVALID, 
-                Side::INVALID, Price_INVALID, Qty_INVALID, Qty_INVALID}; 
-        } else {
-            client_response_ = {ClientResponseType::CANCELED, client_id, ticker_id, order_id, exchange_order->market_order_id_,
-                                exchange_order->side_, exchange_order->price_, Qty_INVALID, exchange_order->qty_};
-            market_update_ = {MarketUpdateType::CANCEL, exchange_order->market_order_id_, ticker_id, exchange_order->side_, exchange_order->price_, 0,
-                                exchange_order->priority_};
+        if (UNLIKELY(!is_valid)) {
+            for (const auto side : {Side::BUY, Side::SELL}) {
+                client_response_ = {ClientResponseType::QUOTE_REJECTED, client_id, ticker_id, (side == Side::BUY ? quote_id : ask_id), OrderId_INVALID,
+                                    side, Price_INVALID, Qty_INVALID, 0}; 
+                matching_engine_->sendClientResponse(&client_response_); 
+            }
+            return; 
+        }
 
-            START_MEASURE(Exchange_MEOrderBook_removeOrder);
-            removeOrder(exchange_order);
-            END_MEASURE(Exchange_MEOrderBook_removeOrder, (*logger_));
+        quoteLeg(client_id, quote_id, ticker_id, Side::BUY, bid_price, bid_qty, keep_bid); 
+        quoteLeg(client_id, ask_id, ticker_id, Side::SELL, ask_price, ask_qty, keep_ask); 
+    }
 
-            matching_engine_->sendMarketUpdate(&market_update_);
+    /// Puts one leg of a mass quote in the book, the old leg of that side being either out already or kept in place.
+    auto MEOrderBook::quoteLeg(ClientId client_id, OrderId leg_id, TickerId ticker_id, Side side, Price price, Qty qty, bool keep) noexcept -> void {
+        auto &leg = client_quotes_[client_id].leg(side); 
+        if (keep) { // same market order id and priority, only the client order id moves on to this quote's
+            cid_oid_to_order_.erase(clientOrderKey(client_id, leg->client_order_id_)); 
+            leg->client_order_id_ = leg_id; 
+            leg->trace_id_ = matching_engine_->currentTraceId(); 
+            cid_oid_to_order_.insert(clientOrderKey(client_id, leg_id), leg); 
+            if (qty != leg->qty_) {
+                leg->qty_ = qty; 
+                market_update_ = {MarketUpdateType::MODIFY, leg->market_order_id_, ticker_id, side, price, qty, leg->priority_}; 
+                matching_engine_->sendMarketUpdate(&market_update_); 
+            }
+        } else if (qty) {
+            leg = matchAndRest(client_id, leg_id, ticker_id, side, price, qty, generateNewMarketOrderId()); 
         }
 
-        matching_engine_->sendClientResponse(&client_response_);
+        client_response_ = {ClientResponseType::QUOTE_ACCEPTED, client_id, ticker_id, leg_id, (leg ? leg->market_order_id_ : OrderId_INVALID),
+                            side, price, 0, (leg ? leg->qty_ : 0)}; 
+        matching_engine_->sendClientResponse(&client_response_); 
+    }
+
+    /// Cancels every resting order of client_id on side (Side::INVALID: both sides), walking the client's own list of
+    /// orders rather than the book. Each order gets its CANCELED response, and the market data CANCELs go out in batches
+    /// of ME_MASS_CANCEL_BATCH published together.
+    auto MEOrderBook::massCancel(ClientId client_id, TickerId ticker_id, Side side) noexcept -> void {
+        if (UNLIKELY(client_id >= ME_MAX_NUM_CLIENTS))
+            return; 
+
+        size_t num_updates = 0; 
+        for (auto order = client_orders_[client_id]; order;) {
+            const auto next_order = order->next_client_order_; 
+            if (side == Side::INVALID || order->side_ == side) {
+                client_response_ = {ClientResponseType::CANCELED, client_id, ticker_id, order->client_order_id_, order->market_order_id_,
+                                    order->side_, order->price_, Qty_INVALID, order->qty_};
+                matching_engine_->sendClientResponse(&client_response_);
+                mass_cancel_updates_[num_updates++] = {MarketUpdateType::CANCEL, order->market_order_id_, ticker_id, order->side_, 
+                                                       order->price_, 0, order->priority_};
+
+                START_MEASURE(Exchange_MEOrderBook_removeOrder);
+                removeOrder(order);
+                END_MEASURE(Exchange_MEOrderBook_removeOrder);
+
+                if (num_updates == mass_cancel_updates_.size()) {
+                    matching_engine_->sendMarketUpdates(mass_cancel_updates_.data(), num_updates); 
+                    num_updates = 0; 
+                }
+            }
+            order = next_order; 
+        }
+        if (num_updates)
+            matching_engine_->sendMarketUpdates(mass_cancel_updates_.data(), num_updates); 
     }
 
   /// Attempt to cancel an order in the order book, issue a cancel-rejection if order does not exist.
   auto MEOrderBook::cancel(ClientId client_id, OrderId order_id, TickerId ticker_id) noexcept -> void {
-    auto is_cancelable = (client_id < cid_oid_to_order_.size());
+    auto is_cancelable = isValidClientOrder(client_id, order_id);
     MEOrder *exchange_order = nullptr;
     if (LIKELY(is_cancelable)) {
-      auto &co_itr = cid_oid_to_order_.at(client_id);
-      exchange_order = co_itr.at(order_id);
+      exchange_order = cid_oid_to_order_.find(clientOrderKey(client_id, order_id));
       is_cancelable = (exchange_order != nullptr);
     }
 
@@ -160,7 +304,7 @@ namespace Exchange {
 
       START_MEASURE(Exchange_MEOrderBook_removeOrder);
       removeOrder(exchange_order);
-      END_MEASURE(Exchange_MEOrderBook_removeOrder, (*logger_));
+      END_MEASURE(Exchange_MEOrderBook_removeOrder);
 
       matching_engine_->sendMarketUpdate(&market_update_);
     }
@@ -2,7 +2,10 @@
 
 #include "utils/types.h"
 #include "utils/mem_pool.h"
+#include "utils/memory_backing.h"
+#include "utils/price_ladder.h"
 #include "utils/logging.h"
+#include "order_server/client_request.h"
 #include "order_server/client_response.h"
 #include "market_data/market_update.h"
 
@@ -13,10 +16,26 @@ using namespace Common;
 namespace Exchange {
     class MatchingEngine; 
 
+    // Backing of the per-book order pools and client/order index, which every add/cancel touches.
+    constexpr MemoryConfig ME_ORDER_BOOK_MEMORY = HOT_PATH_MEMORY; 
+
+// Build with -DME_PRICE_LADDER=0 to position every new price level by walking the level list, as before the ladder.
+#ifndef ME_PRICE_LADDER
+#define ME_PRICE_LADDER 1
+#endif
+
+    // Ticks covered by each side's ladder window, kept centred on the side's best price. Levels further away live in the index's map.
+    constexpr size_t ME_PRICE_LADDER_LEVELS = 4096; 
+    typedef PriceLevelIndex<MEOrdersAtPrice, ME_PRICE_LADDER_LEVELS> MEPriceLevels; 
+
+    // Market data CANCELs of a mass cancel written to the publisher's queue and released to it at once.
+    constexpr size_t ME_MASS_CANCEL_BATCH = 64; 
+
     class MEOrderBook final {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::MATCHING_ENGINE;
     
     public: 
-        explicit MEOrderBook(TickerId ticker_id, Logger *logger, MatchingEngine *matching_engine);
+        explicit MEOrderBook(TickerId ticker_id, Logger *logger, MatchingEngine *matching_engine, const MemoryConfig &memory_config = {});
         ~MEOrderBook();
 
         // Deleted default, copy & move constructors and assignment-operators.
@@ -26,21 +45,29 @@ namespace Exchange {
         MEOrderBook &operator=(const MEOrderBook &) = delete;
         MEOrderBook &operator=(const MEOrderBook &&) = delete;
 
-        auto add(ClientId client_id, OrderId client_order_id, TickerId ticker_id, Side side, Price price, Qty qty) noexcept -> void;
+        auto add(ClientId client_id, OrderId client_order_id, TickerId ticker_id, Side side, Price price, Qty qty,
+                 OrderType order_type = OrderType::LIMIT, TimeInForce time_in_force = TimeInForce::GTC) noexcept -> void;
         auto cancel(ClientId client_id, OrderId order_id, TickerId ticker_id) noexcept -> void;
+        auto modify(ClientId client_id, OrderId order_id, TickerId ticker_id, Side side, Price price, Qty qty) noexcept -> void;
+        auto quote(ClientId client_id, OrderId quote_id, TickerId ticker_id, Price bid_price, Qty bid_qty, Price ask_price, Qty ask_qty) noexcept -> void;
+        auto massCancel(ClientId client_id, TickerId ticker_id, Side side) noexcept -> void;
         auto toString(bool detailed, bool validity_check) const -> std::string;
 
     private:
-        TickerId ticker_id_ = TickerID_INVALID; 
+        TickerId ticker_id_ = TickerId_INVALID; 
         MatchingEngine *matching_engine_ = nullptr;
-        ClientOrderHashMap cid_oid_to_order_;
+        ClientOrderIndex cid_oid_to_order_; // sized for the order pool, i.e. every order that can rest at once
         MemPool<MEOrdersAtPrice> orders_at_price_pool_;
         MEOrdersAtPrice *bids_by_price_ = nullptr;
         MEOrdersAtPrice *asks_by_price_ = nullptr;
-        OrdersAtPriceHashMap price_orders_at_price_;
+        MEPriceLevels bid_levels_; // every live level of each side by exact price, no aliasing between prices
+        MEPriceLevels ask_levels_; 
         MemPool<MEOrder> order_pool_;
+        std::array<MEQuote, ME_MAX_NUM_CLIENTS> client_quotes_; // legs of each client's last mass quote still resting
+        std::array<MEOrder*, ME_MAX_NUM_CLIENTS> client_orders_{}; // head of each client's list of resting orders
         MEClientResponse client_response_;
         MEMarketUpdate market_update_;
+        std::array<MEMarketUpdate, ME_MASS_CANCEL_BATCH> mass_cancel_updates_;
         OrderId next_market_order_id_ = 1;
         std::string time_str_;
         Logger *logger_ = nullptr;
@@ -49,79 +76,115 @@ namespace Exchange {
             return next_market_order_id_++;
         }
 
-        auto priceToIndex(Price price) const noexcept {
-            return (price % ME_MAX_PRICE_LEVELS);
-        }
-
-        auto getOrdersAtPrice(Price price) const noexcept -> MEOrdersAtPrice* {
-           return price_orders_at_price_.at(priceToIndex(price));
+        auto getOrdersAtPrice(Side side, Price price) const noexcept -> MEOrdersAtPrice* {
+           return (side == Side::BUY ? bid_levels_ : ask_levels_).at(price);
         }
 
-        auto getNextPriority(Price price) noexcept {
-            const auto orders_at_price = getOrdersAtPrice(price); 
+        auto getNextPriority(Side side, Price price) noexcept {
+            const auto orders_at_price = getOrdersAtPrice(side, price); 
             if (!orders_at_price) {
                 return 1lu; 
             }
 
-            return orders_at_price->first_me_order->prev_order_->priority_ + 1; 
+            return orders_at_price->first_me_order_->prev_order_->priority_ + 1; 
         }
 
     auto match(TickerId ticker_id, ClientId client_id, Side side, OrderId client_order_id, OrderId new_market_order_id, MEOrder* bid_itr, Qty* leaves_qty) noexcept;
     auto checkForMatch(ClientId client_id, OrderId client_order_id, TickerId ticker_id, Side side, Price price, Qty qty, Qty new_market_order_id) noexcept;
+    auto matchAndRest(ClientId client_id, OrderId client_order_id, TickerId ticker_id, Side side, Price price, Qty qty, OrderId new_market_order_id) noexcept -> MEOrder*;
+    auto quoteLeg(ClientId client_id, OrderId leg_id, TickerId ticker_id, Side side, Price price, Qty qty, bool keep) noexcept -> void;
+
+        /// Quantity resting on the other side of side at prices an order limited to price trades with, counted only
+        /// until it reaches qty so a fill-or-kill check walks no further than the matching itself would.
+        auto availableQty(Side side, Price price, Qty qty) const noexcept -> Qty {
+            const auto best_orders_by_price = (side == Side::BUY ? asks_by_price_ : bids_by_price_); 
+            Qty available = 0; 
+            for (auto level = best_orders_by_price; level && available < qty;
+                 level = (level->next_entry_ == best_orders_by_price ? nullptr : level->next_entry_)) {
+                if ((side == Side::BUY && level->price_ > price) || (side == Side::SELL && level->price_ < price))
+                    break; 
+                for (auto order = level->first_me_order_; available < qty; order = order->next_order_) {
+                    available += order->qty_; 
+                    if (order->next_order_ == level->first_me_order_)
+                        break; 
+                }
+            }
+            return available; 
+        }
 
         auto addOrdersAtPrice(MEOrdersAtPrice* new_orders_at_price) noexcept {
-            price_orders_at_price_.at(priceToIndex(new_orders_at_price->price_)) = new_orders_at_price;
+            auto &levels = (new_orders_at_price->side_ == Side::BUY ? bid_levels_ : ask_levels_); 
+            levels.insert(new_orders_at_price->price_, new_orders_at_price); 
 
-            const auto best_orders_at_price = (new_orders_at_price->side_ == Side::BUY ? 
-                bids_by_price_ : asks_by_price_; 
-            )
+            auto &best_orders_by_price = (new_orders_at_price->side_ == Side::BUY ? bids_by_price_ : asks_by_price_); 
 
-            if (UNLIKELY(!best_orders_at_price)) {
-                (new_orders_at_price->side_ == Side::BUY ? bids_by_price_ : asks_by_price_) = new_orders_at_price;
+            if (UNLIKELY(!best_orders_by_price)) {
+                best_orders_by_price = new_orders_at_price;
                 new_orders_at_price->prev_entry_ = new_orders_at_price->next_entry_ = new_orders_at_price; 
-            } else {
-                auto target = best_orders_by_price;
-                bool add_after = ((new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ > target->price_) ||
-                          (new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ < target->price_));
+                levels.recentre(new_orders_at_price->price_); 
+                return; 
+            }
 
-                if (add_after) {
-                    target = target->next_entry_;
-                    add_after = ((new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ > target->price_) ||
-                               (new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ < target->price_));
+            if constexpr (ME_PRICE_LADDER) {
+                // the next better level is the nearest live one above a bid / below an ask, found in the bitmaps
+                const auto better = (new_orders_at_price->side_ == Side::BUY ? levels.higher(new_orders_at_price->price_) : 
+                                                                             levels.lower(new_orders_at_price->price_)); 
+                // no better level: goes in front of the current best, i.e. after the worst one in the circular list
+                const auto target = (better ? better : best_orders_by_price->prev_entry_); 
+                new_orders_at_price->prev_entry_ = target; 
+                new_orders_at_price->next_entry_ = target->next_entry_; 
+                target->next_entry_->prev_entry_ = new_orders_at_price; 
+                target->next_entry_ = new_orders_at_price; 
+                if (!better) {
+                    best_orders_by_price = new_orders_at_price; 
+                    levels.recentre(new_orders_at_price->price_); 
                 }
-                while (add_after && target != best_orders_by_price) {
-                    add_after = ((new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ > target->price_) ||
-                                (new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ < target->price_));
-                    if (add_after)
-                        target = target->next_entry_;
+                return; 
+            }
+
+            auto target = best_orders_by_price;
+            bool add_after = ((new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ > target->price_) ||
+                        (new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ < target->price_));
+
+            if (add_after) {
+                target = target->next_entry_;
+                add_after = ((new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ > target->price_) ||
+                            (new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ < target->price_));
+            }
+            while (add_after && target != best_orders_by_price) {
+                add_after = ((new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ > target->price_) ||
+                            (new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ < target->price_));
+                if (add_after)
+                    target = target->next_entry_;
+            }
+
+            if (add_after) { // add new_orders_at_price after target.
+                if (target == best_orders_by_price) {
+                    target = best_orders_by_price->prev_entry_;
                 }
+                new_orders_at_price->prev_entry_ = target;
+                target->next_entry_->prev_entry_ = new_orders_at_price;
+                new_orders_at_price->next_entry_ = target->next_entry_;
+                target->next_entry_ = new_orders_at_price;
+            } else { // add new_orders_at_price before target.
+                new_orders_at_price->prev_entry_ = target->prev_entry_;
+                new_orders_at_price->next_entry_ = target;
+                target->prev_entry_->next_entry_ = new_orders_at_price;
+                target->prev_entry_ = new_orders_at_price;
 
-                if (add_after) { // add new_orders_at_price after target.
-                    if (target == best_orders_by_price) {
-                        target = best_orders_by_price->prev_entry_;
-                    }
-                    new_orders_at_price->prev_entry_ = target;
-                    target->next_entry_->prev_entry_ = new_orders_at_price;
-                    new_orders_at_price->next_entry_ = target->next_entry_;
-                    target->next_entry_ = new_orders_at_price;
-                } else { // add new_orders_at_price before target.
-                    new_orders_at_price->prev_entry_ = target->prev_entry_;
-                    new_orders_at_price->next_entry_ = target;
-                    target->prev_entry_->next_entry_ = new_orders_at_price;
-                    target->prev_entry_ = new_orders_at_price;
-
-                    if ((new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ > best_orders_by_price->price_) ||
-                        (new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ < best_orders_by_price->price_)) {
-                        target->next_entry_ = (target->next_entry_ == best_orders_by_price ? new_orders_at_price : target->next_entry_);
-                        (new_orders_at_price->side_ == Side::BUY ? bids_by_price_ : asks_by_price_) = new_orders_at_price;
-                    }
+                if ((new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ > best_orders_by_price->price_) ||
+                    (new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ < best_orders_by_price->price_)) {
+                    target->next_entry_ = (target->next_entry_ == best_orders_by_price ? new_orders_at_price : target->next_entry_);
+                    best_orders_by_price = new_orders_at_price;
+                    levels.recentre(new_orders_at_price->price_); 
                 }
             }
         }
 
-        auto removeOrdersAtPrice(Side side, Price, price) noexcept {
+        auto removeOrdersAtPrice(Side side, Price price) noexcept {
             const auto best_orders_by_price = (side == Side::BUY ? bids_by_price_ : asks_by_price_); 
-            auto orders_at_price = getOrdersAtPrice(price); 
+            auto &levels = (side == Side::BUY ? bid_levels_ : ask_levels_); 
+            auto orders_at_price = levels.at(price); 
             if (UNLIKELY(orders_at_price->next_entry_ == orders_at_price)) { // empty side of the book
                 (side == Side::BUY ? bids_by_price_ : asks_by_price_) = nullptr; 
             } else {
@@ -132,12 +195,15 @@ namespace Exchange {
                 }
                 orders_at_price->prev_entry_ = orders_at_price->next_entry_ = nullptr; 
             }
-            price_orders_at_price_.at(priceToIndex(price)) = nullptr; 
+            levels.erase(price); 
+            if (orders_at_price == best_orders_by_price && (side == Side::BUY ? bids_by_price_ : asks_by_price_)) {
+                levels.recentre((side == Side::BUY ? bids_by_price_ : asks_by_price_)->price_); // keeps the new touch in the window
+            }
             orders_at_price_pool_.deallocate(orders_at_price); 
         }
 
         auto addOrder(MEOrder* order) noexcept {
-            const auto orders_at_price = getOrdersAtPrice(order->price_); 
+            const auto orders_at_price = getOrdersAtPrice(order->side_, order->price_); 
 
             if (!orders_at_price) {
                 order->next_order_ = order->prev_order_ = order; 
@@ -148,17 +214,24 @@ namespace Exchange {
                 addOrdersAtPrice(new_orders_at_price); 
             } else {
                 auto first_order = (orders_at_price ? orders_at_price->first_me_order_ : nullptr); 
-                first_order->prev_order->next_order_ = order;
-                order->prev_order_ = first_order->prev_order;
-                order->next_order = first_order;
+                first_order->prev_order_->next_order_ = order;
+                order->prev_order_ = first_order->prev_order_;
+                order->next_order_ = first_order;
                 first_order->prev_order_ = order;  
             }
 
-            cid_oid_to_order_.at(order->client_id_).at(order->client_order_id_) = order; 
+            cid_oid_to_order_.insert(clientOrderKey(order->client_id_, order->client_order_id_), order); 
+
+            auto &client_orders = client_orders_[order->client_id_]; 
+            order->prev_client_order_ = nullptr; 
+            order->next_client_order_ = client_orders; 
+            if (client_orders)
+                client_orders->prev_client_order_ = order; 
+            client_orders = order; 
         }
 
         auto removeOrder(MEOrder* order) noexcept {
-            auto orders_at_price = getOrdersAtPrice(order->price_);
+            auto orders_at_price = getOrdersAtPrice(order->side_, order->price_);
             if (order->prev_order_ == order) { // only one element 
                 removeOrdersAtPrice(order->side_, order->price_); 
             } else { // remove the link 
@@ -171,9 +244,20 @@ namespace Exchange {
                 }
                 order->prev_order_ = order->next_order_ = nullptr; 
             }
-            cid_oid_to_order_.at(order->client_id_).at(order->client_order_id_) = nullptr; 
+            cid_oid_to_order_.erase(clientOrderKey(order->client_id_, order->client_order_id_)); 
+            if (order->prev_client_order_)
+                order->prev_client_order_->next_client_order_ = order->next_client_order_; 
+            else
+                client_orders_[order->client_id_] = order->next_client_order_; 
+            if (order->next_client_order_)
+                order->next_client_order_->prev_client_order_ = order->prev_client_order_; 
+            order->prev_client_order_ = order->next_client_order_ = nullptr; 
+            auto &quote_leg = client_quotes_[order->client_id_].leg(order->side_); 
+            if (quote_leg == order) // filled or canceled by its client order id
+                quote_leg = nullptr; 
             order_pool_.deallocate(order); 
         }    
-        typedef std::array<MEOrderBook*, ME_MAX_TICKERS> OrderBookHashMap; 
     };
+
+    typedef std::array<MEOrderBook*, ME_MAX_TICKERS> OrderBookHashMap; 
 }
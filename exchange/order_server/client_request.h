@@ -2,24 +2,60 @@
 #include <sstream> 
 #include "utils/types.h"
 #include "utils/lock_free_queue.h"
+#include "utils/trace.h"
 using namespace Common; 
 
 namespace Exchange {
 #pragma pack(push,1) // avoid extra padding - 1 byte alignment = no padding between members - to save memory with binary structures sent/received over network
 
     enum class ClientRequestType : uint8_t {
-        INVALID = 0, NEW = 1, CANCEL = 2
+        INVALID = 0, NEW = 1, CANCEL = 2, 
+        MODIFY = 3, // order_id_'s resting order to price_ / qty_ (its new open quantity), side_ is the order's and is not changed
+        MASS_QUOTE = 4, // the client's two-sided quote on ticker_id_: bid price_ / qty_ and ask ask_price_ / ask_qty_, see MEOrderBook::quote()
+        MASS_CANCEL = 5 // every resting order of the client on ticker_id_ (TickerId_INVALID: on all tickers) and side_ (Side::INVALID: both)
     }; 
 
     inline std::string clientRequestTypeToString(ClientRequestType type) {
         switch (type) {
             case ClientRequestType::NEW: return "NEW"; 
             case ClientRequestType::CANCEL: return "CANCEL"; 
+            case ClientRequestType::MODIFY: return "MODIFY"; 
+            case ClientRequestType::MASS_QUOTE: return "MASS_QUOTE"; 
+            case ClientRequestType::MASS_CANCEL: return "MASS_CANCEL"; 
             case ClientRequestType::INVALID: return "INVALID"; 
         }
         return "UNKNOWN"; 
     }
 
+    // How the price of a NEW order is used: LIMIT trades at price_ or better, MARKET at any price and never rests.
+    enum class OrderType : uint8_t {
+        LIMIT = 0, MARKET = 1
+    }; 
+
+    inline std::string orderTypeToString(OrderType type) {
+        switch (type) {
+            case OrderType::LIMIT: return "LIMIT"; 
+            case OrderType::MARKET: return "MARKET"; 
+        }
+        return "UNKNOWN"; 
+    }
+
+    // What happens to a NEW order's quantity that does not trade on arrival.
+    enum class TimeInForce : uint8_t {
+        GTC = 0, // rests in the book until filled or canceled
+        IOC = 1, // immediate-or-cancel: canceled, never rests and is never published
+        FOK = 2  // fill-or-kill: trades its whole quantity on arrival or nothing at all
+    }; 
+
+    inline std::string timeInForceToString(TimeInForce time_in_force) {
+        switch (time_in_force) {
+            case TimeInForce::GTC: return "GTC"; 
+            case TimeInForce::IOC: return "IOC"; 
+            case TimeInForce::FOK: return "FOK"; 
+        }
+        return "UNKNOWN"; 
+    }
+
     // MEClientRequest contains information for a single order request from the trading participant to the exchange 
     // This is internal engine structure, not necessarily the format from the client's side 
     struct MEClientRequest {
@@ -30,6 +66,11 @@ namespace Exchange {
         Side side_ = Side::INVALID; 
         Price price_ = Price_INVALID; 
         Qty qty_ = Qty_INVALID; 
+        OrderType order_type_ = OrderType::LIMIT; // NEW only, like time_in_force_
+        TimeInForce time_in_force_ = TimeInForce::GTC; 
+        Price ask_price_ = Price_INVALID; // MASS_QUOTE only: price_ / qty_ are then the bid leg and these the ask leg
+        Qty ask_qty_ = Qty_INVALID; 
+        TraceId trace_id_ = TraceId_INVALID; // set by the trade engine when the request is sent
         auto toString() const {
             std::stringstream ss; 
             ss << "MEClientRequest" 
@@ -40,6 +81,11 @@ namespace Exchange {
                << " side:" << sideToString(side_) 
                << " qty:" << qtyToString(qty_) 
                << " price:" << priceToString(price_)
+               << " ord_type:" << orderTypeToString(order_type_)
+               << " tif:" << timeInForceToString(time_in_force_)
+               << " ask_qty:" << qtyToString(ask_qty_)
+               << " ask_price:" << priceToString(ask_price_)
+               << " trace:" << traceIdToString(trace_id_)
                << "]"; 
             return ss.str();  
         }
@@ -62,4 +108,12 @@ namespace Exchange {
 #pragma pack(pop) // restores the alignment setting to the default (not tightly packed) -> we only want to pack the structures sent over the network, and not others 
     
     typedef LFQueue<MEClientRequest> ClientRequestLFQueue; 
+
+    // Matching engine threads the tickers can be spread over, each owning the order books of its tickers.
+    constexpr size_t ME_MAX_SHARDS = ME_MAX_TICKERS; 
+
+    // Shard whose matching engine owns ticker_id, when the tickers are spread over num_shards of them.
+    inline auto tickerToShard(TickerId ticker_id, size_t num_shards) noexcept -> size_t {
+        return ticker_id % num_shards; 
+    }
 }
\ No newline at end of file
@@ -2,32 +2,43 @@
 #include <sstream> 
 #include "utils/types.h"
 #include "utils/lock_free_queue.h"
+#include "utils/trace.h"
 
 using namespace Common; 
 
 namespace Exchange {
-#prama pack(push, 1)
-    enum class ClientResponsType: uint8_t {
+#pragma pack(push, 1)
+    enum class ClientResponseType: uint8_t {
         INVALID = 0, 
         ACCEPTED = 1, 
         CANCELED = 2, 
         FILLED = 3, 
-        CANCEL_REJECTED = 4 // cancel request is rejected by the matching engine 
+        CANCEL_REJECTED = 4, // cancel request is rejected by the matching engine 
+        MODIFIED = 5, // modify request applied: price_ and leaves_qty_ are the order's new ones, market_order_id_ changes if it lost its priority
+        MODIFY_REJECTED = 6, // modify request is rejected by the matching engine, e.g. the order is no longer resting 
+        QUOTE_ACCEPTED = 7, // one per mass quote leg: client_order_id_ / market_order_id_ / price_ of the leg and leaves_qty_ resting, 0 if none
+        QUOTE_REJECTED = 8, // one per mass quote leg: the quote was invalid or crossed, the client's previous quote on the ticker is pulled
+        REJECTED = 9 // request refused as a whole, e.g. a NEW whose client order id cannot be indexed 
     }; 
-    inline std::string clientResponsTypeToString(ClientResponsType type) {
+    inline std::string clientResponseTypeToString(ClientResponseType type) {
         switch (type) {
-            case ClientResponsType::ACCEPTED: return "ACCEPTED"; 
-            case ClientResponsType::CANCELED: return "CANCELED"; 
-            case ClientResponsType::FILLED: return "FILLED"; 
-            case ClientResponsType::CANCEL_REJECTED: return "CANCEL_REJECTED"; 
-            case ClientResponsType::INVALID: return "INVALID"; 
+            case ClientResponseType::ACCEPTED: return "ACCEPTED"; 
+            case ClientResponseType::CANCELED: return "CANCELED"; 
+            case ClientResponseType::FILLED: return "FILLED"; 
+            case ClientResponseType::CANCEL_REJECTED: return "CANCEL_REJECTED"; 
+            case ClientResponseType::MODIFIED: return "MODIFIED"; 
+            case ClientResponseType::MODIFY_REJECTED: return "MODIFY_REJECTED"; 
+            case ClientResponseType::QUOTE_ACCEPTED: return "QUOTE_ACCEPTED"; 
+            case ClientResponseType::QUOTE_REJECTED: return "QUOTE_REJECTED"; 
+            case ClientResponseType::REJECTED: return "REJECTED"; 
+            case ClientResponseType::INVALID: return "INVALID"; 
         }
         return "UNKNOWN"; 
     }
 
     // Sends the order response to the client 
     struct MEClientResponse {
-        ClientResponsType type_ = ClientResponsType::INVALID; 
+        ClientResponseType type_ = ClientResponseType::INVALID; 
         ClientId client_id_ = ClientId_INVALID; 
         TickerId ticker_id_ = TickerId_INVALID; 
         OrderId client_order_id_ = OrderId_INVALID; // order id, unique to each client (a same order id numer can be used by different clients)
@@ -36,11 +47,12 @@ namespace Exchange {
         Price price_ = Price_INVALID; 
         Qty exec_qty_ = Qty_INVALID; // not cumulative: partially executed orders (for multiple times) have a different MEClientResponse message for each individual execution, not across all of them 
         Qty leaves_qty_ = Qty_INVALID; // how much of the original order's quantity is still live in the matchin engine's order book 
+        TraceId trace_id_ = TraceId_INVALID; // of the request this responds to
         auto toString() const {
             std::stringstream ss; 
             ss << "MEClientResponse"
                << " ["
-               << "type:" << clientResponsTypeToString(type_) 
+               << "type:" << clientResponseTypeToString(type_) 
                << " client:" << clientIdToString(client_id_) 
                << " ticker:" << tickerIdToString(ticker_id_) 
                << " coid:" << orderIdToString(client_order_id_) 
@@ -49,6 +61,7 @@ namespace Exchange {
                << " exec_qty:" << qtyToString(exec_qty_) 
                << " leaves_qty:" << qtyToString(leaves_qty_) 
                << " price:" << priceToString(price_) 
+               << " trace:" << traceIdToString(trace_id_) 
                << "]";
             return ss.str();  
         }
@@ -66,9 +79,9 @@ namespace Exchange {
                << "]"; 
             return ss.str(); 
         }
-    }
+    };
 
-#pragma(pop)
+#pragma pack(pop)
 
-    typedef LFQueue<MEClientResponse> ClientReponseLFQueue; 
+    typedef LFQueue<MEClientResponse> ClientResponseLFQueue; 
 }
\ No newline at end of file
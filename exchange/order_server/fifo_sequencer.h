@@ -1,23 +1,43 @@
 #pragma once 
 
+#include <vector>
+#include <functional>
+
 #include "utils/thread_utils.h"
 #include "utils/macros.h"
 
 #include "order_server/client_request.h"
+#include "order_server/client_response.h"
 
 namespace Exchange {
     constexpr size_t ME_MAX_PENDING_REQUESTS = 1024;
 
     class FIFOSequencer {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::ORDER_SERVER;
     public:
-        FIFOSequencer(ClientRequestLFQueue* client_requests, Logger* logger) 
-        : incoming_requests_(client_requests), logger_(logger) {}
+        /// client_requests holds the input ring of each matching engine shard, see tickerToShard(). A request no shard can
+        /// take is answered with a REJECTED response through reject_callback, which sends it straight back to the client.
+        FIFOSequencer(const std::vector<ClientRequestLFQueue*>& client_requests, Logger* logger,
+                      std::function<void(const MEClientResponse&)> reject_callback) 
+        : shard_requests_(client_requests), logger_(logger), reject_callback_(std::move(reject_callback)) {
+            ASSERT(!client_requests.empty() && client_requests.size() <= ME_MAX_SHARDS, 
+                   "Expected 1 to " + std::to_string(ME_MAX_SHARDS) + " matching engine shards.");
+            for (TickerId ticker_id = 0; ticker_id < ME_MAX_TICKERS; ++ticker_id)
+                ticker_requests_[ticker_id] = client_requests[tickerToShard(ticker_id, client_requests.size())];
+        }
 
         ~FIFOSequencer() {}
 
         auto addClientRequest(Nanos rx_time, const MEClientRequest& request) {
-            if (pending_size >= pending_client_requests_.size()) {
-                FATAL("Too many penging requests.")
+            if (UNLIKELY(request.ticker_id_ >= ME_MAX_TICKERS && !isAllTickers(request))) {
+                LOG_WARN((*logger_), "%:% %() % Rejecting request for unknown ticker %\n", __FILE__, __LINE__, __FUNCTION__, 
+                         Common::getTscTimestamp(), request.toString());
+                reject_callback_({ClientResponseType::REJECTED, request.client_id_, request.ticker_id_, request.order_id_, OrderId_INVALID,
+                                  request.side_, request.price_, Qty_INVALID, Qty_INVALID, request.trace_id_});
+                return; 
+            }
+            if (pending_size_ >= pending_client_requests_.size()) {
+                FATAL("Too many penging requests.");
             }
             pending_client_requests_.at(pending_size_++) = std::move(RecvTimeClientRequest{rx_time, request});
         }
@@ -26,20 +46,24 @@ namespace Exchange {
             if (UNLIKELY(!pending_size_))
                 return; 
 
-            logger_->log("%:% %() % Processing % requests.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), pending_size_);
+            LOG_TRACE((*logger_), "%:% %() % Processing % requests.\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(), pending_size_);
 
             std::sort(pending_client_requests_.begin(), pending_client_requests_.begin() + pending_size_);
 
             for (size_t i = 0; i < pending_size_; ++i) {
                 const auto &client_request = pending_client_requests_.at(i);
 
-                logger_->log("%:% %() % Writing RX:% Req:% to FIFO.\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                LOG_DEBUG((*logger_), "%:% %() % Writing RX:% Req:% to FIFO.\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                             client_request.recv_time_, client_request.request_.toString());
 
-                auto next_write = incoming_requests_->getNextToWriteTo();
-                *next_write = std::move(client_request.request_);
-                incoming_requests_->updateWriteIndex();
-                TTT_MEASURE(T2_OrderServer_LFQueue_write, (*logger_));
+                // one ring per shard: requests for the same ticker keep their sequenced order
+                if (UNLIKELY(isAllTickers(client_request.request_))) {
+                    for (auto incoming_requests : shard_requests_)
+                        publish(incoming_requests, client_request.request_);
+                } else {
+                    publish(ticker_requests_[client_request.request_.ticker_id_], client_request.request_);
+                }
+                TTT_TRACE(T2_OrderServer_LFQueue_write, client_request.request_.trace_id_);
             }
 
             pending_size_ = 0;
@@ -54,10 +78,13 @@ namespace Exchange {
 
 
     private:
-        ClientRequestLFQueue *incoming_requests_ = nullptr;
+        /// Input ring of every matching engine shard, and of the shard that owns each ticker.
+        const std::vector<ClientRequestLFQueue *> shard_requests_;
+        std::array<ClientRequestLFQueue *, ME_MAX_TICKERS> ticker_requests_;
 
         std::string time_str_;
         Logger *logger_ = nullptr;
+        std::function<void(const MEClientResponse&)> reject_callback_;
 
         struct RecvTimeClientRequest {
         Nanos recv_time_ = 0;
@@ -70,5 +97,16 @@ namespace Exchange {
 
         std::array<RecvTimeClientRequest, ME_MAX_PENDING_REQUESTS> pending_client_requests_;
         size_t pending_size_ = 0;
+
+        /// A mass cancel on every ticker goes to every shard, each cancels on the tickers it owns.
+        static auto isAllTickers(const MEClientRequest &request) noexcept -> bool {
+            return (request.type_ == ClientRequestType::MASS_CANCEL && request.ticker_id_ == TickerId_INVALID);
+        }
+
+        static auto publish(ClientRequestLFQueue *incoming_requests, const MEClientRequest &request) noexcept -> void {
+            auto next_write = incoming_requests->getNextToWriteTo();
+            *next_write = request;
+            incoming_requests->updateWriteIndex();
+        }
     };
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once 
 #include <functional>
+#include <vector>
 #include "utils/thread_utils.h"
 #include "utils/macros.h"
 #include "utils/tcp_server.h"
@@ -9,9 +10,13 @@
 
 namespace Exchange {
     class OrderServer {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::ORDER_SERVER;
 
     public:
-        OrderServer(ClientRequestLFQueue* client_requests, ClientResponseLFQueue* client_responses, const std::string &iface, int port);
+        /// One request and one response ring per matching engine shard, indexed by shard. With cancel_on_disconnect every
+        /// resting order of a client is canceled when its connection is lost.
+        OrderServer(const std::vector<ClientRequestLFQueue*> &client_requests, const std::vector<ClientResponseLFQueue*> &client_responses,
+                    const std::string &iface, int port, bool cancel_on_disconnect = false);
         ~OrderServer();
 
         /// Start and stop the order server main thread.
@@ -20,89 +25,129 @@ namespace Exchange {
 
         /// Main run loop for this thread - accepts new client connections, receives client requests from them and sends client responses to them.
         auto run() noexcept {
-            logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr
-(&time_str_));
+            LOG_INFO(logger_, "%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp());
             while (run_) {
                 tcp_server_.poll();
                 tcp_server_.sendAndRecv();
 
-                for (auto client_response = outgoing_responses_->getNextToRead(); outgoing_responses_->size() && client_response; client_response = outgoing_responses_->getNextToRead()) {
-                    TTT_MEASURE(T5t_OrderServer_LFQueue_read, logger_);
-                    
-                    auto &next_outgoing_seq_num = cid_next_outgoing_seq_num_[client_response->client_id_];
-                    logger_.log("%:% %() % Processing cid:% seq:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
-                                client_response->client_id_, next_outgoing_seq_num, client_response->toString());
-
-                    ASSERT(cid_tcp_socket_[client_response->client_id_] != nullptr,
-                            "Dont have a TCPSocket for ClientId:" + std::to_string(client_response->client_id_));
-                    START_MEASURE(Exchange_TCPSocket_send);
-                    cid_tcp_socket_[client_response->client_id_]->send(&next_outgoing_seq_num, sizeof(next_outgoing_seq_num));
-                    cid_tcp_socket_[client_response->client_id_]->send(client_response, sizeof(MEClientResponse));
-                    END_MEASURE(Exchange_TCPSocket_send, logger_);
+                for (auto outgoing_responses : outgoing_responses_)
+                    sendClientResponses(outgoing_responses);
+            }
+        }
 
-                    outgoing_responses_->updateReadIndex();
-                    TTT_MEASURE(T6t_OrderServer_TCP_write, logger_);
+        /// Send every response ready on one shard's ring to its client, numbered in the order the client receives them.
+        auto sendClientResponses(ClientResponseLFQueue *outgoing_responses) noexcept -> void {
+            const auto client_responses = outgoing_responses->getReadSpan();
+            for (const auto& client_response : client_responses) {
+                TTT_TRACE(T5t_OrderServer_LFQueue_read, client_response.trace_id_);
+                sendClientResponse(client_response);
+                TTT_TRACE(T6t_OrderServer_TCP_write, client_response.trace_id_);
+            }
+            if (!client_responses.empty())
+                outgoing_responses->updateReadIndex(client_responses.size());
+        }
 
-                    ++next_outgoing_seq_num;
-                }
+        /// Send one response to its client with the client's next outgoing sequence number, also used for the requests the
+        /// FIFO sequencer rejects without forwarding them to a matching engine.
+        auto sendClientResponse(const MEClientResponse &client_response) noexcept -> void {
+            if (UNLIKELY(client_response.client_id_ >= ME_MAX_NUM_CLIENTS || cid_tcp_socket_[client_response.client_id_] == nullptr)) { // disconnected while this was on its way
+                LOG_DEBUG(logger_, "%:% %() % Dropping response for disconnected cid:% %\n", __FILE__, __LINE__, __FUNCTION__,
+                          Common::getTscTimestamp(), client_response.client_id_, client_response.toString());
+                return;
             }
+
+            auto &next_outgoing_seq_num = cid_next_outgoing_seq_num_[client_response.client_id_];
+            LOG_DEBUG(logger_, "%:% %() % Processing cid:% seq:% %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
+                        client_response.client_id_, next_outgoing_seq_num, client_response.toString());
+
+            START_MEASURE(Exchange_TCPSocket_send);
+            cid_tcp_socket_[client_response.client_id_]->send(&next_outgoing_seq_num, sizeof(next_outgoing_seq_num));
+            cid_tcp_socket_[client_response.client_id_]->send(&client_response, sizeof(MEClientResponse));
+            END_MEASURE(Exchange_TCPSocket_send);
+
+            ++next_outgoing_seq_num;
         }
 
         /// Read client request from the TCP receive buffer, check for sequence gaps and forward it to the FIFO sequencer.
         auto recvCallback(TCPSocket *socket, Nanos rx_time) noexcept {
-            TTT_MEASURE(T1_OrderServer_TCP_read, logger_);
+            TTT_MEASURE(T1_OrderServer_TCP_read);
             
-            logger_.log("%:% %() % Received socket:% len:% rx:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            LOG_TRACE(logger_, "%:% %() % Received socket:% len:% rx:%\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                   socket->socket_fd_, socket->next_rcv_valid_index_, rx_time);
 
             if (socket->next_rcv_valid_index_ >= sizeof(OMClientRequest)) {
                 size_t i = 0;
                 for (; i + sizeof(OMClientRequest) <= socket->next_rcv_valid_index_; i += sizeof(OMClientRequest)) {
                     auto request = reinterpret_cast<const OMClientRequest *>(socket->inbound_data_.data() + i);
-                    logger_.log("%:% %() % Received %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_), request->toString());
+                    LOG_DEBUG(logger_, "%:% %() % Received %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(), request->toString());
 
                     if (UNLIKELY(cid_tcp_socket_[request->me_client_request_.client_id_] == nullptr)) { // first message from this ClientId.
                         cid_tcp_socket_[request->me_client_request_.client_id_] = socket;
                     }
 
                     if (cid_tcp_socket_[request->me_client_request_.client_id_] != socket) { // TODO - change this to send a reject back to the client.
-                        logger_.log("%:% %() % Received ClientRequest from ClientId:% on different socket:% expected:%\n", __FILE__, __LINE__, __FUNCTION__,
-                                    Common::getCurrentTimeStr(&time_str_), request->me_client_request_.client_id_, socket->socket_fd_,
+                        LOG_WARN(logger_, "%:% %() % Received ClientRequest from ClientId:% on different socket:% expected:%\n", __FILE__, __LINE__, __FUNCTION__,
+                                    Common::getTscTimestamp(), request->me_client_request_.client_id_, socket->socket_fd_,
                                     cid_tcp_socket_[request->me_client_request_.client_id_]->socket_fd_);
                         continue;
                     }
 
                     auto &next_exp_seq_num = cid_next_exp_seq_num_[request->me_client_request_.client_id_];
                     if (request->seq_num_ != next_exp_seq_num) { // TODO - change this to send a reject back to the client.
-                        logger_.log("%:% %() % Incorrect sequence number. ClientId:% SeqNum expected:% received:%\n", __FILE__, __LINE__, __FUNCTION__,
-                                    Common::getCurrentTimeStr(&time_str_), request->me_client_request_.client_id_, next_exp_seq_num, request->seq_num_);
+                        LOG_WARN(logger_, "%:% %() % Incorrect sequence number. ClientId:% SeqNum expected:% received:%\n", __FILE__, __LINE__, __FUNCTION__,
+                                    Common::getTscTimestamp(), request->me_client_request_.client_id_, next_exp_seq_num, request->seq_num_);
                         continue;
                     }
 
                     ++next_exp_seq_num;
+                    TRACE_STAMP(T1_OrderServer_TCP_read, request->me_client_request_.trace_id_, Common::rdtsc());
                     
                     START_MEASURE(Exchange_FIFOSequencer_addClientRequest);
                     fifo_sequencer_.addClientRequest(rx_time, request->me_client_request_);
-                    END_MEASURE(Exchange_FIFOSequencer_addClientRequest, logger_);
+                    END_MEASURE(Exchange_FIFOSequencer_addClientRequest);
                 }
                 memcpy(socket->inbound_data_.data(), socket->inbound_data_.data() + i, socket->next_rcv_valid_index_ - i);
                 socket->next_rcv_valid_index_ -= i;
             }
         }
 
+        /// A client connection was lost: its clients can connect again with new sessions, sequence numbers starting over.
+        /// With cancel_on_disconnect_ their resting orders are mass canceled on every ticker, sequenced like any request.
+        auto disconnectCallback(TCPSocket *socket) noexcept -> void {
+            auto canceled = false;
+            for (ClientId client_id = 0; client_id < ME_MAX_NUM_CLIENTS; ++client_id) {
+                if (cid_tcp_socket_[client_id] != socket)
+                    continue;
+
+                LOG_INFO(logger_, "%:% %() % ClientId:% disconnected socket:% cancel_on_disconnect:%\n", __FILE__, __LINE__, __FUNCTION__,
+                         Common::getTscTimestamp(), client_id, socket->fd_, cancel_on_disconnect_);
+                cid_tcp_socket_[client_id] = nullptr;
+                cid_next_exp_seq_num_[client_id] = 1;
+                cid_next_outgoing_seq_num_[client_id] = 1;
+                if (cancel_on_disconnect_) {
+                    const MEClientRequest mass_cancel{ClientRequestType::MASS_CANCEL, client_id, TickerId_INVALID, OrderId_INVALID, Side::INVALID};
+                    fifo_sequencer_.addClientRequest(Common::getCurrentNanos(), mass_cancel);
+                    canceled = true;
+                }
+            }
+            if (canceled)
+                fifo_sequencer_.sequenceAndPublish();
+        }
+
         /// End of reading incoming messages across all the TCP connections, sequence and publish the client requests to the matching engine.
         auto recvFinishedCallback() noexcept {
             START_MEASURE(Exchange_FIFOSequencer_sequenceAndPublish);
             fifo_sequencer_.sequenceAndPublish();
-            END_MEASURE(Exchange_FIFOSequencer_sequenceAndPublish, logger_);
+            END_MEASURE(Exchange_FIFOSequencer_sequenceAndPublish);
         }
 
     private:
         const std::string iface_; 
         const int port_ = 0; 
+        const bool cancel_on_disconnect_ = false; 
 
-        /// Lock free queue of outgoing client responses to be sent out to connected clients. 
-        ClientRequestLFQueue* outgoing_responses = nullptr; 
+        /// Lock free queues of outgoing client responses to be sent out to connected clients, one per matching engine shard. 
+        std::vector<ClientResponseLFQueue*> outgoing_responses_; 
 
         volatile bool run_ = false; 
 
@@ -110,7 +155,10 @@ namespace Exchange {
         Logger logger_; 
 
         /// Hash map from ClientId -> the next sequence number to be sent on outgoing client responses.
-        std::array<size_t, ME_MAX_NUM_CLIENTS> cid_next_exp_seq_num; 
+        std::array<size_t, ME_MAX_NUM_CLIENTS> cid_next_outgoing_seq_num_; 
+
+        /// Hash map from ClientId -> the next sequence number expected on incoming client requests.
+        std::array<size_t, ME_MAX_NUM_CLIENTS> cid_next_exp_seq_num_; 
 
         /// Hash map from ClientId -> TCP socket / client connection. 
         std::array<Common::TCPSocket*, ME_MAX_NUM_CLIENTS> cid_tcp_socket_; 
@@ -0,0 +1,216 @@
+#include "load_generator.h"
+
+#include <iomanip>
+#include <iostream>
+
+namespace Trading {
+    LoadGenerator::LoadGenerator(const LoadGeneratorConfig& config, const std::string& ip, const std::string& iface, int port)
+        : config_(config), rng_(config.seed_), logger_("trading_load_generator_" + std::to_string(config.first_client_id_) + ".log") {
+        ASSERT(config_.new_pct_ + config_.cancel_pct_ + config_.aggressive_pct_ == 100, "The request mix must add up to 100%.");
+        ASSERT(config_.num_clients_ && config_.first_client_id_ + config_.num_clients_ <= ME_MAX_NUM_CLIENTS,
+               "Client ids must be below " + std::to_string(ME_MAX_NUM_CLIENTS));
+        ASSERT(config_.num_tickers_ && config_.first_ticker_id_ + config_.num_tickers_ <= ME_MAX_TICKERS,
+               "Ticker ids must be below " + std::to_string(ME_MAX_TICKERS));
+        ASSERT(config_.price_levels_ > 0 && config_.price_levels_ < config_.base_price_, "Passive orders need price levels above 0.");
+        ASSERT(config_.aggressive_levels_ > 0 && config_.aggressive_levels_ < config_.base_price_, "Aggressive orders need price levels above 0.");
+        ASSERT(config_.max_qty_ > 0, "Quantities need a maximum above 0.");
+
+        for (size_t i = 0; i < ME_MAX_TICKERS; ++i)
+            ticker_base_price_[i] = config_.base_price_ + static_cast<Price>(i) * 10 * config_.price_levels_;
+
+        clients_.resize(config_.num_clients_); // never resized again, the receive callbacks hold references
+        for (size_t i = 0; i < config_.num_clients_; ++i) {
+            auto &client = clients_[i];
+            client.client_id_ = config_.first_client_id_ + i;
+            client.pending_.resize(LOAD_PENDING_SIZE);
+            client.socket_ = new Common::TCPSocket(logger_);
+            client.socket_->recv_callback_ = [this, &client](auto socket, auto) { recvCallback(client, socket); };
+            ASSERT(client.socket_->connect(ip, iface, port, false) >= 0,
+                   "Unable to connect to ip:" + ip + " port:" + std::to_string(port) + " on iface:" + iface + " error:" + std::string(std::strerror(errno)));
+        }
+    }
+
+    LoadGenerator::~LoadGenerator() {
+        for (auto &client : clients_) {
+            delete client.socket_;
+            client.socket_ = nullptr;
+        }
+    }
+
+    auto LoadGenerator::addLiveOrder(LoadClient &client, const Exchange::MEClientRequest &request) noexcept -> void {
+        if (client.live_index_.size() <= request.order_id_)
+            client.live_index_.resize(request.order_id_ + 1, LOAD_NOT_LIVE);
+        client.live_index_[request.order_id_] = client.live_orders_.size();
+        client.live_orders_.push_back(request);
+    }
+
+    /// Swaps the last live order into the erased one's place. No-op for an order that is not live (any more).
+    auto LoadGenerator::eraseLiveOrder(LoadClient &client, OrderId order_id) noexcept -> void {
+        if (order_id >= client.live_index_.size() || client.live_index_[order_id] == LOAD_NOT_LIVE)
+            return;
+        const auto idx = client.live_index_[order_id];
+        client.live_orders_[idx] = client.live_orders_.back();
+        client.live_index_[client.live_orders_[idx].order_id_] = idx;
+        client.live_orders_.pop_back();
+        client.live_index_[order_id] = LOAD_NOT_LIVE;
+    }
+
+    /// Draws the next request of client from the configured mix. Cancels fall back to a passive order while the
+    /// client has nothing to cancel.
+    auto LoadGenerator::nextRequest(LoadClient &client) noexcept -> std::pair<Exchange::MEClientRequest, LoadRequestKind> {
+        const auto roll = rng_() % 100;
+        if (roll < config_.cancel_pct_ && !client.live_orders_.empty()) {
+            auto request = client.live_orders_[rng_() % client.live_orders_.size()];
+            request.type_ = Exchange::ClientRequestType::CANCEL;
+            eraseLiveOrder(client, request.order_id_);
+            return {request, LoadRequestKind::CANCEL};
+        }
+
+        const TickerId ticker_id = config_.first_ticker_id_ + rng_() % config_.num_tickers_;
+        const auto base_price = ticker_base_price_[ticker_id - config_.first_ticker_id_];
+        const auto side = (rng_() & 1 ? Side::BUY : Side::SELL);
+        const Qty qty = 1 + rng_() % config_.max_qty_;
+        const auto aggressive = (roll >= config_.cancel_pct_ + config_.new_pct_);
+        Price price;
+        if (aggressive) {
+            const auto levels = static_cast<Price>(rng_() % config_.aggressive_levels_);
+            price = (side == Side::BUY ? base_price + 1 + levels : base_price - levels);
+        } else {
+            const auto depth = static_cast<Price>(rng_() % config_.price_levels_);
+            price = (side == Side::BUY ? base_price - depth : base_price + 1 + depth);
+        }
+        const Exchange::MEClientRequest request{Exchange::ClientRequestType::NEW, client.client_id_, ticker_id, client.next_order_id_++,
+                                                side, price, qty};
+        addLiveOrder(client, request);
+        return {request, (aggressive ? LoadRequestKind::AGGRESSIVE : LoadRequestKind::NEW)};
+    }
+
+    auto LoadGenerator::send(LoadClient &client, Nanos intended_time) noexcept -> void {
+        auto [request, kind] = nextRequest(client);
+        const auto seq_num = client.next_outgoing_seq_num_++;
+        request.trace_id_ = Common::makeTraceId(client.client_id_, seq_num); // comes back on the ack
+
+        auto &pending = client.pending_[seq_num & (LOAD_PENDING_SIZE - 1)];
+        if (UNLIKELY(pending.seq_num_)) ++num_expired_; // its ack is overdue by LOAD_PENDING_SIZE requests, give up on it
+        pending = {seq_num, intended_time, kind};
+
+        client.socket_->send(&seq_num, sizeof(seq_num));
+        client.socket_->send(&request, sizeof(Exchange::MEClientRequest));
+        send_lag_.record(static_cast<uint64_t>(std::max<Nanos>(Common::getTscNanos() - intended_time, 0)));
+        ++num_sent_;
+    }
+
+    /// Same framing checks as OrderGateway::recvCallback(), then the acks are matched to their pending request.
+    auto LoadGenerator::recvCallback(LoadClient &client, Common::TCPSocket *socket) noexcept -> void {
+        const auto now = Common::getTscNanos();
+        size_t i = 0;
+        for (; i + sizeof(Exchange::OMClientResponse) <= socket->next_rcv_valid_index_; i += sizeof(Exchange::OMClientResponse)) {
+            const auto response = reinterpret_cast<const Exchange::OMClientResponse *>(socket->rcv_buffer_ + i);
+            const auto &me_response = response->me_client_response_;
+            if (UNLIKELY(me_response.client_id_ != client.client_id_ || response->seq_num_ != client.next_exp_seq_num_)) {
+                LOG_WARN(logger_, "%:% %() % ERROR Unexpected response for client:% expected seq:% %\n", __FILE__, __LINE__, __FUNCTION__,
+                         Common::getTscTimestamp(), client.client_id_, client.next_exp_seq_num_, response->toString());
+                continue;
+            }
+            ++client.next_exp_seq_num_;
+
+            switch (me_response.type_) {
+                case Exchange::ClientResponseType::FILLED:
+                    ++num_fills_; // also sent for resting orders, with the aggressor's trace id: not an ack
+                    if (!me_response.leaves_qty_) // nothing left to cancel
+                        eraseLiveOrder(client, me_response.client_order_id_);
+                    continue;
+                case Exchange::ClientResponseType::REJECTED:
+                    eraseLiveOrder(client, me_response.client_order_id_);
+                    break;
+                case Exchange::ClientResponseType::CANCEL_REJECTED:
+                    ++num_cancel_rejects_;
+                    break;
+                default:
+                    break;
+            }
+
+            const auto seq_num = static_cast<size_t>(me_response.trace_id_ & ((1ULL << 48) - 1));
+            auto &pending = client.pending_[seq_num & (LOAD_PENDING_SIZE - 1)];
+            if (UNLIKELY(me_response.trace_id_ == TraceId_INVALID || pending.seq_num_ != seq_num)) {
+                ++num_unmatched_acks_;
+                continue;
+            }
+            const auto latency = static_cast<uint64_t>(std::max<Nanos>(now - pending.intended_time_, 0));
+            ack_latency_[static_cast<size_t>(pending.kind_)].record(latency);
+            all_ack_latency_.record(latency);
+            pending.seq_num_ = 0;
+            ++num_acked_;
+        }
+        memmove(socket->rcv_buffer_, socket->rcv_buffer_ + i, socket->next_rcv_valid_index_ - i);
+        socket->next_rcv_valid_index_ -= i;
+    }
+
+    auto LoadGenerator::numOutstanding() const noexcept -> size_t {
+        return num_sent_ - num_acked_ - num_expired_;
+    }
+
+    auto LoadGenerator::run(int drain_s) noexcept -> void {
+        if (config_.core_id_ >= 0)
+            ASSERT(Common::setThreadCore(config_.core_id_), "Could not pin the load generator to core " + std::to_string(config_.core_id_));
+
+        const auto total = static_cast<size_t>(config_.rate_ * config_.duration_s_);
+        const auto interval = static_cast<double>(NANOS_TO_SECS) / config_.rate_;
+        const auto start = Common::getTscNanos();
+        auto next_report = start + NANOS_TO_SECS;
+        LOG_INFO(logger_, "%:% %() % Sending % messages at % msg/s from % clients\n", __FILE__, __LINE__, __FUNCTION__,
+                 Common::getTscTimestamp(), total, config_.rate_, config_.num_clients_);
+
+        size_t next_msg = 0;
+        while (next_msg < total) {
+            const auto now = Common::getTscNanos();
+            // open loop: every message whose time has come goes out now, however far behind we are
+            for (auto intended_time = start + static_cast<Nanos>(static_cast<double>(next_msg) * interval);
+                 next_msg < total && intended_time <= now;
+                 ++next_msg, intended_time = start + static_cast<Nanos>(static_cast<double>(next_msg) * interval))
+                send(clients_[next_msg % clients_.size()], intended_time);
+
+            for (auto &client : clients_)
+                client.socket_->sendAndRecv();
+
+            if (UNLIKELY(now >= next_report)) {
+                report(static_cast<double>(now - start) / NANOS_TO_SECS);
+                next_report += NANOS_TO_SECS;
+            }
+        }
+
+        const auto drain_end = Common::getTscNanos() + drain_s * NANOS_TO_SECS;
+        while (numOutstanding() && Common::getTscNanos() < drain_end) {
+            for (auto &client : clients_)
+                client.socket_->sendAndRecv();
+        }
+
+        std::cout << std::endl << "Final:" << std::endl;
+        report(static_cast<double>(Common::getTscNanos() - start) / NANOS_TO_SECS);
+        std::cout << std::fixed << std::setprecision(1);
+        auto printLatency = [](const std::string &name, const Common::LatencyHistogram &histogram) {
+            const auto snapshot = histogram.snapshot(1.0); // recorded in nanoseconds
+            if (!snapshot.count_) return;
+            std::cout << std::left << std::setw(12) << name << std::right << " count:" << snapshot.count_
+                      << " p50:" << snapshot.p50_ / NANOS_TO_MICROS << "us p90:" << snapshot.p90_ / NANOS_TO_MICROS
+                      << "us p99:" << snapshot.p99_ / NANOS_TO_MICROS << "us p99.9:" << snapshot.p999_ / NANOS_TO_MICROS
+                      << "us max:" << snapshot.max_ / NANOS_TO_MICROS << "us mean:" << snapshot.mean_ / NANOS_TO_MICROS << "us" << std::endl;
+        };
+        std::cout << "request to ack, from the intended send time:" << std::endl;
+        for (size_t kind = 0; kind < ack_latency_.size(); ++kind)
+            printLatency(loadRequestKindToString(static_cast<LoadRequestKind>(kind)), ack_latency_[kind]);
+        printLatency("ALL", all_ack_latency_);
+        std::cout << "send lag behind the schedule:" << std::endl;
+        printLatency("SEND", send_lag_);
+    }
+
+    auto LoadGenerator::report(double elapsed_s) const -> void {
+        const auto snapshot = all_ack_latency_.snapshot(1.0);
+        std::cout << std::fixed << std::setprecision(1) << elapsed_s << "s sent:" << num_sent_
+                  << " (" << static_cast<double>(num_sent_) / elapsed_s << "/s) acked:" << num_acked_
+                  << " outstanding:" << numOutstanding() << " expired:" << num_expired_ << " unmatched:" << num_unmatched_acks_
+                  << " fills:" << num_fills_ << " cancel_rejects:" << num_cancel_rejects_
+                  << " ack p50:" << snapshot.p50_ / NANOS_TO_MICROS << "us p99:" << snapshot.p99_ / NANOS_TO_MICROS
+                  << "us max:" << snapshot.max_ / NANOS_TO_MICROS << "us" << std::endl;
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "utils/thread_utils.h"
+#include "utils/macros.h"
+#include "utils/tcp_socket.h"
+#include "utils/latency_histogram.h"
+
+#include "exchange/order_server/client_request.h"
+#include "exchange/order_server/client_response.h"
+
+namespace Trading {
+    struct LoadGeneratorConfig {
+        ClientId first_client_id_ = 100; // clients first_client_id_ .. first_client_id_ + num_clients_ - 1
+        size_t num_clients_ = 8;
+        double rate_ = 100 * 1000; // messages per second over all the clients
+        int duration_s_ = 10;
+        unsigned new_pct_ = 60; // passive new orders
+        unsigned cancel_pct_ = 30; // cancels of a random order the same client sent earlier
+        unsigned aggressive_pct_ = 10; // new orders crossing up to aggressive_levels_ levels
+        TickerId first_ticker_id_ = 0; // tickers first_ticker_id_ .. first_ticker_id_ + num_tickers_ - 1
+        size_t num_tickers_ = ME_MAX_TICKERS;
+        Price base_price_ = 1000; // of the first ticker, bids rest at and below, asks above; each next ticker 10 * price_levels_ higher
+        Price price_levels_ = 20; // passive orders rest uniformly this many levels deep
+        Price aggressive_levels_ = 3;
+        Qty max_qty_ = 100; // quantities uniform in 1 .. max_qty_
+        uint64_t seed_ = 42;
+        int core_id_ = -1; // of the thread that calls run()
+    };
+
+    constexpr size_t LOAD_PENDING_SIZE = 64 * 1024; // requests per client whose ack is still awaited, a power of 2
+
+    enum class LoadRequestKind : uint8_t {
+        NEW = 0,
+        CANCEL = 1,
+        AGGRESSIVE = 2,
+        MAX = 3
+    };
+
+    inline auto loadRequestKindToString(LoadRequestKind kind) -> std::string {
+        switch (kind) {
+            case LoadRequestKind::NEW: return "NEW";
+            case LoadRequestKind::CANCEL: return "CANCEL";
+            case LoadRequestKind::AGGRESSIVE: return "AGGRESSIVE";
+            case LoadRequestKind::MAX: break;
+        }
+        return "UNKNOWN";
+    }
+
+    /// Open-loop order flow against the order server, speaking the same OMClientRequest protocol as OrderGateway.
+    /// Message k is due at start + k / rate whether or not earlier ones were acknowledged, and its latency is taken
+    /// from that intended time to the ack (ACCEPTED, CANCELED or CANCEL_REJECTED). A stall of the exchange or of the
+    /// generator itself therefore shows up in every request that was due during it, not just in the one in flight
+    /// (no coordinated omission). Requests are matched to their ack through the trace id.
+    class LoadGenerator final {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::LOAD_GENERATOR;
+    public:
+        LoadGenerator(const LoadGeneratorConfig& config, const std::string& ip, const std::string& iface, int port);
+        ~LoadGenerator();
+
+        /// Sends rate_ * duration_s_ messages, waits up to drain_s for the outstanding acks and prints the report.
+        auto run(int drain_s = 5) noexcept -> void;
+
+        // Deleted default, copy & move constructors and assignment-operators.
+        LoadGenerator() = delete;
+        LoadGenerator(const LoadGenerator &) = delete;
+        LoadGenerator(const LoadGenerator &&) = delete;
+        LoadGenerator &operator=(const LoadGenerator &) = delete;
+        LoadGenerator &operator=(const LoadGenerator &&) = delete;
+
+    private:
+        struct PendingRequest {
+            size_t seq_num_ = 0; // 0: the slot is free
+            Nanos intended_time_ = 0;
+            LoadRequestKind kind_ = LoadRequestKind::NEW;
+        };
+
+        struct LoadClient {
+            ClientId client_id_ = ClientId_INVALID;
+            Common::TCPSocket *socket_ = nullptr;
+            size_t next_outgoing_seq_num_ = 1;
+            size_t next_exp_seq_num_ = 1;
+            OrderId next_order_id_ = 0;
+            std::vector<Exchange::MEClientRequest> live_orders_; // candidates for cancels, minus the ones filled or rejected since
+            std::vector<size_t> live_index_; // by client order id (they are dense from 0): position in live_orders_, LOAD_NOT_LIVE if none
+            std::vector<PendingRequest> pending_; // by request sequence number modulo LOAD_PENDING_SIZE
+        };
+
+        const LoadGeneratorConfig config_;
+        std::vector<LoadClient> clients_;
+        std::array<Price, ME_MAX_TICKERS> ticker_base_price_;
+        std::mt19937_64 rng_;
+
+        // request to ack, per kind and over all, and how late each message went out compared to its intended time
+        std::array<Common::LatencyHistogram, static_cast<size_t>(LoadRequestKind::MAX)> ack_latency_;
+        Common::LatencyHistogram all_ack_latency_;
+        Common::LatencyHistogram send_lag_;
+
+        size_t num_sent_ = 0;
+        size_t num_acked_ = 0;
+        size_t num_cancel_rejects_ = 0;
+        size_t num_fills_ = 0;
+        size_t num_expired_ = 0; // still pending LOAD_PENDING_SIZE requests later, no longer measured
+        size_t num_unmatched_acks_ = 0; // acks of expired requests, or without a trace id
+
+        Logger logger_;
+
+    private:
+        static constexpr size_t LOAD_NOT_LIVE = std::numeric_limits<size_t>::max();
+
+        static auto addLiveOrder(LoadClient &client, const Exchange::MEClientRequest &request) noexcept -> void;
+        static auto eraseLiveOrder(LoadClient &client, OrderId order_id) noexcept -> void;
+        auto nextRequest(LoadClient &client) noexcept -> std::pair<Exchange::MEClientRequest, LoadRequestKind>;
+        auto send(LoadClient &client, Nanos intended_time) noexcept -> void;
+        auto recvCallback(LoadClient &client, Common::TCPSocket *socket) noexcept -> void;
+        auto numOutstanding() const noexcept -> size_t;
+        auto report(double elapsed_s) const -> void;
+    };
+}
@@ -0,0 +1,55 @@
+#include "load_gen/load_generator.h"
+
+#include "utils/logging.h"
+
+constexpr auto LOG_COMPONENT = Common::LogComponent::MAIN;
+
+/// ./load_generator_main FIRST_CLIENT_ID NUM_CLIENTS RATE DURATION_S [NEW_PCT CANCEL_PCT AGGRESSIVE_PCT] [CORE_ID]
+///                       [FIRST_TICKER_ID NUM_TICKERS] [BASE_PRICE PRICE_LEVELS AGGRESSIVE_LEVELS] [MAX_QTY] [SEED]
+/// e.g. ./load_generator_main 100 50 500000 30 60 30 10 3: 500k msg/s for 30 s from clients 100..149, pinned to core 3.
+/// Each optional group needs the ones before it (CORE_ID -1: unpinned); see LoadGeneratorConfig for the defaults.
+int main(int argc, char **argv) {
+    if (argc < 5) {
+        FATAL("USAGE load_generator_main FIRST_CLIENT_ID NUM_CLIENTS RATE DURATION_S [NEW_PCT CANCEL_PCT AGGRESSIVE_PCT] [CORE_ID] "
+              "[FIRST_TICKER_ID NUM_TICKERS] [BASE_PRICE PRICE_LEVELS AGGRESSIVE_LEVELS] [MAX_QTY] [SEED]");
+    }
+
+    Trading::LoadGeneratorConfig config;
+    config.first_client_id_ = atoi(argv[1]);
+    config.num_clients_ = atoi(argv[2]);
+    config.rate_ = atof(argv[3]);
+    config.duration_s_ = atoi(argv[4]);
+    if (argc >= 8) {
+        config.new_pct_ = atoi(argv[5]);
+        config.cancel_pct_ = atoi(argv[6]);
+        config.aggressive_pct_ = atoi(argv[7]);
+    }
+    if (argc >= 9)
+        config.core_id_ = atoi(argv[8]);
+    if (argc >= 11) {
+        config.first_ticker_id_ = atoi(argv[9]);
+        config.num_tickers_ = atoi(argv[10]);
+    }
+    if (argc >= 14) {
+        config.base_price_ = atol(argv[11]);
+        config.price_levels_ = atol(argv[12]);
+        config.aggressive_levels_ = atol(argv[13]);
+    }
+    if (argc >= 15)
+        config.max_qty_ = atoi(argv[14]);
+    if (argc >= 16)
+        config.seed_ = std::stoull(argv[15]);
+
+    // same clock and log writer setup as trading_main, the generator timestamps everything with the TSC
+    Common::TscClock::instance().startDriftCorrection(-1, 1000);
+    Common::LogWriter::instance().start({.core_id_ = -1});
+
+    const std::string order_gw_ip = "127.0.0.1";
+    const std::string order_gw_iface = "lo";
+    const int order_gw_port = 12345;
+
+    Trading::LoadGenerator load_generator(config, order_gw_ip, order_gw_iface, order_gw_port);
+    load_generator.run();
+
+    return 0;
+}
@@ -14,6 +14,7 @@
 namespace Trading {
 
     class MarketDataConsumer {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::MARKET_DATA_CONSUMER;
     public: 
         MarketDataConsumer(Common::ClientId client_id, Exchange::MEMarketUpdateLFQueue *market_updates, const std::string &iface,
                        const std::string &snapshot_ip, int snapshot_port,
@@ -8,8 +8,8 @@ namespace Trading {
     }
 
     MarketOrderBook::~MarketOrderBook() {
-        logger_->log("%:% %() % OrderBook\n%\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_), toString(false, true));
+        LOG_INFO((*logger_), "%:% %() % OrderBook\n%\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getTscTimestamp(), toString(false, true));
 
         trade_engine_ = nullptr;
         bids_by_price_ = asks_by_price_ = nullptr;
@@ -72,8 +72,8 @@ namespace Trading {
 
         updateBBO(bid_updated, ask_updated);
 
-        logger_->log("%:% %() % % %", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_), market_update->toString(), bbo_.toString());
+        LOG_TRACE((*logger_), "%:% %() % % %", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getTscTimestamp(), market_update->toString(), bbo_.toString());
 
         trade_engine_->onOrderBookUpdate(market_update->ticker_id_, market_update->price_, market_update->side_, this);
     }
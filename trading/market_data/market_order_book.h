@@ -11,6 +11,7 @@ namespace Trading {
     class TradeEngine;
 
     class MarketOrderBook final {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::MARKET_ORDER_BOOK;
     public:
         MarketOrderBook(TickerId ticker_id, Logger *logger);
 
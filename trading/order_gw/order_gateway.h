@@ -11,6 +11,7 @@
 
 namespace Trading {
     class OrderGateway {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::ORDER_GATEWAY;
     public:
         OrderGateway(ClientId client_id,
                     Exchange::ClientRequestLFQueue *client_requests,
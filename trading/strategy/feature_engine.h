@@ -9,6 +9,7 @@ namespace Trading {
     constexpr auto Feature_INVALID = std::numeric_limits<double>::quiet_NaN();
 
     class FeatureEngine {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::STRATEGY;
     public:
         FeatureEngine(Common::Logger *logger)
             : logger_(logger) {
@@ -20,8 +21,8 @@ namespace Trading {
                 mkt_price_ = (bbo->bid_price_ * bbo->ask_qty_ + bbo->ask_price_ * bbo->bid_qty_) / static_cast<double>(bbo->bid_qty_ + bbo->ask_qty_);
             }
 
-            logger_->log("%:% %() % ticker:% price:% side:% mkt-price:% agg-trade-ratio:%\n", __FILE__, __LINE__, __FUNCTION__,
-                        Common::getCurrentTimeStr(&time_str_), ticker_id, Common::priceToString(price).c_str(),
+            LOG_DEBUG((*logger_), "%:% %() % ticker:% price:% side:% mkt-price:% agg-trade-ratio:%\n", __FILE__, __LINE__, __FUNCTION__,
+                        Common::getTscTimestamp(), ticker_id, Common::priceToString(price).c_str(),
                         Common::sideToString(side).c_str(), mkt_price_, agg_trade_qty_ratio_);
         }
 
@@ -31,8 +32,8 @@ namespace Trading {
                 agg_trade_qty_ratio_ = static_cast<double>(market_update->qty_) / (market_update->side_ == Side::BUY ? bbo->ask_qty_ : bbo->bid_qty_);
             }
 
-            logger_->log("%:% %() % % mkt-price:% agg-trade-ratio:%\n", __FILE__, __LINE__, __FUNCTION__,
-                        Common::getCurrentTimeStr(&time_str_),
+            LOG_DEBUG((*logger_), "%:% %() % % mkt-price:% agg-trade-ratio:%\n", __FILE__, __LINE__, __FUNCTION__,
+                        Common::getTscTimestamp(),
                         market_update->toString().c_str(), mkt_price_, agg_trade_qty_ratio_);
         }
 
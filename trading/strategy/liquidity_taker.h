@@ -10,6 +10,7 @@ using namespace Common;
 
 namespace Trading {
     class LiquidityTaker {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::STRATEGY;
     public:
         LiquidityTaker(Common::Logger *logger, TradeEngine *trade_engine, const FeatureEngine *feature_engine,
                     OrderManager *order_manager,
@@ -17,45 +18,46 @@ namespace Trading {
 
         /// Process order book updates, which for the liquidity taking algorithm is none.
         auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook *) noexcept -> void {
-        logger_->log("%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_), ticker_id, Common::priceToString(price).c_str(),
+        LOG_DEBUG((*logger_), "%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getTscTimestamp(), ticker_id, Common::priceToString(price).c_str(),
                     Common::sideToString(side).c_str());
         }
 
         /// Process trade events, fetch the aggressive trade ratio from the feature engine, check against the trading threshold and send aggressive orders.
         auto onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *book) noexcept -> void {
-            logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            LOG_DEBUG((*logger_), "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                         market_update->toString().c_str());
 
             const auto bbo = book->getBBO();
             const auto agg_qty_ratio = feature_engine_->getAggTradeQtyRatio();
 
             if (LIKELY(bbo->bid_price_ != Price_INVALID && bbo->ask_price_ != Price_INVALID && agg_qty_ratio != Feature_INVALID)) {
-                logger_->log("%:% %() % % agg-qty-ratio:%\n", __FILE__, __LINE__, __FUNCTION__,
-                            Common::getCurrentTimeStr(&time_str_),
+                LOG_DEBUG((*logger_), "%:% %() % % agg-qty-ratio:%\n", __FILE__, __LINE__, __FUNCTION__,
+                            Common::getTscTimestamp(),
                             bbo->toString().c_str(), agg_qty_ratio);
 
                 const auto clip = ticker_cfg_.at(market_update->ticker_id_).clip_;
                 const auto threshold = ticker_cfg_.at(market_update->ticker_id_).threshold_;
 
+                // IOC at the touch: takes what is there and leaves nothing resting behind to cancel
                 if (agg_qty_ratio >= threshold) {
-                    START_MEASURE(Trading_OrderManager_moveOrders);
+                    START_MEASURE(Trading_OrderManager_takeLiquidity);
                     if (market_update->side_ == Side::BUY)
-                        order_manager_->moveOrders(market_update->ticker_id_, bbo->ask_price_, Price_INVALID, clip);
+                        order_manager_->takeLiquidity(market_update->ticker_id_, bbo->ask_price_, Side::BUY, clip);
                     else
-                        order_manager_->moveOrders(market_update->ticker_id_, Price_INVALID, bbo->bid_price_, clip);
-                    END_MEASURE(Trading_OrderManager_moveOrders, (*logger_));
+                        order_manager_->takeLiquidity(market_update->ticker_id_, bbo->bid_price_, Side::SELL, clip);
+                    END_MEASURE(Trading_OrderManager_takeLiquidity);
                 }
             }
         }
 
         /// Process client responses for the strategy's orders.
         auto onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void {
-            logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            LOG_DEBUG((*logger_), "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                         client_response->toString().c_str());
             START_MEASURE(Trading_OrderManager_onOrderUpdate);
             order_manager_->onOrderUpdate(client_response);
-            END_MEASURE(Trading_OrderManager_onOrderUpdate, (*logger_));
+            END_MEASURE(Trading_OrderManager_onOrderUpdate);
         }
 
         /// Deleted default, copy & move constructors and assignment-operators.
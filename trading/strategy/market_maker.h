@@ -10,6 +10,7 @@ using namespace Common;
 
 namespace Trading {
     class MarketMaker {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::STRATEGY;
     public:
         MarketMaker(Common::Logger *logger, TradeEngine *trade_engine, const FeatureEngine *feature_engine,
                     OrderManager *order_manager,
@@ -17,16 +18,16 @@ namespace Trading {
 
         /// Process order book updates, fetch the fair market price from the feature engine, check against the trading threshold and modify the passive orders.
         auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side, const MarketOrderBook *book) noexcept -> void {
-            logger_->log("%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
-                        Common::getCurrentTimeStr(&time_str_), ticker_id, Common::priceToString(price).c_str(),
+            LOG_DEBUG((*logger_), "%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
+                        Common::getTscTimestamp(), ticker_id, Common::priceToString(price).c_str(),
                         Common::sideToString(side).c_str());
 
             const auto bbo = book->getBBO();
             const auto fair_price = feature_engine_->getMktPrice();
 
             if (LIKELY(bbo->bid_price_ != Price_INVALID && bbo->ask_price_ != Price_INVALID && fair_price != Feature_INVALID)) {
-                logger_->log("%:% %() % % fair-price:%\n", __FILE__, __LINE__, __FUNCTION__,
-                            Common::getCurrentTimeStr(&time_str_),
+                LOG_DEBUG((*logger_), "%:% %() % % fair-price:%\n", __FILE__, __LINE__, __FUNCTION__,
+                            Common::getTscTimestamp(),
                             bbo->toString().c_str(), fair_price);
 
                 const auto clip = ticker_cfg_.at(ticker_id).clip_;
@@ -37,24 +38,24 @@ namespace Trading {
 
                 START_MEASURE(Trading_OrderManager_moveOrders);
                 order_manager_->moveOrders(ticker_id, bid_price, ask_price, clip);
-                END_MEASURE(Trading_OrderManager_moveOrders, (*logger_));
+                END_MEASURE(Trading_OrderManager_moveOrders);
             }
         }
 
         /// Process trade events, which for the market making algorithm is none.
         auto onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook * /* book */) noexcept -> void {
-            logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            LOG_DEBUG((*logger_), "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                         market_update->toString().c_str());
         }
 
         /// Process client responses for the strategy's orders.
         auto onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void {
-            logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            LOG_DEBUG((*logger_), "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                         client_response->toString().c_str());
 
             START_MEASURE(Trading_OrderManager_onOrderUpdate);
             order_manager_->onOrderUpdate(client_response);
-            END_MEASURE(Trading_OrderManager_onOrderUpdate, (*logger_));
+            END_MEASURE(Trading_OrderManager_onOrderUpdate);
         }
 
         /// Deleted default, copy & move constructors and assignment-operators.
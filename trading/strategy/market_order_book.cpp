@@ -3,17 +3,18 @@
 #include "trade_engine.h"
 
 namespace Trading {
-    MarketOrderBook::MarketOrderBook(TickerId ticker_id, Logger *logger)
-        : ticker_id_(ticker_id), orders_at_price_pool_(ME_MAX_PRICE_LEVELS), order_pool_(ME_MAX_ORDER_IDS), logger_(logger) {
+    MarketOrderBook::MarketOrderBook(TickerId ticker_id, Logger *logger, const MemoryConfig &memory_config)
+        : ticker_id_(ticker_id), oid_to_order_(sparseTable(memory_config)), orders_at_price_pool_(ME_MAX_PRICE_LEVELS, memory_config),
+        order_pool_(ME_MAX_ORDER_IDS, memory_config), logger_(logger) {
     }
 
     MarketOrderBook::~MarketOrderBook() {
-        logger_->log("%:% %() % OrderBook\n%\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_), toString(false, true));
+        LOG_INFO((*logger_), "%:% %() % OrderBook\n%\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getTscTimestamp(), toString(false, true));
 
         trade_engine_ = nullptr;
         bids_by_price_ = asks_by_price_ = nullptr;
-        oid_to_order_.fill(nullptr);
+        oid_to_order_->fill(nullptr);
     }
 
     /// Process market data update and update the limit order book.
@@ -27,19 +28,19 @@ namespace Trading {
                                                 market_update->qty_, market_update->priority_, nullptr, nullptr);
                 START_MEASURE(Trading_MarketOrderBook_addOrder);
                 addOrder(order);
-                END_MEASURE(Trading_MarketOrderBook_addOrder, (*logger_));
+                END_MEASURE(Trading_MarketOrderBook_addOrder);
             }
             break;
             case Exchange::MarketUpdateType::MODIFY: {
-                auto order = oid_to_order_.at(market_update->order_id_);
+                auto order = oid_to_order_->at(market_update->order_id_);
                 order->qty_ = market_update->qty_;
             }
             break;
             case Exchange::MarketUpdateType::CANCEL: {
-                auto order = oid_to_order_.at(market_update->order_id_);
+                auto order = oid_to_order_->at(market_update->order_id_);
                 START_MEASURE(Trading_MarketOrderBook_removeOrder);
                 removeOrder(order);
-                END_MEASURE(Trading_MarketOrderBook_removeOrder, (*logger_));
+                END_MEASURE(Trading_MarketOrderBook_removeOrder);
             }
             break;
             case Exchange::MarketUpdateType::TRADE: {
@@ -48,11 +49,11 @@ namespace Trading {
             }
             break;
             case Exchange::MarketUpdateType::CLEAR: { // Clear the full limit order book and deallocate MarketOrdersAtPrice and MarketOrder objects.
-                for (auto &order: oid_to_order_) {
+                for (auto &order: *oid_to_order_) {
                     if (order)
                         order_pool_.deallocate(order);
                 }
-                oid_to_order_.fill(nullptr);
+                oid_to_order_->fill(nullptr);
 
                 if(bids_by_price_) {
                     for(auto bid = bids_by_price_->next_entry_; bid != bids_by_price_; bid = bid->next_entry_)
@@ -66,6 +67,8 @@ namespace Trading {
                 orders_at_price_pool_.deallocate(asks_by_price_);
             }
             bids_by_price_ = asks_by_price_ = nullptr;
+            bid_levels_.clear();
+            ask_levels_.clear();
         }
             break;
             case Exchange::MarketUpdateType::INVALID:
@@ -76,10 +79,10 @@ namespace Trading {
 
         START_MEASURE(Trading_MarketOrderBook_updateBBO);
         updateBBO(bid_updated, ask_updated);
-        END_MEASURE(Trading_MarketOrderBook_updateBBO, (*logger_));
+        END_MEASURE(Trading_MarketOrderBook_updateBBO);
 
-        logger_->log("%:% %() % % %", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_), market_update->toString(), bbo_.toString());
+        LOG_TRACE((*logger_), "%:% %() % % %", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getTscTimestamp(), market_update->toString(), bbo_.toString());
 
         trade_engine_->onOrderBookUpdate(market_update->ticker_id_, market_update->price_, market_update->side_, this);
     }
@@ -2,7 +2,9 @@
 
 #include "utils/types.h"
 #include "utils/mem_pool.h"
+#include "utils/memory_backing.h"
 #include "utils/logging.h"
+#include "utils/price_ladder.h"
 
 #include "market_order.h"
 #include "exchange/market_data/market_update.h"
@@ -10,9 +12,17 @@
 namespace Trading {
     class TradeEngine;
 
+    /// Backing of the per-book order pools, touched on every market update. The order index uses its sparseTable() variant.
+    constexpr MemoryConfig TRADING_ORDER_BOOK_MEMORY = HOT_PATH_MEMORY;
+
+    /// Ticks covered by each side's ladder window, kept centred on the side's best price.
+    constexpr size_t TRADING_PRICE_LADDER_LEVELS = 4096;
+    typedef PriceLevelIndex<MarketOrdersAtPrice, TRADING_PRICE_LADDER_LEVELS> MarketPriceLevels;
+
     class MarketOrderBook final {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::MARKET_ORDER_BOOK;
     public:
-        MarketOrderBook(TickerId ticker_id, Logger *logger);
+        MarketOrderBook(TickerId ticker_id, Logger *logger, const MemoryConfig &memory_config = {});
 
         ~MarketOrderBook();
 
@@ -71,8 +81,8 @@ namespace Trading {
         /// Parent trade engine that owns this limit order book, used to send notifications when book changes or trades occur.
         TradeEngine *trade_engine_ = nullptr;
 
-        /// Hash map from OrderId -> MarketOrder.
-        OrderHashMap oid_to_order_;
+        /// Hash map from OrderId -> MarketOrder, indexed by market order id so only a fraction of it is ever live: sparseTable() backed.
+        BackedObject<OrderHashMap> oid_to_order_;
 
         /// Memory pool to manage MarketOrdersAtPrice objects.
         MemPool<MarketOrdersAtPrice> orders_at_price_pool_;
@@ -81,8 +91,9 @@ namespace Trading {
         MarketOrdersAtPrice *bids_by_price_ = nullptr;
         MarketOrdersAtPrice *asks_by_price_ = nullptr;
 
-        /// Hash map from Price -> MarketOrdersAtPrice.
-        OrdersAtPriceHashMap price_orders_at_price_;
+        /// Price -> MarketOrdersAtPrice for each side, exact for any price.
+        MarketPriceLevels bid_levels_;
+        MarketPriceLevels ask_levels_;
 
         /// Memory pool to manage MarketOrder objects.
         MemPool<MarketOrder> order_pool_;
@@ -93,68 +104,43 @@ namespace Trading {
         Logger *logger_ = nullptr;
 
     private:
-        auto priceToIndex(Price price) const noexcept {
-            return (price % ME_MAX_PRICE_LEVELS);
-        }
-
-        /// Fetch and return the MarketOrdersAtPrice corresponding to the provided price.
-        auto getOrdersAtPrice(Price price) const noexcept -> MarketOrdersAtPrice * {
-            return price_orders_at_price_.at(priceToIndex(price));
+        /// Fetch and return the MarketOrdersAtPrice corresponding to the provided side and price.
+        auto getOrdersAtPrice(Side side, Price price) const noexcept -> MarketOrdersAtPrice * {
+            return (side == Side::BUY ? bid_levels_ : ask_levels_).at(price);
         }
 
-        /// Add a new MarketOrdersAtPrice at the correct price into the containers - the hash map and the doubly linked list of price levels.
+        /// Add a new MarketOrdersAtPrice at the correct price into the containers - the price level index and the doubly linked list of price levels.
         auto addOrdersAtPrice(MarketOrdersAtPrice *new_orders_at_price) noexcept {
-            price_orders_at_price_.at(priceToIndex(new_orders_at_price->price_)) = new_orders_at_price;
+            auto &levels = (new_orders_at_price->side_ == Side::BUY ? bid_levels_ : ask_levels_);
+            levels.insert(new_orders_at_price->price_, new_orders_at_price);
 
-            const auto best_orders_by_price = (new_orders_at_price->side_ == Side::BUY ? bids_by_price_ : asks_by_price_);
+            auto &best_orders_by_price = (new_orders_at_price->side_ == Side::BUY ? bids_by_price_ : asks_by_price_);
             if (UNLIKELY(!best_orders_by_price)) {
-                (new_orders_at_price->side_ == Side::BUY ? bids_by_price_ : asks_by_price_) = new_orders_at_price;
+                best_orders_by_price = new_orders_at_price;
                 new_orders_at_price->prev_entry_ = new_orders_at_price->next_entry_ = new_orders_at_price;
-            } else {
-                auto target = best_orders_by_price;
-                bool add_after = ((new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ > target->price_) ||
-                                (new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ < target->price_));
-                if (add_after) {
-                    target = target->next_entry_;
-                    add_after = ((new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ > target->price_) ||
-                                (new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ < target->price_));
-                }
-                while (add_after && target != best_orders_by_price) {
-                    add_after = ((new_orders_at_price->side_ == Side::SELL && new_orders_at_price->price_ > target->price_) ||
-                                (new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ < target->price_));
-                    if (add_after)
-                        target = target->next_entry_;
-                }
+                levels.recentre(new_orders_at_price->price_);
+                return;
+            }
 
-                if (add_after) { // add new_orders_at_price after target.
-                    if (target == best_orders_by_price) {
-                        target = best_orders_by_price->prev_entry_;
-                    }
-                    new_orders_at_price->prev_entry_ = target;
-                    target->next_entry_->prev_entry_ = new_orders_at_price;
-                    new_orders_at_price->next_entry_ = target->next_entry_;
-                    target->next_entry_ = new_orders_at_price;
-                } else { // add new_orders_at_price before target.
-                    new_orders_at_price->prev_entry_ = target->prev_entry_;
-                    new_orders_at_price->next_entry_ = target;
-                    target->prev_entry_->next_entry_ = new_orders_at_price;
-                    target->prev_entry_ = new_orders_at_price;
-
-                    if ((new_orders_at_price->side_ == Side::BUY && new_orders_at_price->price_ > best_orders_by_price->price_) ||
-                        (new_orders_at_price->side_ == Side::SELL &&
-                        new_orders_at_price->price_ < best_orders_by_price->price_)) {
-                        target->next_entry_ = (target->next_entry_ == best_orders_by_price ? new_orders_at_price
-                                                                                        : target->next_entry_);
-                        (new_orders_at_price->side_ == Side::BUY ? bids_by_price_ : asks_by_price_) = new_orders_at_price;
-                    }
-                }
+            // the next better level is the nearest live one above a bid / below an ask, none means the new level is the best.
+            const auto better = (new_orders_at_price->side_ == Side::BUY ? levels.higher(new_orders_at_price->price_) :
+                                                                         levels.lower(new_orders_at_price->price_));
+            const auto target = (better ? better : best_orders_by_price->prev_entry_);
+            new_orders_at_price->prev_entry_ = target;
+            new_orders_at_price->next_entry_ = target->next_entry_;
+            target->next_entry_->prev_entry_ = new_orders_at_price;
+            target->next_entry_ = new_orders_at_price;
+            if (!better) {
+                best_orders_by_price = new_orders_at_price;
+                levels.recentre(new_orders_at_price->price_);
             }
         }
 
         /// Remove the MarketOrdersAtPrice from the containers - the hash map and the doubly linked list of price levels.
         auto removeOrdersAtPrice(Side side, Price price) noexcept {
             const auto best_orders_by_price = (side == Side::BUY ? bids_by_price_ : asks_by_price_);
-            auto orders_at_price = getOrdersAtPrice(price);
+            auto &levels = (side == Side::BUY ? bid_levels_ : ask_levels_);
+            auto orders_at_price = levels.at(price);
 
             if (UNLIKELY(orders_at_price->next_entry_ == orders_at_price)) { // empty side of book.
                 (side == Side::BUY ? bids_by_price_ : asks_by_price_) = nullptr;
@@ -169,13 +155,16 @@ namespace Trading {
                 orders_at_price->prev_entry_ = orders_at_price->next_entry_ = nullptr;
             }
 
-            price_orders_at_price_.at(priceToIndex(price)) = nullptr;
+            levels.erase(price);
+            if (orders_at_price == best_orders_by_price && (side == Side::BUY ? bids_by_price_ : asks_by_price_)) {
+                levels.recentre((side == Side::BUY ? bids_by_price_ : asks_by_price_)->price_);
+            }
             orders_at_price_pool_.deallocate(orders_at_price);
         }
 
             /// Remove and de-allocate provided order from the containers.
         auto removeOrder(MarketOrder *order) noexcept -> void {
-            auto orders_at_price = getOrdersAtPrice(order->price_);
+            auto orders_at_price = getOrdersAtPrice(order->side_, order->price_);
 
             if (order->prev_order_ == order) { // only one element.
                 removeOrdersAtPrice(order->side_, order->price_);
@@ -192,13 +181,13 @@ namespace Trading {
                 order->prev_order_ = order->next_order_ = nullptr;
             }
 
-            oid_to_order_.at(order->order_id_) = nullptr;
+            oid_to_order_->at(order->order_id_) = nullptr;
             order_pool_.deallocate(order);
         }
 
         /// Add a single order at the end of the FIFO queue at the price level that this order belongs in.
         auto addOrder(MarketOrder *order) noexcept -> void {
-            const auto orders_at_price = getOrdersAtPrice(order->price_);
+            const auto orders_at_price = getOrdersAtPrice(order->side_, order->price_);
 
             if (!orders_at_price) {
                 order->next_order_ = order->prev_order_ = order;
@@ -214,7 +203,7 @@ namespace Trading {
                 first_order->prev_order_ = order;
             }
 
-            oid_to_order_.at(order->order_id_) = order;
+            oid_to_order_->at(order->order_id_) = order;
         }
     };
 
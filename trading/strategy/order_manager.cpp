@@ -2,16 +2,17 @@
 #include "trade_engine.h"
 
 namespace Trading {
-    auto OrderManager::newOrder(OMOrder *order, TickerId ticker_id, Price price, Side side, Qty qty) noexcept -> void {
+    auto OrderManager::newOrder(OMOrder *order, TickerId ticker_id, Price price, Side side, Qty qty,
+                                Exchange::TimeInForce time_in_force) noexcept -> void {
         const Exchange::MEClientRequest new_request{Exchange::ClientRequestType::NEW, trade_engine_->clientId(), ticker_id,
-                                                    next_order_id_, side, price, qty};
+                                                    next_order_id_, side, price, qty, Exchange::OrderType::LIMIT, time_in_force};
         trade_engine_->sendClientRequest(&new_request);
 
         *order = {ticker_id, next_order_id_, side, price, qty, OMOrderState::PENDING_NEW};
         ++next_order_id_;
 
-        logger_->log("%:% %() % Sent new order % for %\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_),
+        LOG_DEBUG((*logger_), "%:% %() % Sent new order % for %\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getTscTimestamp(),
                     new_request.toString().c_str(), order->toString().c_str());
     }
 
@@ -23,8 +24,32 @@ namespace Trading {
 
         order->order_state_ = OMOrderState::PENDING_CANCEL;
 
-        logger_->log("%:% %() % Sent cancel % for %\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_),
+        LOG_DEBUG((*logger_), "%:% %() % Sent cancel % for %\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getTscTimestamp(),
                     cancel_request.toString().c_str(), order->toString().c_str());
     }
+
+    /// Sends both sides of ticker_id as one mass quote. The legs take client order ids next_order_id_ and the one after,
+    /// and stay pending until their QUOTE_ACCEPTED, which also tells whether they rest. A leg with qty 0 is pulled.
+    auto OrderManager::quoteOrders(TickerId ticker_id, OMOrder *bid_order, Price bid_price, Qty bid_qty, OMOrder *ask_order, Price ask_price,
+                                   Qty ask_qty) noexcept -> void {
+        const Exchange::MEClientRequest quote_request{Exchange::ClientRequestType::MASS_QUOTE, trade_engine_->clientId(), ticker_id,
+                                                    next_order_id_, Side::INVALID, bid_price, bid_qty, Exchange::OrderType::LIMIT,
+                                                    Exchange::TimeInForce::GTC, ask_price, ask_qty};
+        trade_engine_->sendClientRequest(&quote_request);
+
+        auto setLeg = [&](OMOrder *order, Side side, Price price, Qty qty, OrderId order_id) {
+            if (qty)
+                *order = {ticker_id, order_id, side, price, qty, OMOrderState::PENDING_NEW};
+            else // pulled, or confirmed not to rest if it did not: every leg is acknowledged
+                order->order_state_ = OMOrderState::PENDING_CANCEL;
+        };
+        setLeg(bid_order, Side::BUY, bid_price, bid_qty, next_order_id_);
+        setLeg(ask_order, Side::SELL, ask_price, ask_qty, next_order_id_ + 1);
+        next_order_id_ += 2;
+
+        LOG_DEBUG((*logger_), "%:% %() % Sent mass quote % for % %\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getTscTimestamp(),
+                    quote_request.toString().c_str(), bid_order->toString().c_str(), ask_order->toString().c_str());
+    }
 }
\ No newline at end of file
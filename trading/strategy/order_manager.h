@@ -2,6 +2,7 @@
 
 #include "utils/macros.h"
 #include "utils/logging.h"
+#include "exchange/order_server/client_request.h"
 #include "exchange/order_server/client_response.h"
 #include "om_order.h"
 #include "risk_manager.h"
@@ -12,15 +13,16 @@ namespace Trading {
     class TradeEngine;
 
     class OrderManager {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::ORDER_MANAGER;
     public:
         OrderManager(Common::Logger *logger, TradeEngine *trade_engine, RiskManager& risk_manager)
             : trade_engine_(trade_engine), risk_manager_(risk_manager), logger_(logger) {}
 
         auto onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void {
-            logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            LOG_DEBUG((*logger_), "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                         client_response->toString().c_str());
             auto order = &(ticker_side_order_.at(client_response->ticker_id_).at(sideToIndex(client_response->side_)));
-            logger_->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            LOG_DEBUG((*logger_), "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                         order->toString().c_str());
 
             switch (client_response->type_) {
@@ -38,60 +40,92 @@ namespace Trading {
                     order->order_state_ = OMOrderState::DEAD;
                 }
                 break;
+                case Exchange::ClientResponseType::QUOTE_ACCEPTED: { // the leg now has the quote's client order id
+                    order->order_id_ = client_response->client_order_id_;
+                    order->price_ = client_response->price_;
+                    order->qty_ = client_response->leaves_qty_;
+                    order->order_state_ = (order->qty_ ? OMOrderState::LIVE : OMOrderState::DEAD);
+                }
+                break;
+                case Exchange::ClientResponseType::REJECTED:
+                case Exchange::ClientResponseType::QUOTE_REJECTED: {
+                    order->order_state_ = OMOrderState::DEAD;
+                }
+                break;
                 case Exchange::ClientResponseType::CANCEL_REJECTED:
+                case Exchange::ClientResponseType::MODIFIED: // this client requotes with mass quotes and never sends a MODIFY
+                case Exchange::ClientResponseType::MODIFY_REJECTED:
                 case Exchange::ClientResponseType::INVALID: {}
                 break;
             }
         }
 
-        auto newOrder(OMOrder *order, TickerId ticker_id, Price price, Side side, Qty qty) noexcept -> void;
+        auto newOrder(OMOrder *order, TickerId ticker_id, Price price, Side side, Qty qty,
+                      Exchange::TimeInForce time_in_force = Exchange::TimeInForce::GTC) noexcept -> void;
 
         auto cancelOrder(OMOrder *order) noexcept -> void;
 
-        auto moveOrder(OMOrder *order, TickerId ticker_id, Price price, Side side, Qty qty) noexcept {
-            switch (order->order_state_) {
-                case OMOrderState::LIVE: {
-                    if(order->price_ != price)
-                        START_MEASURE(Trading_OrderManager_cancelOrder);    
-                        cancelOrder(order);
-                        END_MEASURE(Trading_OrderManager_cancelOrder, (*logger_));
-                    }
-                break;
-                case OMOrderState::INVALID:
-                case OMOrderState::DEAD: {
-                    if(LIKELY(price != Price_INVALID)) {
-                        START_MEASURE(Trading_RiskManager_checkPreTradeRisk);
-                        const auto risk_result = risk_manager_.checkPreTradeRisk(ticker_id, side, qty);
-                        END_MEASURE(Trading_RiskManager_checkPreTradeRisk, (*logger_));
-                        
-                        if(LIKELY(risk_result == RiskCheckResult::ALLOWED))
-                            START_MEASURE(Trading_OrderManager_newOrder);
-                            newOrder(order, ticker_id, price, side, qty);
-                            END_MEASURE(Trading_OrderManager_newOrder, (*logger_));
-                        else
-                            logger_->log("%:% %() % Ticker:% Side:% Qty:% RiskCheckResult:%\n", __FILE__, __LINE__, __FUNCTION__,
-                                        Common::getCurrentTimeStr(&time_str_),
-                                        tickerIdToString(ticker_id), sideToString(side), qtyToString(qty),
-                                        riskCheckResultToString(risk_result));
-                        }
-                    }
-                break;
-                case OMOrderState::PENDING_NEW:
-                case OMOrderState::PENDING_CANCEL:
-                break;
-            }
-        }
+        auto quoteOrders(TickerId ticker_id, OMOrder *bid_order, Price bid_price, Qty bid_qty, OMOrder *ask_order, Price ask_price,
+                         Qty ask_qty) noexcept -> void;
 
+        /// Moves both sides' orders to bid_price / ask_price with one mass quote, Price_INVALID pulling that side.
+        /// Nothing is sent while either side waits on the exchange or when neither side would change.
         auto moveOrders(TickerId ticker_id, Price bid_price, Price ask_price, Qty clip) noexcept {
             auto bid_order = &(ticker_side_order_.at(ticker_id).at(sideToIndex(Side::BUY)));
-            START_MEASURE(Trading_OrderManager_moveOrder);
-            moveOrder(bid_order, ticker_id, bid_price, Side::BUY, clip);
-            END_MEASURE(Trading_OrderManager_moveOrder, (*logger_));
-
             auto ask_order = &(ticker_side_order_.at(ticker_id).at(sideToIndex(Side::SELL)));
-            START_MEASURE(Trading_OrderManager_moveOrder);
-            moveOrder(ask_order, ticker_id, ask_price, Side::SELL, clip);
-            END_MEASURE(Trading_OrderManager_moveOrder, (*logger_));
+            auto isPending = [](const OMOrder *order) {
+                return (order->order_state_ == OMOrderState::PENDING_NEW || order->order_state_ == OMOrderState::PENDING_CANCEL);
+            };
+            auto isUnchanged = [](const OMOrder *order, Price price) {
+                return (order->order_state_ == OMOrderState::LIVE ? order->price_ == price : price == Price_INVALID);
+            };
+            if (isPending(bid_order) || isPending(ask_order) || (isUnchanged(bid_order, bid_price) && isUnchanged(ask_order, ask_price)))
+                return;
+
+            // a side the risk manager does not allow is pulled, the other one still quoted
+            auto legQty = [&](Side side, Price price) -> Qty {
+                if (price == Price_INVALID)
+                    return 0;
+                START_MEASURE(Trading_RiskManager_checkPreTradeRisk);
+                const auto risk_result = risk_manager_.checkPreTradeRisk(ticker_id, side, clip);
+                END_MEASURE(Trading_RiskManager_checkPreTradeRisk);
+                if (LIKELY(risk_result == RiskCheckResult::ALLOWED))
+                    return clip;
+                LOG_WARN((*logger_), "%:% %() % Ticker:% Side:% Qty:% RiskCheckResult:%\n", __FILE__, __LINE__, __FUNCTION__,
+                            Common::getTscTimestamp(),
+                            tickerIdToString(ticker_id), sideToString(side), qtyToString(clip),
+                            riskCheckResultToString(risk_result));
+                return 0;
+            };
+            const auto bid_qty = legQty(Side::BUY, bid_price);
+            const auto ask_qty = legQty(Side::SELL, ask_price);
+
+            START_MEASURE(Trading_OrderManager_quoteOrders);
+            quoteOrders(ticker_id, bid_order, bid_price, bid_qty, ask_order, ask_price, ask_qty);
+            END_MEASURE(Trading_OrderManager_quoteOrders);
+        }
+
+        /// Sends an immediate-or-cancel order for qty at price or better on side, unless the side's order is still in
+        /// flight. Whatever does not trade is canceled by the exchange, so nothing is left resting to cancel afterwards.
+        auto takeLiquidity(TickerId ticker_id, Price price, Side side, Qty qty) noexcept {
+            auto order = &(ticker_side_order_.at(ticker_id).at(sideToIndex(side)));
+            if (order->order_state_ != OMOrderState::DEAD && order->order_state_ != OMOrderState::INVALID)
+                return;
+
+            START_MEASURE(Trading_RiskManager_checkPreTradeRisk);
+            const auto risk_result = risk_manager_.checkPreTradeRisk(ticker_id, side, qty);
+            END_MEASURE(Trading_RiskManager_checkPreTradeRisk);
+
+            if(LIKELY(risk_result == RiskCheckResult::ALLOWED)) {
+                START_MEASURE(Trading_OrderManager_newOrder);
+                newOrder(order, ticker_id, price, side, qty, Exchange::TimeInForce::IOC);
+                END_MEASURE(Trading_OrderManager_newOrder);
+            } else {
+                LOG_WARN((*logger_), "%:% %() % Ticker:% Side:% Qty:% RiskCheckResult:%\n", __FILE__, __LINE__, __FUNCTION__,
+                            Common::getTscTimestamp(),
+                            tickerIdToString(ticker_id), sideToString(side), qtyToString(qty),
+                            riskCheckResultToString(risk_result));
+            }
         }
 
         auto getOMOrderSideHashMap(TickerId ticker_id) const {
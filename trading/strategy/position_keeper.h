@@ -11,6 +11,7 @@ using namespace Common;
 namespace Trading {
 
     struct PositionInfo {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::ORDER_MANAGER;
         int32_t position_ = 0;
         double real_pnl_ = 0, unreal_pnl_ = 0, total_pnl_ = 0;
         std::array<double, sideToIndex(Side::MAX) + 1> open_vwap_;
@@ -70,7 +71,7 @@ namespace Trading {
             total_pnl_ = unreal_pnl_ + real_pnl_;
 
             std::string time_str;
-            logger->log("%:% %() % % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str),
+            LOG_DEBUG((*logger), "%:% %() % % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                         toString(), client_response->toString().c_str());
         }
 
@@ -93,7 +94,7 @@ namespace Trading {
                 total_pnl_ = unreal_pnl_ + real_pnl_;
 
                 if (total_pnl_ != old_total_pnl)
-                    logger->log("%:% %() % % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str),
+                    LOG_TRACE((*logger), "%:% %() % % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                                 toString(), bbo_->toString());
             }
         }
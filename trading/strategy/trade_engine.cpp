@@ -14,7 +14,7 @@ namespace Trading {
             order_manager_(&logger_, this, risk_manager_),
             risk_manager_(&logger_, &position_keeper_, ticker_cfg) {
         for (size_t i = 0; i < ticker_order_book_.size(); ++i) {
-            ticker_order_book_[i] = new MarketOrderBook(i, &logger_);
+            ticker_order_book_[i] = new MarketOrderBook(i, &logger_, TRADING_ORDER_BOOK_MEMORY);
             ticker_order_book_[i]->setTradeEngine(this);
         }
 
@@ -34,8 +34,8 @@ namespace Trading {
         }
 
         for (TickerId i = 0; i < ticker_cfg.size(); ++i) {
-            logger_.log("%:% %() % Initialized % Ticker:% %.\n", __FILE__, __LINE__, __FUNCTION__,
-                        Common::getCurrentTimeStr(&time_str_),
+            LOG_INFO(logger_, "%:% %() % Initialized % Ticker:% %.\n", __FILE__, __LINE__, __FUNCTION__,
+                        Common::getTscTimestamp(),
                         algoTypeToString(algo_type), i,
                         ticker_cfg.at(i).toString());
         }
@@ -62,90 +62,92 @@ namespace Trading {
 
     /// Write a client request to the lock free queue for the order server to consume and send to the exchange.
     auto TradeEngine::sendClientRequest(const Exchange::MEClientRequest *client_request) noexcept -> void {
-        logger_.log("%:% %() % Sending %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+        LOG_DEBUG(logger_, "%:% %() % Sending %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                     client_request->toString().c_str());
+        const auto trace_id = Common::makeTraceId(client_id_, next_trace_seq_num_++); // every hop of this request is stamped with it
         auto next_write = outgoing_ogw_requests_->getNextToWriteTo();
         *next_write = std::move(*client_request);
+        next_write->trace_id_ = trace_id;
         outgoing_ogw_requests_->updateWriteIndex();
-        TTT_MEASURE(T10_TradeEngine_LFQueue_write, logger_);
+        TTT_TRACE(T10_TradeEngine_LFQueue_write, trace_id);
     }
 
     /// Main loop for this thread - processes incoming client responses and market data updates which in turn may generate client requests.
     auto TradeEngine::run() noexcept -> void {
-        logger_.log("%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_));
+        LOG_INFO(logger_, "%:% %() %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp());
         while (run_) {
             for (auto client_response = incoming_ogw_responses_->getNextToRead(); client_response; client_response = incoming_ogw_responses_->getNextToRead()) {
-                TTT_MEASURE(T9t_TradeEngine_LFQueue_read, logger_);
+                TTT_TRACE(T9t_TradeEngine_LFQueue_read, client_response->trace_id_);
 
-                logger_.log("%:% %() % Processing %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                LOG_DEBUG(logger_, "%:% %() % Processing %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                             client_response->toString().c_str());
                 onOrderUpdate(client_response);
                 incoming_ogw_responses_->updateReadIndex();
-                last_event_time_ = Common::getCurrentNanos();
+                last_event_time_ = Common::getTscNanos();
             }
 
             for (auto market_update = incoming_md_updates_->getNextToRead(); market_update; market_update = incoming_md_updates_->getNextToRead()) {
-                TTT_MEASURE(T9_TradeEngine_LFQueue_read, logger_);
+                TTT_TRACE(T9_TradeEngine_LFQueue_read, market_update->trace_id_);
 
-                logger_.log("%:% %() % Processing %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+                LOG_DEBUG(logger_, "%:% %() % Processing %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                             market_update->toString().c_str());
                 ASSERT(market_update->ticker_id_ < ticker_order_book_.size(),
                     "Unknown ticker-id on update:" + market_update->toString());
                 ticker_order_book_[market_update->ticker_id_]->onMarketUpdate(market_update);
                 incoming_md_updates_->updateReadIndex();
-                last_event_time_ = Common::getCurrentNanos();
+                last_event_time_ = Common::getTscNanos();
             }
         }
     }
 
     /// Process changes to the order book - updates the position keeper, feature engine and informs the trading algorithm about the update.
     auto TradeEngine::onOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook *book) noexcept -> void {
-        logger_.log("%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str_), ticker_id, Common::priceToString(price).c_str(),
+        LOG_DEBUG(logger_, "%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getTscTimestamp(), ticker_id, Common::priceToString(price).c_str(),
                     Common::sideToString(side).c_str());
         
         auto bbo = book->getBBO();
 
         START_MEASURE(Trading_PositionKeeper_updateBBO);
         position_keeper_.updateBBO(ticker_id, bbo);
-        END_MEASURE(Trading_PositionKeeper_updateBBO, logger_);
+        END_MEASURE(Trading_PositionKeeper_updateBBO);
 
         START_MEASURE(Trading_FeatureEngine_onOrderBookUpdate);
         feature_engine_.onOrderBookUpdate(ticker_id, price, side, book);
-        END_MEASURE(Trading_FeatureEngine_onOrderBookUpdate, logger_);
+        END_MEASURE(Trading_FeatureEngine_onOrderBookUpdate);
         
         START_MEASURE(Trading_TradeEngine_algoOnOrderBookUpdate_);
         algoOnOrderBookUpdate_(ticker_id, price, side, book);
-        END_MEASURE(Trading_TradeEngine_algoOnOrderBookUpdate_, logger_);
+        END_MEASURE(Trading_TradeEngine_algoOnOrderBookUpdate_);
     }
 
     /// Process trade events - updates the  feature engine and informs the trading algorithm about the trade event.
     auto TradeEngine::onTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *book) noexcept -> void {
-        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+        LOG_DEBUG(logger_, "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                     market_update->toString().c_str());
 
         START_MEASURE(Trading_FeatureEngine_onTradeUpdate);
         feature_engine_.onTradeUpdate(market_update, book);
-        END_MEASURE(Trading_FeatureEngine_onTradeUpdate, logger_);
+        END_MEASURE(Trading_FeatureEngine_onTradeUpdate);
 
         START_MEASURE(Trading_TradeEngine_algoOnTradeUpdate_);
         algoOnTradeUpdate_(market_update, book);
-        END_MEASURE(Trading_TradeEngine_algoOnTradeUpdate_, logger_);
+        END_MEASURE(Trading_TradeEngine_algoOnTradeUpdate_);
     }
 
     /// Process client responses - updates the position keeper and informs the trading algorithm about the response.
     auto TradeEngine::onOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void {
-        logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+        LOG_DEBUG(logger_, "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                     client_response->toString().c_str());
 
         if (UNLIKELY(client_response->type_ == Exchange::ClientResponseType::FILLED)) {
             START_MEASURE(Trading_PositionKeeper_addFill);
             position_keeper_.addFill(client_response);
-            END_MEASURE(Trading_PositionKeeper_addFill, logger_);
+            END_MEASURE(Trading_PositionKeeper_addFill);
         }
 
         START_MEASURE(Trading_TradeEngine_algoOnOrderUpdate_);
         algoOnOrderUpdate_(client_response);
-        END_MEASURE(Trading_TradeEngine_algoOnOrderUpdate_, logger_);
+        END_MEASURE(Trading_TradeEngine_algoOnOrderUpdate_);
     }
 }
\ No newline at end of file
@@ -24,6 +24,7 @@
 
 namespace Trading {
     class TradeEngine {
+        static constexpr auto LOG_COMPONENT = Common::LogComponent::TRADE_ENGINE;
     public:
         TradeEngine(Common::ClientId client_id,
                     AlgoType algo_type,
@@ -42,14 +43,14 @@ namespace Trading {
 
         auto stop() -> void {
             while(incoming_ogw_responses_->size() || incoming_md_updates_->size()) {
-                logger_.log("%:% %() % Sleeping till all updates are consumed ogw-size:% md-size:%\n", __FILE__, __LINE__, __FUNCTION__,
-                            Common::getCurrentTimeStr(&time_str_), incoming_ogw_responses_->size(), incoming_md_updates_->size());
+                LOG_INFO(logger_, "%:% %() % Sleeping till all updates are consumed ogw-size:% md-size:%\n", __FILE__, __LINE__, __FUNCTION__,
+                            Common::getTscTimestamp(), incoming_ogw_responses_->size(), incoming_md_updates_->size());
 
                 using namespace std::literals::chrono_literals;
                 std::this_thread::sleep_for(10ms);
             }
 
-            logger_.log("%:% %() % POSITIONS\n%\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            LOG_INFO(logger_, "%:% %() % POSITIONS\n%\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                         position_keeper_.toString());
             run_ = false;
         }
@@ -75,11 +76,11 @@ namespace Trading {
         std::function<void(const Exchange::MEClientResponse *client_response)> algoOnOrderUpdate_;
 
         auto initLastEventTime() {
-            last_event_time_ = Common::getCurrentNanos();
+            last_event_time_ = Common::getTscNanos();
         }
 
         auto silentSeconds() {
-            return (Common::getCurrentNanos() - last_event_time_) / NANOS_TO_SECS;
+            return (Common::getTscNanos() - last_event_time_) / NANOS_TO_SECS;
         }
 
         auto clientId() const {
@@ -109,6 +110,7 @@ namespace Trading {
         Exchange::MEMarketUpdateLFQueue *incoming_md_updates_ = nullptr;
 
         Nanos last_event_time_ = 0;
+        uint64_t next_trace_seq_num_ = 0; // for the trace ids of outgoing requests
         volatile bool run_ = false;
 
         std::string time_str_;
@@ -132,18 +134,18 @@ namespace Trading {
 
         /// Default methods to initialize the function wrappers.
         auto defaultAlgoOnOrderBookUpdate(TickerId ticker_id, Price price, Side side, MarketOrderBook *) noexcept -> void {
-            logger_.log("%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
-                        Common::getCurrentTimeStr(&time_str_), ticker_id, Common::priceToString(price).c_str(),
+            LOG_DEBUG(logger_, "%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, __FUNCTION__,
+                        Common::getTscTimestamp(), ticker_id, Common::priceToString(price).c_str(),
                         Common::sideToString(side).c_str());
         }
 
         auto defaultAlgoOnTradeUpdate(const Exchange::MEMarketUpdate *market_update, MarketOrderBook *) noexcept -> void {
-            logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            LOG_DEBUG(logger_, "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                         market_update->toString().c_str());
         }
 
         auto defaultAlgoOnOrderUpdate(const Exchange::MEClientResponse *client_response) noexcept -> void {
-            logger_.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str_),
+            LOG_DEBUG(logger_, "%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(),
                         client_response->toString().c_str());
         }
     };
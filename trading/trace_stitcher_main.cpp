@@ -0,0 +1,28 @@
+#include <iostream>
+#include <fstream>
+
+#include "utils/trace.h"
+
+/// ./trace_stitcher_main TRACE_FILE_1 [TRACE_FILE_2] ...
+/// Merges the exchange_trace.bin and trading_trace_<id>.bin files of one run into trace_records.csv (one row per order)
+/// and prints the per-hop latency distribution. Run it on the host that produced the files, it calibrates the same TSC.
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        FATAL("USAGE trace_stitcher_main TRACE_FILE_1 [TRACE_FILE_2] ...");
+    }
+
+    Common::TraceStitcher stitcher;
+    for (int i = 1; i < argc; ++i) {
+        const auto num_stamps = stitcher.load(argv[i]);
+        std::cerr << argv[i] << ": " << num_stamps << " stamps" << std::endl;
+    }
+    std::cerr << stitcher.numTraces() << " traces" << std::endl;
+
+    std::ofstream records("trace_records.csv");
+    ASSERT(records.is_open(), "Could not open trace_records.csv");
+    stitcher.writeRecords(records);
+
+    stitcher.writeSummary(std::cout);
+
+    return 0;
+}
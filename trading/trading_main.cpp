@@ -6,13 +6,16 @@
 
 #include "utils/logging.h"
 
+constexpr auto LOG_COMPONENT = Common::LogComponent::MAIN;
+
 /// Main components.
 Common::Logger *logger = nullptr;
 Trading::TradeEngine *trade_engine = nullptr;
 Trading::MarketDataConsumer *market_data_consumer = nullptr;
 Trading::OrderGateway *order_gateway = nullptr;
 
-/// ./trading_main CLIENT_ID ALGO_TYPE [CLIP_1 THRESH_1 MAX_ORDER_SIZE_1 MAX_POS_1 MAX_LOSS_1] [CLIP_2 THRESH_2 MAX_ORDER_SIZE_2 MAX_POS_2 MAX_LOSS_2] ...
+/// ./trading_main CLIENT_ID ALGO_TYPE [CLIP_1 THRESH_1 MAX_ORDER_SIZE_1 MAX_POS_1 MAX_LOSS_1] [CLIP_2 THRESH_2 MAX_ORDER_SIZE_2 MAX_POS_2 MAX_LOSS_2] ... [REQUIRE_MLOCK]
+/// A trailing REQUIRE_MLOCK=1 after the last group makes a failed mlock() of the order books and socket buffers FATAL.
 int main(int argc, char **argv) {
     if(argc < 3) {
         FATAL("USAGE trading_main CLIENT_ID ALGO_TYPE [CLIP_1 THRESH_1 MAX_ORDER_SIZE_1 MAX_POS_1 MAX_LOSS_1] [CLIP_2 THRESH_2 MAX_ORDER_SIZE_2 MAX_POS_2 MAX_LOSS_2] ...");
@@ -22,8 +25,18 @@ int main(int argc, char **argv) {
     srand(client_id);
 
     const auto algo_type = stringToAlgoType(argv[2]);
+    const bool require_mlock = ((argc - 3) % 5 == 1 && atoi(argv[argc - 1]) != 0);
+    Common::requireMemoryLock(require_mlock);
 
+    // calibrate the TSC clock before any component logs, then keep it aligned with the system clock
+    Common::TscClock::instance().startDriftCorrection(-1, 1000);
+    // every component's Logger is drained by this one writer thread, unpinned like the trading threads themselves
+    Common::LogWriter::instance().start({.core_id_ = -1});
     logger = new Common::Logger("trading_main_" + std::to_string(client_id) + ".log");
+    // per-tag latency percentiles, every 10s and once more on exit
+    Common::LatencyRegistry::instance().startDumping("trading_latency_" + std::to_string(client_id) + ".csv", 10 * 1000, -1);
+    // per-hop (trace id, TSC) stamps, stitched with the exchange's file by trace_stitcher_main
+    Common::TraceCollector::instance().start("trading_trace_" + std::to_string(client_id) + ".bin", -1);
 
     const int sleep_time = 20 * 1000;
 
@@ -39,14 +52,14 @@ int main(int argc, char **argv) {
     // Parse and initialize the TradeEngineCfgHashMap above from the command line arguments.
     // [CLIP_1 THRESH_1 MAX_ORDER_SIZE_1 MAX_POS_1 MAX_LOSS_1] [CLIP_2 THRESH_2 MAX_ORDER_SIZE_2 MAX_POS_2 MAX_LOSS_2] ...
     size_t next_ticker_id = 0;
-    for (int i = 3; i < argc; i += 5, ++next_ticker_id) {
+    for (int i = 3; i + 4 < argc; i += 5, ++next_ticker_id) {
         ticker_cfg.at(next_ticker_id) = {static_cast<Qty>(std::atoi(argv[i])), std::atof(argv[i + 1]),
                                         {static_cast<Qty>(std::atoi(argv[i + 2])),
                                         static_cast<Qty>(std::atoi(argv[i + 3])),
                                         std::atof(argv[i + 4])}};
     }
 
-    logger->log("%:% %() % Starting Trade Engine...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
+    LOG_INFO((*logger), "%:% %() % Starting Trade Engine...\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp());
     trade_engine = new Trading::TradeEngine(client_id, algo_type,
                                             ticker_cfg,
                                             &client_requests,
@@ -58,7 +71,7 @@ int main(int argc, char **argv) {
     const std::string order_gw_iface = "lo";
     const int order_gw_port = 12345;
 
-    logger->log("%:% %() % Starting Order Gateway...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
+    LOG_INFO((*logger), "%:% %() % Starting Order Gateway...\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp());
     order_gateway = new Trading::OrderGateway(client_id, &client_requests, &client_responses, order_gw_ip, order_gw_iface, order_gw_port);
     order_gateway->start();
 
@@ -68,7 +81,7 @@ int main(int argc, char **argv) {
     const std::string incremental_ip = "233.252.14.3";
     const int incremental_port = 20001;
 
-    logger->log("%:% %() % Starting Market Data Consumer...\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
+    LOG_INFO((*logger), "%:% %() % Starting Market Data Consumer...\n", __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp());
     market_data_consumer = new Trading::MarketDataConsumer(client_id, &market_updates, mkt_data_iface, snapshot_ip, snapshot_port, incremental_ip, incremental_port);
     market_data_consumer->start();
 
@@ -103,8 +116,8 @@ int main(int argc, char **argv) {
             usleep(sleep_time);
 
             if (trade_engine->silentSeconds() >= 60) {
-                logger->log("%:% %() % Stopping early because been silent for % seconds...\n", __FILE__, __LINE__, __FUNCTION__,
-                            Common::getCurrentTimeStr(&time_str), trade_engine->silentSeconds());
+                LOG_INFO((*logger), "%:% %() % Stopping early because been silent for % seconds...\n", __FILE__, __LINE__, __FUNCTION__,
+                            Common::getTscTimestamp(), trade_engine->silentSeconds());
 
                 break;
             }
@@ -112,8 +125,8 @@ int main(int argc, char **argv) {
     }
 
     while (trade_engine->silentSeconds() < 60) {
-        logger->log("%:% %() % Waiting till no activity, been silent for % seconds...\n", __FILE__, __LINE__, __FUNCTION__,
-                    Common::getCurrentTimeStr(&time_str), trade_engine->silentSeconds());
+        LOG_INFO((*logger), "%:% %() % Waiting till no activity, been silent for % seconds...\n", __FILE__, __LINE__, __FUNCTION__,
+                    Common::getTscTimestamp(), trade_engine->silentSeconds());
 
         using namespace std::literals::chrono_literals;
         std::this_thread::sleep_for(30s);
@@ -1,48 +1,178 @@
-#pragma once 
-#include <iostream> 
-#include <vector> 
-#include <atomic> 
+#pragma once
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <span>
+#include <limits>
+#include <algorithm>
 #include "macros.h"
 
 namespace Common {
-    template <typename T> 
-    class LFQueue final {
+    // SHARED_COUNTER: original ring, both indices and an element counter share one cache line
+    // SPSC_RING: power-of-two ring, each index on its own cache line, cached peer indices, no shared counter
+    enum class LFQueueMode : uint8_t {
+        SHARED_COUNTER = 0,
+        SPSC_RING = 1
+    };
+
+    template <typename T, LFQueueMode Mode = LFQueueMode::SPSC_RING>
+    class LFQueue;
+
+    template <typename T>
+    class LFQueue<T, LFQueueMode::SHARED_COUNTER> final {
     private:
-        std::vector<T> store_; 
-        std::atomic<size_t> next_write_index_ = {0}; 
-        std::atomic<size_t> next_read_index_ = {0}; 
-        std::atomic<size_t> num_elements_ = {0}; 
+        std::vector<T> store_;
+        std::atomic<size_t> next_write_index_ = {0};
+        std::atomic<size_t> next_read_index_ = {0};
+        std::atomic<size_t> num_elements_ = {0};
 
-    public: 
+    public:
         LFQueue(std::size_t num_elems) : store_(num_elems, T()){} /*vector storage pre-allocation*/
 
-        LFQueue() = delete; 
-        LFQueue(const LFQueue&) = delete; 
-        LFQueue(const LFQueue&&) = delete; 
-        LFQueue& operator=(const LFQueue&) = delete; 
-        LFQueue& operator=(const LFQueue&&) = delete; 
+        LFQueue() = delete;
+        LFQueue(const LFQueue&) = delete;
+        LFQueue(const LFQueue&&) = delete;
+        LFQueue& operator=(const LFQueue&) = delete;
+        LFQueue& operator=(const LFQueue&&) = delete;
 
         auto getNextToWriteTo() noexcept {
-            return &store_[next_write_index_]; 
+            return &store_[next_write_index_];
         }
 
         auto updateWriteIndex() noexcept {
-            next_write_index_ = (next_write_index_ + 1) % store_.size(); 
-            num_elements_++; 
+            next_write_index_ = (next_write_index_ + 1) % store_.size();
+            num_elements_++;
         }
 
         auto getNextToRead() const noexcept -> const T* {
-            return (next_read_index_ == next_write_index_) ? nullptr: &store_[next_read_index_]; 
+            return (next_read_index_ == next_write_index_) ? nullptr: &store_[next_read_index_];
         }
 
         auto updateReadIndex() noexcept {
-            next_read_index_ = (next_read_index_ + 1) % store_.size(); 
-            ASSERT(num_elements_ != 0, "Read an invalid element in: " + std::to_string(pthread_self())); 
-            num_elements_--; 
+            next_read_index_ = (next_read_index_ + 1) % store_.size();
+            ASSERT(num_elements_ != 0, "Read an invalid element in: " + std::to_string(pthread_self()));
+            num_elements_--;
         }
 
         auto size() const noexcept {
-            return num_elements_.load(); 
+            return num_elements_.load();
+        }
+
+        auto capacity() const noexcept {
+            return store_.size();
+        }
+    };
+
+    // Single-producer single-consumer ring. Indices increase monotonically and are masked into the store,
+    // so full/empty never need a separate counter. The producer only reads the consumer's index (and vice versa)
+    // when its cached copy says the ring is full (empty), which keeps each index line owned by one core.
+    template <typename T>
+    class LFQueue<T, LFQueueMode::SPSC_RING> final {
+    private:
+        // Read-only after construction, shared by both sides
+        alignas(CACHE_LINE_SIZE) std::vector<T> store_;
+        size_t mask_ = 0;
+
+        // Producer side
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> next_write_index_ = {0};
+        size_t cached_read_index_ = 0;
+
+        // Consumer side
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> next_read_index_ = {0};
+        mutable size_t cached_write_index_ = 0;
+
+        static constexpr auto roundUpToPowerOfTwo(size_t n) noexcept {
+            size_t capacity = 1;
+            while (capacity < n) capacity <<= 1;
+            return capacity;
+        }
+
+    public:
+        LFQueue(std::size_t num_elems) : store_(roundUpToPowerOfTwo(num_elems), T()), /*vector storage pre-allocation*/
+            mask_(store_.size() - 1) {}
+
+        LFQueue() = delete;
+        LFQueue(const LFQueue&) = delete;
+        LFQueue(const LFQueue&&) = delete;
+        LFQueue& operator=(const LFQueue&) = delete;
+        LFQueue& operator=(const LFQueue&&) = delete;
+
+        // Spins while the ring is full, so a slow consumer applies back-pressure instead of being overwritten
+        auto getNextToWriteTo() noexcept {
+            const auto write_index = next_write_index_.load(std::memory_order_relaxed);
+            while (UNLIKELY(write_index - cached_read_index_ == store_.size())) {
+                cached_read_index_ = next_read_index_.load(std::memory_order_acquire);
+            }
+            return &store_[write_index & mask_];
+        }
+
+        auto updateWriteIndex() noexcept {
+            next_write_index_.store(next_write_index_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        auto getNextToRead() const noexcept -> const T* {
+            const auto read_index = next_read_index_.load(std::memory_order_relaxed);
+            if (read_index == cached_write_index_) {
+                cached_write_index_ = next_write_index_.load(std::memory_order_acquire);
+                if (read_index == cached_write_index_)
+                    return nullptr;
+            }
+            return &store_[read_index & mask_];
+        }
+
+        auto updateReadIndex() noexcept {
+            const auto read_index = next_read_index_.load(std::memory_order_relaxed);
+            if (UNLIKELY(read_index == cached_write_index_)) {
+                FATAL("Read an invalid element in: " + std::to_string(pthread_self()));
+            }
+            next_read_index_.store(read_index + 1, std::memory_order_release);
+        }
+
+        // Batch API: claim up to max_elems contiguous free slots. The span stops at the end of the store, so a
+        // burst that wraps around takes two claims. Returns an empty span when the ring is full.
+        auto getWriteSpan(size_t max_elems) noexcept -> std::span<T> {
+            const auto write_index = next_write_index_.load(std::memory_order_relaxed);
+            auto free_elems = store_.size() - (write_index - cached_read_index_);
+            if (free_elems < max_elems) {
+                cached_read_index_ = next_read_index_.load(std::memory_order_acquire);
+                free_elems = store_.size() - (write_index - cached_read_index_);
+            }
+            const auto offset = write_index & mask_;
+            return std::span<T>(&store_[offset], std::min({max_elems, free_elems, store_.size() - offset}));
+        }
+
+        // Publishes num_elems slots claimed through getWriteSpan() with a single release store
+        auto updateWriteIndex(size_t num_elems) noexcept {
+            next_write_index_.store(next_write_index_.load(std::memory_order_relaxed) + num_elems, std::memory_order_release);
+        }
+
+        // Batch API: all (up to max_elems) contiguous ready elements, with one acquire load of the producer's index.
+        // As with getWriteSpan(), elements past the end of the store come back on the next call.
+        auto getReadSpan(size_t max_elems = std::numeric_limits<size_t>::max()) const noexcept -> std::span<const T> {
+            const auto read_index = next_read_index_.load(std::memory_order_relaxed);
+            cached_write_index_ = next_write_index_.load(std::memory_order_acquire);
+            const auto offset = read_index & mask_;
+            return std::span<const T>(&store_[offset], std::min({max_elems, cached_write_index_ - read_index, store_.size() - offset}));
+        }
+
+        // Releases num_elems elements obtained through getReadSpan() with a single release store
+        auto updateReadIndex(size_t num_elems) noexcept {
+            const auto read_index = next_read_index_.load(std::memory_order_relaxed);
+            if (UNLIKELY(num_elems > cached_write_index_ - read_index)) {
+                FATAL("Released more elements than were read in: " + std::to_string(pthread_self()));
+            }
+            next_read_index_.store(read_index + num_elems, std::memory_order_release);
+        }
+
+        // Touches both index lines, keep it off the hot path. The read index is loaded first so that the difference
+        // cannot underflow; the two ends may both move on between the loads, so it is capped at the capacity.
+        auto size() const noexcept {
+            const auto read_index = next_read_index_.load(std::memory_order_acquire);
+            return std::min(next_write_index_.load(std::memory_order_acquire) - read_index, store_.size());
+        }
+
+        auto capacity() const noexcept {
+            return store_.size();
         }
     };
 }
\ No newline at end of file
@@ -1,16 +1,71 @@
 #pragma once 
 
 #include <string> 
-#include <fstream> 
+#include <array> 
+#include <vector> 
+#include <mutex> 
+#include <chrono> 
+#include <ostream> 
+#include <sstream> 
+#include <streambuf> 
 #include <cstdio> 
+#include <cstring> 
+#include <cerrno> 
+#include <string_view> 
+#include <fcntl.h> 
+#include <unistd.h> 
+#include <sys/uio.h> 
 #include "macros.h"
 #include "lock_free_queue.h"
 #include "thread_utils.h"
 #include "time_utils.h"
+#include "latency_histogram.h" // START_MEASURE/END_MEASURE/TTT_MEASURE for every component that logs
+
+// Lowest level compiled in, statements below it generate no code. Release (NDEBUG) builds keep INFO and above.
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL 2
+#else
+#define LOG_MIN_LEVEL 0
+#endif
+#endif
+
+// LogComponent bits compiled in, e.g. -DLOG_COMPONENT_MASK=0x2 keeps only the matching engine's statements.
+#ifndef LOG_COMPONENT_MASK
+#define LOG_COMPONENT_MASK 0xFFFFFFFF
+#endif
 
 namespace Common {
 constexpr size_t LOG_QUEUE_SIZE = 8 * 1024 * 1024; 
 
+enum class LogLevel : uint8_t {
+    TRACE = 0, // per packet / per book level detail
+    DEBUG = 1, // per message on the trading paths
+    INFO = 2, // lifecycle and summaries
+    WARN = 3 // gaps, rejections, protocol errors
+}; 
+
+// Every class that logs declares a private `static constexpr auto LOG_COMPONENT = LogComponent::...;`
+// (file scope in the mains), which the LOG_* macros below pick up by name.
+enum class LogComponent : uint32_t {
+    MAIN = 1 << 0, 
+    MATCHING_ENGINE = 1 << 1, 
+    ORDER_SERVER = 1 << 2, 
+    MARKET_DATA_PUBLISHER = 1 << 3, 
+    SNAPSHOT_SYNTHESIZER = 1 << 4, 
+    ORDER_GATEWAY = 1 << 5, 
+    MARKET_DATA_CONSUMER = 1 << 6, 
+    TRADE_ENGINE = 1 << 7, 
+    ORDER_MANAGER = 1 << 8, 
+    MARKET_ORDER_BOOK = 1 << 9, 
+    STRATEGY = 1 << 10, 
+    LOAD_GENERATOR = 1 << 11 
+}; 
+
+constexpr auto isLogCompiled(LogLevel level, LogComponent component) noexcept {
+    return level >= static_cast<LogLevel>(LOG_MIN_LEVEL) && (static_cast<uint32_t>(component) & LOG_COMPONENT_MASK) != 0; 
+}
+
 enum class LogType : int8_t {
     CHAR = 0, 
     INTEGER = 1, 
@@ -33,39 +88,340 @@ struct LogElement {
     } u_; 
 }; 
 
+// CHARACTER: one LogElement per character/value, formatted by the caller as it is pushed.
+// BINARY: one record per log() call holding the format pointer, a TSC timestamp and the raw argument bytes;
+// all the formatting happens on the logger thread.
+enum class LogMode : int8_t {
+    CHARACTER = 0, 
+    BINARY = 1
+}; 
+
+// Binary records are whole numbers of chunks and never wrap around the end of the ring.
+constexpr size_t LOG_CHUNK_SIZE = 32; 
+struct alignas(LOG_CHUNK_SIZE) LogChunk {
+    char bytes_[LOG_CHUNK_SIZE]; 
+}; 
+
+// First chunk of a binary record, the argument bytes follow it.
+struct LogRecordHeader {
+    const char* format_ = nullptr; // nullptr marks padding up to the end of the ring
+    uint64_t tsc_ = 0; // kept for ordering and conversion to wall time by the reader
+    auto (*decode_)(std::ostream&, const char*, const char*) -> void = nullptr; // formats the record, instantiated per argument types
+    uint32_t num_chunks_ = 0; // including this header
+}; 
+static_assert(sizeof(LogRecordHeader) <= sizeof(LogChunk), "LogRecordHeader must fit in one LogChunk."); 
+
+// Formatted text of one Logger, kept in fixed blocks so that the writer hands a whole drain pass to the kernel
+// with a single writev() instead of streaming and flushing it piecemeal. Only touched by the log-writer thread.
+constexpr size_t LOG_WRITE_BLOCK_SIZE = 64 * 1024; 
+constexpr size_t LOG_WRITE_BLOCKS = 16; 
+
+class LogOutputBuffer final : public std::streambuf {
+public:
+    explicit LogOutputBuffer(int fd) : fd_(fd), storage_(LOG_WRITE_BLOCKS * LOG_WRITE_BLOCK_SIZE) {
+        setBlock(0); 
+    }
+
+    // Writes out everything formatted so far, returns the number of bytes written.
+    auto writeOut() noexcept -> size_t {
+        iovec iov[LOG_WRITE_BLOCKS]; 
+        size_t num_iov = 0, total = 0; 
+        for (size_t i = 0; i < current_block_; ++i) 
+            iov[num_iov++] = {&storage_[i * LOG_WRITE_BLOCK_SIZE], LOG_WRITE_BLOCK_SIZE}; 
+        if (pptr() != pbase()) 
+            iov[num_iov++] = {pbase(), static_cast<size_t>(pptr() - pbase())}; 
+        for (size_t i = 0; i < num_iov; ++i) 
+            total += iov[i].iov_len; 
+
+        // writev() may stop short, resume from wherever it got to
+        for (size_t first = 0, remaining = total; remaining;) {
+            const auto written = writev(fd_, &iov[first], static_cast<int>(num_iov - first)); 
+            if (UNLIKELY(written < 0)) {
+                if (errno == EINTR) continue; 
+                std::cerr << "LogOutputBuffer::writeOut() writev() failed, dropping " << remaining << " bytes error: " << std::strerror(errno) << std::endl; 
+                break; 
+            }
+            remaining -= static_cast<size_t>(written); 
+            for (auto skip = static_cast<size_t>(written); skip;) {
+                const auto step = std::min(skip, iov[first].iov_len); 
+                iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + step; 
+                iov[first].iov_len -= step; 
+                skip -= step; 
+                if (iov[first].iov_len == 0) ++first; 
+            }
+        }
+        setBlock(0); 
+        return total; 
+    }
+
+    LogOutputBuffer() = delete; 
+    LogOutputBuffer(const LogOutputBuffer&) = delete; 
+    LogOutputBuffer(const LogOutputBuffer&&) = delete; 
+    LogOutputBuffer& operator=(const LogOutputBuffer&) = delete; 
+    LogOutputBuffer& operator=(const LogOutputBuffer&&) = delete; 
+
+protected:
+    // Current block is full: move on to the next one, or write out all of them if this was the last.
+    auto overflow(int_type c) -> int_type override {
+        if (current_block_ + 1 == LOG_WRITE_BLOCKS) 
+            writeOut(); 
+        else 
+            setBlock(current_block_ + 1); 
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c); 
+            pbump(1); 
+        }
+        return traits_type::not_eof(c); 
+    }
+
+private:
+    const int fd_; 
+    std::vector<char> storage_; 
+    size_t current_block_ = 0; 
+
+    auto setBlock(size_t block) noexcept -> void {
+        current_block_ = block; 
+        auto begin = &storage_[block * LOG_WRITE_BLOCK_SIZE]; 
+        setp(begin, begin + LOG_WRITE_BLOCK_SIZE); 
+    }
+}; 
+
+// Called from LogFormat's consteval constructor on a bad format string: not being constexpr, any call is a build error
+// whose message names the problem.
+void log_format_has_more_placeholders_than_arguments(); 
+void log_format_has_more_arguments_than_placeholders(); 
+void log_format_has_too_many_literal_percent_signs(); 
+
+// Literal run of a format string, printed as is, then followed by the next argument or by nothing.
+struct LogSegment {
+    uint16_t offset_ = 0; 
+    uint16_t length_ = 0; 
+    bool arg_follows_ = false; 
+}; 
+
+// Format string of a log() call with arguments A..., split into segments at compile time. Every '%' takes the next
+// argument and "%%" is a literal '%' (it ends a segment, so that each segment is a plain copy). A placeholder count
+// that does not match sizeof...(A) fails the build instead of hitting FATAL at runtime.
+template<typename... A>
+class LogFormat final {
+public:
+    static constexpr size_t MAX_SEGMENTS = sizeof...(A) + 1 + 4; // up to four "%%" per format
+
+    template<typename S> requires std::is_convertible_v<const S&, const char*>
+    consteval LogFormat(const S& format) : format_(format) {
+        size_t num_args = 0; 
+        uint16_t begin = 0, i = 0; 
+        for (; format_[i]; ++i) {
+            if (format_[i] != '%') continue; 
+            if (format_[i + 1] == '%') {
+                addSegment(begin, i + 1 - begin, false); // keep the first '%', drop the second
+                begin = ++i + 1; 
+            } else {
+                addSegment(begin, i - begin, true); 
+                begin = i + 1; 
+                ++num_args; 
+            }
+        }
+        addSegment(begin, i - begin, false); 
+        if (num_args > sizeof...(A)) log_format_has_more_placeholders_than_arguments(); 
+        if (num_args < sizeof...(A)) log_format_has_more_arguments_than_placeholders(); 
+    }
+
+    constexpr auto format() const noexcept { return format_; }
+    constexpr auto numSegments() const noexcept { return num_segments_; }
+    constexpr auto segment(size_t i) const noexcept -> const LogSegment& { return segments_[i]; }
+
+private:
+    const char* format_ = nullptr; 
+    std::array<LogSegment, MAX_SEGMENTS> segments_{}; 
+    size_t num_segments_ = 0; 
+
+    consteval auto addSegment(uint16_t offset, uint16_t length, bool arg_follows) -> void {
+        if (num_segments_ == MAX_SEGMENTS) log_format_has_too_many_literal_percent_signs(); 
+        segments_[num_segments_++] = {offset, length, arg_follows}; 
+    }
+}; 
+
+// Deduce A from the arguments only, the format string has to convert to whatever they imply.
+template<typename... A>
+using LogFormatFor = LogFormat<std::type_identity_t<A>...>; 
+
+class LogWriter; 
+
 class Logger final {
+    friend class LogWriter; 
+
 private:
     const std::string file_name_; 
-    std::ofstream file_; 
+    const int fd_; 
+    LogOutputBuffer output_buffer_; 
+    std::ostream output_; 
+    const LogMode mode_; 
     LFQueue<LogElement> queue_; 
-    std::atomic<bool> running_ = {true}; 
-    std::thread *logger_thread_ = nullptr; 
+    LFQueue<LogChunk> binary_queue_; 
+    size_t binary_write_offset_ = 0; // producer position in binary_queue_, to pad records that would wrap
+    std::atomic<LogLevel> level_ = {LogLevel::TRACE}; // runtime threshold on top of LOG_MIN_LEVEL
 
-public: 
-    auto flushQueue () noexcept {
-        while(running_) {
-            for (auto next = queue_.getNextToRead(); queue_.size() && next; 
-                    next = queue_.getNextToRead()) {
-                switch(next->type_) {
-                    case LogType::CHAR: file_ << next->u_.c; break; 
-                    case LogType::INTEGER: file_ << next->u_.i; break; 
-                    case LogType::LONG_INTEGER: file_ << next->u_.l; break; 
-                    case LogType::LONG_LONG_INTEGER: file_ << next->u_.ll; break; 
-                    case LogType::UNSIGNED_INTEGER: file_ << next->u_.u; break; 
-                    case LogType::UNSIGNED_LONG_INTEGER: file_ << next->u_.ul; break; 
-                    case LogType::UNSIGNED_LONG_LONG_INTEGER: file_ << next->u_.ull; break; 
-                    case LogType::FLOAT: file_ << next->u_.f; break; 
-                    case LogType::DOUBLE: file_ << next->u_.d; break; 
+    // Argument types as stored in a binary record: the same conversions the pushValue() overloads accept,
+    // with both string types stored as a length-prefixed copy of the characters.
+    static auto toStored(char value) noexcept { return value; }
+    static auto toStored(int value) noexcept { return value; }
+    static auto toStored(long value) noexcept { return value; }
+    static auto toStored(long long value) noexcept { return value; }
+    static auto toStored(unsigned value) noexcept { return value; }
+    static auto toStored(unsigned long value) noexcept { return value; }
+    static auto toStored(unsigned long long value) noexcept { return value; }
+    static auto toStored(float value) noexcept { return value; }
+    static auto toStored(double value) noexcept { return value; }
+    static auto toStored(const char* value) noexcept { return std::string_view(value); }
+    static auto toStored(const std::string& value) noexcept { return std::string_view(value); }
+    static auto toStored(const TscTimestamp& value) noexcept { return value; }
+    static auto toStored(const TscNanos& value) noexcept { return value; }
+
+    template<typename T>
+    static auto storedSize(const T&) noexcept { return sizeof(T); }
+    static auto storedSize(const std::string_view& value) noexcept { return sizeof(uint32_t) + value.size(); }
+
+    template<typename T>
+    static auto encodeArg(char* dst, const T& value) noexcept {
+        std::memcpy(dst, &value, sizeof(T)); 
+        return dst + sizeof(T); 
+    }
+    static auto encodeArg(char* dst, const std::string_view& value) noexcept {
+        const auto len = static_cast<uint32_t>(value.size()); 
+        std::memcpy(dst, &len, sizeof(len)); 
+        std::memcpy(dst + sizeof(len), value.data(), len); 
+        return dst + sizeof(len) + len; 
+    }
+
+    template<typename T>
+    static auto decodeArg(std::ostream& os, const char* src) noexcept {
+        if constexpr (std::is_same_v<T, std::string_view>) {
+            uint32_t len = 0; 
+            std::memcpy(&len, src, sizeof(len)); 
+            os.write(src + sizeof(len), len); 
+            return src + sizeof(len) + len; 
+        } else {
+            T value; 
+            std::memcpy(&value, src, sizeof(T)); 
+            os << value; 
+            return src + sizeof(T); 
+        }
+    }
+
+    // Same format rules as LogFormat: every '%' takes the next argument, "%%" is a literal '%'.
+    // The placeholder count was checked when the call site was compiled.
+    template<typename... A>
+    static auto decodeRecord(std::ostream& os, const char* s, const char* args) noexcept -> void {
+        while (*s) {
+            if (*s == '%') {
+                if (UNLIKELY(*(s+1) == '%')) {
+                    ++s; 
+                } else if constexpr (sizeof...(A) != 0) {
+                    decodeNext<A...>(os, s + 1, args); 
+                    return; 
                 }
-                queue_.updateReadIndex(); 
             }
-            file_.flush(); 
+            os << *s++; 
+        }
+    }
 
-            using namespace std::literals::chrono_literals;
-            std::this_thread::sleep_for(1ms); 
+    template<typename T, typename... A>
+    static auto decodeNext(std::ostream& os, const char* s, const char* args) noexcept -> void {
+        decodeRecord<A...>(os, s, decodeArg<T>(os, args)); 
+    }
+
+    // Contiguous room for num_chunks, padding out the tail of the ring first if the record would wrap.
+    auto claimChunks(size_t num_chunks) noexcept -> LogChunk* {
+        if (UNLIKELY(num_chunks > binary_queue_.capacity())) {
+            FATAL("log record larger than the log queue: " + std::to_string(num_chunks) + " chunks"); 
         }
+        const auto tail_chunks = binary_queue_.capacity() - binary_write_offset_; 
+        if (UNLIKELY(tail_chunks < num_chunks)) {
+            auto tail = binary_queue_.getWriteSpan(tail_chunks); 
+            while (tail.size() < tail_chunks) tail = binary_queue_.getWriteSpan(tail_chunks); 
+            const LogRecordHeader padding{nullptr, 0, nullptr, static_cast<uint32_t>(tail_chunks)}; 
+            std::memcpy(tail.data(), &padding, sizeof(padding)); 
+            binary_queue_.updateWriteIndex(tail_chunks); 
+            binary_write_offset_ = 0; 
+        }
+        auto chunks = binary_queue_.getWriteSpan(num_chunks); 
+        while (UNLIKELY(chunks.size() < num_chunks)) chunks = binary_queue_.getWriteSpan(num_chunks); 
+        return chunks.data(); 
     }
 
+    template<typename... A>
+    auto logBinary(const char* format, const A&... args) noexcept {
+        const size_t payload_size = (0 + ... + storedSize(args)); 
+        const auto num_chunks = 1 + (payload_size + LOG_CHUNK_SIZE - 1) / LOG_CHUNK_SIZE; 
+        auto chunks = claimChunks(num_chunks); 
+
+        const LogRecordHeader header{format, rdtsc(), &decodeRecord<A...>, static_cast<uint32_t>(num_chunks)}; 
+        std::memcpy(chunks, &header, sizeof(header)); 
+        [[maybe_unused]] auto dst = chunks[0].bytes_ + LOG_CHUNK_SIZE; 
+        ((dst = encodeArg(dst, args)), ...); 
+
+        binary_queue_.updateWriteIndex(num_chunks); 
+        binary_write_offset_ = (binary_write_offset_ + num_chunks) & (binary_queue_.capacity() - 1); 
+    }
+
+    auto flushBinaryQueue() noexcept {
+        size_t drained = 0; 
+        for (auto chunks = binary_queue_.getReadSpan(); !chunks.empty(); chunks = binary_queue_.getReadSpan()) {
+            for (size_t i = 0; i < chunks.size();) {
+                LogRecordHeader header; 
+                std::memcpy(&header, chunks[i].bytes_, sizeof(header)); 
+                if (LIKELY(header.format_ != nullptr)) 
+                    header.decode_(output_, header.format_, chunks[i].bytes_ + LOG_CHUNK_SIZE); 
+                i += header.num_chunks_; 
+            }
+            binary_queue_.updateReadIndex(chunks.size()); 
+            drained += chunks.size(); 
+        }
+        return drained; 
+    }
+
+    auto flushCharacterQueue() noexcept {
+        size_t drained = 0; 
+        // drain in batches: one release of the read index per span instead of one per element
+        for (auto elements = queue_.getReadSpan(); !elements.empty(); elements = queue_.getReadSpan()) {
+            for (const auto& next : elements) {
+                switch(next.type_) {
+                    case LogType::CHAR: output_ << next.u_.c; break;
+                    case LogType::INTEGER: output_ << next.u_.i; break;
+                    case LogType::LONG_INTEGER: output_ << next.u_.l; break;
+                    case LogType::LONG_LONG_INTEGER: output_ << next.u_.ll; break;
+                    case LogType::UNSIGNED_INTEGER: output_ << next.u_.u; break;
+                    case LogType::UNSIGNED_LONG_INTEGER: output_ << next.u_.ul; break;
+                    case LogType::UNSIGNED_LONG_LONG_INTEGER: output_ << next.u_.ull; break;
+                    case LogType::FLOAT: output_ << next.u_.f; break;
+                    case LogType::DOUBLE: output_ << next.u_.d; break;
+                }
+            }
+            queue_.updateReadIndex(elements.size());
+            drained += elements.size(); 
+        }
+        return drained; 
+    }
+
+    // Pushes literal segments up to and including the one an argument follows, or up to the end of the format.
+    template<typename F>
+    auto pushSegmentsToArg(const F& format, size_t& segment) noexcept {
+        while (segment < format.numSegments()) {
+            const auto& next = format.segment(segment++); 
+            for (auto c = format.format() + next.offset_, end = c + next.length_; c != end; ++c) 
+                pushValue(*c); 
+            if (next.arg_follows_) return; 
+        }
+    }
+
+    // Formats whatever is queued into output_buffer_, called from the log-writer thread only.
+    auto flushQueue() noexcept -> size_t {
+        return (mode_ == LogMode::BINARY ? flushBinaryQueue() : flushCharacterQueue()); 
+    }
+
+public: 
+
     auto pushValue(const LogElement& log_element) noexcept {
         *(queue_.getNextToWriteTo()) = log_element; 
         queue_.updateWriteIndex(); 
@@ -118,57 +474,44 @@ public:
         pushValue(LogElement{LogType::DOUBLE, {.d=value}}); 
     }
 
-    template<typename T, typename... A>
-    auto log(const char* s, const T& value, A... args) noexcept {
-        while (*s) {
-            if (*s == '%') {
-                if (UNLIKELY(*(s+1) == '%')) {
-                    ++s;
-                } else {
-                    pushValue(value); 
-                    log(s + 1, args...); 
-                    return; 
-                }
-            }
-            pushValue(*s++); 
-        }
-        FATAL("extra arguments provided to log()"); 
+    auto setLevel(LogLevel level) noexcept {
+        level_.store(level, std::memory_order_relaxed); 
     }
 
-    auto log(const char* s) {
-        while (*s) {
-            if (*s == '%') {
-                if (UNLIKELY(*(s+1) == '%')) {
-                    ++s;
-                } else {
-                    FATAL("missing arguments to log()");
-                }
-            }
-            pushValue(*s++);
-        }
+    auto isEnabled(LogLevel level) const noexcept {
+        return level >= level_.load(std::memory_order_relaxed); 
     }
 
-    explicit Logger(const std::string &file_name):
-        file_name_(file_name), queue_(LOG_QUEUE_SIZE) {
-            file_.open(file_name); 
-            ASSERT(file_.is_open(), "Could not open log file: " + file_name); 
-            logger_thread_ = createAndStartThread(-1, "Common/Logger", [this](){
-                flushQueue();
-            });
-            ASSERT(logger_thread_ != nullptr, "Failed to start Logger Thread."); 
+    // TSC readings are converted here in CHARACTER mode, on the logger thread in BINARY mode
+    auto pushValue(const TscTimestamp& value) noexcept {
+        std::ostringstream time_str; 
+        time_str << value; 
+        pushValue(time_str.str()); 
     }
 
-    ~Logger() {
-        std::cerr << "Finishing and closing Logger for " << file_name_ << std::endl; 
-        while(queue_.size()) {
-            using namespace std::literals::chrono_literals; 
-            std::this_thread::sleep_for(1s); 
+    auto pushValue(const TscNanos& value) noexcept {
+        pushValue(TscClock::instance().toNanos(value.tsc_)); 
+    }
+
+    // Format parsing and argument counting happened at compile time (LogFormat), so this only copies the arguments:
+    // into a binary record, or as pre-split literal segments and values in CHARACTER mode.
+    template<typename... A>
+    auto log(LogFormatFor<A...> format, const A&... args) noexcept {
+        if (LIKELY(mode_ == LogMode::BINARY)) {
+            logBinary(format.format(), toStored(args)...); 
+            return; 
         }
-        running_ = false; 
-        logger_thread_->join(); 
-        file_.close(); 
+        size_t segment = 0; 
+        ((pushSegmentsToArg(format, segment), pushValue(args)), ...); 
+        pushSegmentsToArg(format, segment); 
     }
 
+    // Only the queue of the selected mode is sized, LOG_QUEUE_SIZE elements or bytes.
+    // The queue is drained by the shared LogWriter thread, started with defaults if nobody configured it.
+    explicit Logger(const std::string &file_name, LogMode mode = LogMode::BINARY); 
+
+    ~Logger(); 
+
     Logger() = delete; 
     Logger(const Logger&) = delete; 
     Logger(const Logger&&) = delete; 
@@ -176,4 +519,149 @@ public:
     Logger& operator=(const Logger&&) = delete; 
 
 };
-}
\ No newline at end of file
+
+// One thread drains every Logger in the process and writes each one's text to its own file, instead of a
+// sleeping thread per Logger. While there is output it keeps polling; once idle it spins for a while and then
+// backs off to sleeps of growing length, so a quiet process costs little and a busy one is drained promptly.
+constexpr size_t LOG_MAX_LOGGERS = 64; 
+
+struct LogWriterConfig {
+    int core_id_ = -1; // -1: unpinned; otherwise a housekeeping core, away from the pinned trading threads
+    size_t spin_passes_ = 1000; // idle passes spent spinning before the first sleep
+    std::chrono::microseconds min_sleep_ = std::chrono::microseconds(50); 
+    std::chrono::microseconds max_sleep_ = std::chrono::microseconds(1000); 
+}; 
+
+class LogWriter final {
+public:
+    static auto instance() noexcept -> LogWriter& {
+        static LogWriter writer; 
+        return writer; 
+    }
+
+    // Only the first call configures and starts the thread, later calls are no-ops.
+    auto start(const LogWriterConfig& config = {}) noexcept {
+        std::lock_guard<std::mutex> lock(start_mutex_); 
+        if (writer_thread_) return; 
+        config_ = config; 
+        running_ = true; 
+        writer_thread_ = createAndStartThread(config_.core_id_, "Common/LogWriter", [this]() {
+            run(); 
+        });
+        ASSERT(writer_thread_ != nullptr, "Failed to start LogWriter thread."); 
+    }
+
+    auto add(Logger* logger) noexcept {
+        for (auto& slot : loggers_) {
+            Logger* expected = nullptr; 
+            if (slot.compare_exchange_strong(expected, logger, std::memory_order_acq_rel)) 
+                return; 
+        }
+        FATAL("LogWriter supports at most " + std::to_string(LOG_MAX_LOGGERS) + " loggers."); 
+    }
+
+    // Once this returns the writer thread no longer touches logger.
+    auto remove(Logger* logger) noexcept {
+        for (auto& slot : loggers_) {
+            Logger* expected = logger; 
+            if (slot.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel)) 
+                break; 
+        }
+        // a pass that loaded logger before it was removed is over once two passes have completed
+        const auto pass = passes_.load(std::memory_order_acquire); 
+        while (running_ && passes_.load(std::memory_order_acquire) < pass + 2) {
+            using namespace std::literals::chrono_literals; 
+            std::this_thread::sleep_for(50us); 
+        }
+    }
+
+    ~LogWriter() {
+        running_ = false; 
+        if (writer_thread_) {
+            writer_thread_->join(); 
+            delete writer_thread_; 
+            writer_thread_ = nullptr; 
+        }
+    }
+
+    LogWriter(const LogWriter&) = delete; 
+    LogWriter(const LogWriter&&) = delete; 
+    LogWriter& operator=(const LogWriter&) = delete; 
+    LogWriter& operator=(const LogWriter&&) = delete; 
+
+private:
+    std::array<std::atomic<Logger *>, LOG_MAX_LOGGERS> loggers_{}; 
+    std::atomic<uint64_t> passes_ = {0}; 
+    std::atomic<bool> running_ = {false}; 
+    std::thread* writer_thread_ = nullptr; 
+    std::mutex start_mutex_; 
+    LogWriterConfig config_; 
+
+    LogWriter() = default; 
+
+    auto drainAll() noexcept {
+        size_t drained = 0; 
+        for (auto& slot : loggers_) {
+            auto logger = slot.load(std::memory_order_acquire); 
+            if (logger && logger->flushQueue()) {
+                logger->output_buffer_.writeOut(); 
+                ++drained; 
+            }
+        }
+        return drained; 
+    }
+
+    auto run() noexcept -> void {
+        size_t idle_passes = 0; 
+        auto sleep = config_.min_sleep_; 
+        while (running_) {
+            const auto drained = drainAll(); 
+            passes_.fetch_add(1, std::memory_order_release); 
+            if (drained) {
+                idle_passes = 0; 
+                sleep = config_.min_sleep_; 
+            } else if (++idle_passes <= config_.spin_passes_) {
+                __builtin_ia32_pause(); 
+            } else {
+                std::this_thread::sleep_for(sleep); 
+                sleep = std::min(sleep * 2, config_.max_sleep_); 
+            }
+        }
+        drainAll(); 
+        passes_.fetch_add(1, std::memory_order_release); 
+    }
+}; 
+
+inline Logger::Logger(const std::string &file_name, LogMode mode):
+    file_name_(file_name), fd_(open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)), 
+    output_buffer_(fd_), output_(&output_buffer_), mode_(mode), queue_(mode == LogMode::CHARACTER ? LOG_QUEUE_SIZE : 1), 
+    binary_queue_(mode == LogMode::BINARY ? LOG_QUEUE_SIZE / LOG_CHUNK_SIZE : 1) {
+        ASSERT(fd_ >= 0, "Could not open log file: " + file_name + " error: " + std::string(std::strerror(errno))); 
+        LogWriter::instance().start(); 
+        LogWriter::instance().add(this); 
+}
+
+// Producers are done by now; detach from the writer and flush the remainder on this thread.
+inline Logger::~Logger() {
+    std::cerr << "Finishing and closing Logger for " << file_name_ << std::endl; 
+    LogWriter::instance().remove(this); 
+    flushQueue(); 
+    output_buffer_.writeOut(); 
+    close(fd_); 
+}
+}
+
+// Levelled logging. Statements compiled out by LOG_MIN_LEVEL / LOG_COMPONENT_MASK generate no code and their
+// arguments (toString() calls included) are never evaluated; the rest are checked against Logger::setLevel().
+#define LOG_AT(LEVEL, LOGGER, ...)                                                            \
+    do {                                                                                    \
+        if constexpr (Common::isLogCompiled(LEVEL, LOG_COMPONENT)) {                          \
+            if ((LOGGER).isEnabled(LEVEL))                                                    \
+                (LOGGER).log(__VA_ARGS__);                                                    \
+        }                                                                                   \
+    } while(false)
+
+#define LOG_TRACE(LOGGER, ...) LOG_AT(Common::LogLevel::TRACE, LOGGER, __VA_ARGS__)
+#define LOG_DEBUG(LOGGER, ...) LOG_AT(Common::LogLevel::DEBUG, LOGGER, __VA_ARGS__)
+#define LOG_INFO(LOGGER, ...) LOG_AT(Common::LogLevel::INFO, LOGGER, __VA_ARGS__)
+#define LOG_WARN(LOGGER, ...) LOG_AT(Common::LogLevel::WARN, LOGGER, __VA_ARGS__)
@@ -2,36 +2,51 @@
 #include <cstdint> 
 #include <string> 
 #include <vector> 
+#include <algorithm> 
 #include "macros.h"
+#include "memory_backing.h"
 
 namespace Common
 {
+    // LINEAR_SCAN: the original pool, an is_free_ flag per block and a forward scan for the next free block.
+    // FREE_LIST: intrusive LIFO free list threaded through the unused blocks, O(1) allocate/deallocate, no per-block flag,
+    // and the most recently freed (cache-hot) block is handed out first.
+    enum class MemPoolMode : uint8_t {
+        LINEAR_SCAN = 0, 
+        FREE_LIST = 1
+    }; 
+
+    template<typename T, MemPoolMode Mode = MemPoolMode::FREE_LIST> 
+    class MemPool; 
+
     template<typename T> 
-    class MemPool final {
+    class MemPool<T, MemPoolMode::LINEAR_SCAN> final {
         private: 
             struct ObjectBlock {
                 T object_; 
                 bool is_free_ = true; 
             }; 
-            std::vector<ObjectBlock> store_; 
+            std::vector<ObjectBlock, BackingAllocator<ObjectBlock>> store_; 
             size_t next_free_index_ = 0; 
+            size_t in_use_ = 0; 
+            size_t peak_in_use_ = 0; 
 
             auto updateNextFreeIndex() noexcept {
                 const auto initial_free_index = next_free_index_; 
                 while (!store_[next_free_index_].is_free_) {
                     ++next_free_index_; 
-                }
-                if (UNLIKELY(next_free_index_ == store_.size())) {
-                    next_free_index_ = 0; 
-                }
-                if (UNLIKELY(initial_free_index == next_free_index_)) {
-                    ASSERT(initial_free_index != next_free_index_, "Memory Pool out of space."); 
+                    if (UNLIKELY(next_free_index_ == store_.size())) {
+                        next_free_index_ = 0; 
+                    }
+                    if (UNLIKELY(initial_free_index == next_free_index_)) {
+                        ASSERT(initial_free_index != next_free_index_, "Memory Pool out of space."); 
+                    }
                 }
             }            
 
         public: 
-            explicit MemPool(std::size_t num_elems) : 
-                store_(num_elems, {T(), true}) /* mem pre-allocation */ {
+            explicit MemPool(std::size_t num_elems, const MemoryConfig& memory_config = {}) : 
+                store_(num_elems, {T(), true}, BackingAllocator<ObjectBlock>(memory_config)) /* mem pre-allocation */ {
                     ASSERT(reinterpret_cast<const ObjectBlock *> (&(store_[0].object_)) == &(store_[0]), 
                     "T object should be first member of ObjectBlock."); 
                 }
@@ -44,6 +59,7 @@ namespace Common
                 ret = new(ret) T(args ...); // placement new 
                 obj_block->is_free_ = false; 
                 updateNextFreeIndex(); 
+                peak_in_use_ = std::max(peak_in_use_, ++in_use_); 
                 return ret; 
             }
 
@@ -53,7 +69,83 @@ namespace Common
                 "Element being deallocated does not belong to this Memory pool."); 
                 ASSERT(!store_[elem_index].is_free_, "Expected in-use ObjectBlock at index: " + std::to_string(elem_index)); 
                 store_[elem_index].is_free_ = true; 
+                --in_use_; 
+            }
+
+            auto inUse() const noexcept { return in_use_; }
+            auto peakInUse() const noexcept { return peak_in_use_; }
+            auto capacity() const noexcept { return store_.size(); }
+ 
+            MemPool() = delete; // default constructor
+            MemPool(const MemPool&) = delete; // copy constructor
+            MemPool(const MemPool&&) = delete; // move constructor
+            MemPool& operator=(const MemPool&) = delete; // copy assignment 
+            MemPool& operator=(const MemPool&&) = delete; // move assignment 
+
+    };  
+
+    template<typename T> 
+    class MemPool<T, MemPoolMode::FREE_LIST> final {
+        private: 
+            // A block holds either a live T or, while free, the link to the next free block, so it is exactly sizeof(T)
+            // (or a pointer, whichever is larger) with no flag padding it out. The free flags live in a side bitmap.
+            union ObjectBlock {
+                T object_; 
+                ObjectBlock* next_free_; 
+
+                ObjectBlock() : next_free_(nullptr) {}
+                ~ObjectBlock() {}
+            }; 
+            std::vector<ObjectBlock, BackingAllocator<ObjectBlock>> store_; 
+            std::vector<bool> is_free_; // per block, only to catch a double or foreign deallocate
+            ObjectBlock* free_head_ = nullptr; 
+            size_t in_use_ = 0; 
+            size_t peak_in_use_ = 0; 
+
+        public: 
+            explicit MemPool(std::size_t num_elems, const MemoryConfig& memory_config = {}) : 
+                store_(num_elems, BackingAllocator<ObjectBlock>(memory_config)) /* mem pre-allocation */, is_free_(num_elems, true) {
+                    ASSERT(reinterpret_cast<const ObjectBlock *> (&(store_[0].object_)) == &(store_[0]), 
+                    "T object should be first member of ObjectBlock."); 
+                    // thread in index order so a fresh pool hands out contiguous blocks
+                    for (size_t i = store_.size(); i > 0; --i) {
+                        store_[i - 1].next_free_ = free_head_; 
+                        free_head_ = &store_[i - 1]; 
+                    }
+                }
+
+            template<typename... Args> 
+            T* allocate(Args... args) noexcept {
+                auto obj_block = free_head_; 
+                if (UNLIKELY(!obj_block)) {
+                    FATAL("Memory Pool out of space."); 
+                }
+                free_head_ = obj_block->next_free_; 
+                is_free_[obj_block - &store_[0]] = false; 
+                T* ret = new(&(obj_block->object_)) T(args ...); // placement new 
+                peak_in_use_ = std::max(peak_in_use_, ++in_use_); 
+                return ret; 
             }
+
+            auto deallocate(const T* elem) noexcept {
+                const auto elem_offset = reinterpret_cast<uintptr_t>(elem) - reinterpret_cast<uintptr_t>(&store_[0]); // wraps if below the pool
+                if (UNLIKELY(elem_offset >= store_.size() * sizeof(ObjectBlock) || elem_offset % sizeof(ObjectBlock) != 0)) {
+                    FATAL("Element being deallocated does not belong to this Memory pool."); 
+                }
+                const auto elem_index = elem_offset / sizeof(ObjectBlock); 
+                if (UNLIKELY(is_free_[elem_index])) {
+                    FATAL("Expected in-use ObjectBlock at index: " + std::to_string(elem_index)); 
+                }
+                is_free_[elem_index] = true; 
+                auto obj_block = &store_[elem_index]; 
+                obj_block->next_free_ = free_head_; 
+                free_head_ = obj_block; 
+                --in_use_; 
+            }
+
+            auto inUse() const noexcept { return in_use_; }
+            auto peakInUse() const noexcept { return peak_in_use_; }
+            auto capacity() const noexcept { return store_.size(); }
  
             MemPool() = delete; // default constructor
             MemPool(const MemPool&) = delete; // copy constructor
@@ -0,0 +1,246 @@
+#pragma once
+#include <iostream>
+#include <atomic>
+#include <string>
+#include <span>
+#include <limits>
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "macros.h"
+
+namespace Common {
+    constexpr uint64_t SHM_QUEUE_MAGIC = 0x4846545348514555; // "HFTSHQEU"
+    constexpr uint32_t SHM_QUEUE_VERSION = 1;
+
+    enum class ShmQueueRole : uint8_t {
+        PRODUCER = 0,
+        CONSUMER = 1
+    };
+
+    // Lives at the start of the /dev/shm mapping, followed by the element slots.
+    // Indices and pids sit on the cache line of the side that writes them, same as LFQueue's SPSC ring.
+    struct ShmQueueHeader {
+        uint64_t magic_ = 0;
+        uint32_t version_ = 0;
+        uint32_t elem_size_ = 0;
+        uint64_t capacity_ = 0;
+        std::atomic<uint32_t> ready_ = {0}; // set last by the creator, attachers wait for it
+
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> next_write_index_ = {0};
+        std::atomic<pid_t> producer_pid_ = {0};
+
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> next_read_index_ = {0};
+        std::atomic<pid_t> consumer_pid_ = {0};
+    };
+    static_assert(std::atomic<size_t>::is_always_lock_free && std::atomic<pid_t>::is_always_lock_free,
+                  "ShmQueueHeader atomics must be lock free to be shared between processes.");
+
+    // SPSC ring with the same API as LFQueue<T, LFQueueMode::SPSC_RING>, backed by a named shared memory
+    // segment so that producer and consumer can be different processes. Whichever side starts first creates
+    // and initializes the segment, the other one attaches and validates the header. The segment outlives both
+    // processes, so a restarted component re-attaches and carries on from the indices left in the header.
+    template <typename T>
+    class ShmLFQueue final {
+        static_assert(std::is_trivially_copyable_v<T>, "ShmLFQueue elements are shared between processes and must be trivially copyable.");
+
+    private:
+        const std::string name_;
+        const ShmQueueRole role_;
+        size_t mapping_size_ = 0;
+        ShmQueueHeader* header_ = nullptr;
+        T* store_ = nullptr;
+        size_t capacity_ = 0;
+        size_t mask_ = 0;
+
+        size_t cached_read_index_ = 0; // producer only
+        mutable size_t cached_write_index_ = 0; // consumer only
+
+        static constexpr auto roundUpToPowerOfTwo(size_t n) noexcept {
+            size_t capacity = 1;
+            while (capacity < n) capacity <<= 1;
+            return capacity;
+        }
+
+        static constexpr auto storeOffset() noexcept {
+            return (sizeof(ShmQueueHeader) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+        }
+
+        static auto isAlive(pid_t pid) noexcept {
+            return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+        }
+
+        auto rolePid() noexcept -> std::atomic<pid_t>& {
+            return (role_ == ShmQueueRole::PRODUCER ? header_->producer_pid_ : header_->consumer_pid_);
+        }
+
+        auto peerPid() const noexcept {
+            return (role_ == ShmQueueRole::PRODUCER ? header_->consumer_pid_ : header_->producer_pid_).load(std::memory_order_acquire);
+        }
+
+        auto map(int fd) noexcept {
+            auto addr = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+            ASSERT(addr != MAP_FAILED, "mmap() failed for shm queue: " + name_ + " error: " + std::string(std::strerror(errno)));
+            header_ = reinterpret_cast<ShmQueueHeader *>(addr);
+            store_ = reinterpret_cast<T *>(reinterpret_cast<char *>(addr) + storeOffset());
+        }
+
+        auto create(int fd) noexcept {
+            ASSERT(ftruncate(fd, mapping_size_) == 0, "ftruncate() failed for shm queue: " + name_ + " error: " + std::string(std::strerror(errno)));
+            map(fd);
+            new(header_) ShmQueueHeader();
+            header_->magic_ = SHM_QUEUE_MAGIC;
+            header_->version_ = SHM_QUEUE_VERSION;
+            header_->elem_size_ = sizeof(T);
+            header_->capacity_ = capacity_;
+            header_->ready_.store(1, std::memory_order_release);
+        }
+
+        auto attach(int fd) noexcept {
+            // the creator may still be between shm_open() and ftruncate()
+            struct stat st{};
+            for (size_t i = 0; i < 1000 && fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) < mapping_size_; ++i) {
+                using namespace std::literals::chrono_literals;
+                std::this_thread::sleep_for(1ms);
+            }
+            ASSERT(static_cast<size_t>(st.st_size) == mapping_size_, "shm queue: " + name_ + " has size " + std::to_string(st.st_size) +
+                   " expected " + std::to_string(mapping_size_));
+            map(fd);
+            for (size_t i = 0; i < 1000 && !header_->ready_.load(std::memory_order_acquire); ++i) {
+                using namespace std::literals::chrono_literals;
+                std::this_thread::sleep_for(1ms);
+            }
+            ASSERT(header_->ready_.load(std::memory_order_acquire), "shm queue: " + name_ + " was never initialized by its creator.");
+            ASSERT(header_->magic_ == SHM_QUEUE_MAGIC, "shm queue: " + name_ + " is not an ShmLFQueue segment.");
+            ASSERT(header_->version_ == SHM_QUEUE_VERSION, "shm queue: " + name_ + " has version " + std::to_string(header_->version_) +
+                   " expected " + std::to_string(SHM_QUEUE_VERSION));
+            ASSERT(header_->elem_size_ == sizeof(T) && header_->capacity_ == capacity_, "shm queue: " + name_ +
+                   " was created with a different element type or capacity.");
+        }
+
+    public:
+        ShmLFQueue(const std::string& name, std::size_t num_elems, ShmQueueRole role) :
+            name_(name), role_(role), capacity_(roundUpToPowerOfTwo(num_elems)), mask_(capacity_ - 1) {
+            mapping_size_ = storeOffset() + capacity_ * sizeof(T);
+
+            auto fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+            const auto is_creator = (fd >= 0);
+            if (!is_creator) {
+                ASSERT(errno == EEXIST, "shm_open() failed for shm queue: " + name_ + " error: " + std::string(std::strerror(errno)));
+                fd = shm_open(name_.c_str(), O_RDWR, 0660);
+                ASSERT(fd >= 0, "shm_open() failed for shm queue: " + name_ + " error: " + std::string(std::strerror(errno)));
+            }
+            if (is_creator) create(fd); else attach(fd);
+            close(fd);
+
+            // claim our side, refusing to share it with a live process; the CAS makes two processes racing over the
+            // same dead (or empty) slot agree on a single winner, the loser sees the winner's pid on retry
+            auto previous_pid = rolePid().load(std::memory_order_acquire);
+            do {
+                ASSERT(!isAlive(previous_pid) || previous_pid == getpid(), "shm queue: " + name_ + " already has a live " +
+                       (role_ == ShmQueueRole::PRODUCER ? "producer" : "consumer") + " pid: " + std::to_string(previous_pid));
+            } while (!rolePid().compare_exchange_strong(previous_pid, getpid(), std::memory_order_acq_rel, std::memory_order_acquire));
+
+            cached_read_index_ = header_->next_read_index_.load(std::memory_order_acquire);
+            cached_write_index_ = header_->next_write_index_.load(std::memory_order_acquire);
+        }
+
+        ~ShmLFQueue() {
+            // only release the slot if it is still ours
+            auto own_pid = getpid();
+            rolePid().compare_exchange_strong(own_pid, 0, std::memory_order_acq_rel);
+            munmap(header_, mapping_size_);
+            header_ = nullptr;
+            store_ = nullptr;
+        }
+
+        // The segment is persistent by design, remove it explicitly once no process needs it any more.
+        static auto remove(const std::string& name) noexcept {
+            return (shm_unlink(name.c_str()) == 0);
+        }
+
+        ShmLFQueue() = delete;
+        ShmLFQueue(const ShmLFQueue&) = delete;
+        ShmLFQueue(const ShmLFQueue&&) = delete;
+        ShmLFQueue& operator=(const ShmLFQueue&) = delete;
+        ShmLFQueue& operator=(const ShmLFQueue&&) = delete;
+
+        // False if the other side never attached, detached cleanly, or its process is gone.
+        auto isPeerAlive() const noexcept {
+            return isAlive(peerPid());
+        }
+
+        // Spins while the ring is full; a producer that can outlive its consumer should check isPeerAlive() when this stalls.
+        auto getNextToWriteTo() noexcept {
+            const auto write_index = header_->next_write_index_.load(std::memory_order_relaxed);
+            while (UNLIKELY(write_index - cached_read_index_ == capacity_)) {
+                cached_read_index_ = header_->next_read_index_.load(std::memory_order_acquire);
+            }
+            return &store_[write_index & mask_];
+        }
+
+        auto updateWriteIndex() noexcept {
+            updateWriteIndex(1);
+        }
+
+        auto getWriteSpan(size_t max_elems) noexcept -> std::span<T> {
+            const auto write_index = header_->next_write_index_.load(std::memory_order_relaxed);
+            auto free_elems = capacity_ - (write_index - cached_read_index_);
+            if (free_elems < max_elems) {
+                cached_read_index_ = header_->next_read_index_.load(std::memory_order_acquire);
+                free_elems = capacity_ - (write_index - cached_read_index_);
+            }
+            const auto offset = write_index & mask_;
+            return std::span<T>(&store_[offset], std::min({max_elems, free_elems, capacity_ - offset}));
+        }
+
+        auto updateWriteIndex(size_t num_elems) noexcept {
+            header_->next_write_index_.store(header_->next_write_index_.load(std::memory_order_relaxed) + num_elems, std::memory_order_release);
+        }
+
+        auto getNextToRead() const noexcept -> const T* {
+            const auto read_index = header_->next_read_index_.load(std::memory_order_relaxed);
+            if (read_index == cached_write_index_) {
+                cached_write_index_ = header_->next_write_index_.load(std::memory_order_acquire);
+                if (read_index == cached_write_index_)
+                    return nullptr;
+            }
+            return &store_[read_index & mask_];
+        }
+
+        auto updateReadIndex() noexcept {
+            updateReadIndex(1);
+        }
+
+        auto getReadSpan(size_t max_elems = std::numeric_limits<size_t>::max()) const noexcept -> std::span<const T> {
+            const auto read_index = header_->next_read_index_.load(std::memory_order_relaxed);
+            cached_write_index_ = header_->next_write_index_.load(std::memory_order_acquire);
+            const auto offset = read_index & mask_;
+            return std::span<const T>(&store_[offset], std::min({max_elems, cached_write_index_ - read_index, capacity_ - offset}));
+        }
+
+        auto updateReadIndex(size_t num_elems) noexcept {
+            const auto read_index = header_->next_read_index_.load(std::memory_order_relaxed);
+            if (UNLIKELY(num_elems > cached_write_index_ - read_index)) {
+                FATAL("Released more elements than were read from shm queue: " + name_);
+            }
+            header_->next_read_index_.store(read_index + num_elems, std::memory_order_release);
+        }
+
+        auto size() const noexcept {
+            const auto read_index = header_->next_read_index_.load(std::memory_order_acquire);
+            return header_->next_write_index_.load(std::memory_order_acquire) - read_index;
+        }
+
+        auto capacity() const noexcept {
+            return capacity_;
+        }
+    };
+}
@@ -51,10 +51,13 @@ namespace Common {
     // - detections of sockets disconnected from the client's side 
     // - detection of sockets with data ready to be ready or with outgoing data 
     auto TCPServer::poll() noexcept -> void {
-        const int max_events = 1 + sockets_.size(); 
         for (auto socket: disconnected_sockets_) {
             del(socket); 
+            disconnect_callback_(socket); 
+            delete socket; 
         }
+        disconnected_sockets_.clear(); 
+        const int max_events = 1 + sockets_.size(); 
         const int n = epoll_wait(efd_, events_, max_events, 0); // 0 = timeout in ms; here epoll_wait will not block 
         bool have_new_connection = false; 
 
@@ -68,14 +71,14 @@ namespace Common {
                 // Listener socket 
                 if (socket == &listener_socket_) {
                     logger_.log("%:% %() % EPOLLIN listener_socket:%\n", __FILE__, __LINE__, __FUNCTION__, 
-                        Common::getCurrentTimeStr(&time_str_), socket->fd_);
+                        Common::getTscTimestamp(), socket->fd_);
                     have_new_connection = true; 
                     continue; 
                 }
 
                 // Receiver socket 
                 logger_.log("%:% %() % EPOLLIN socket:%\n", __FILE__,__LINE__,__FUNCTION__, 
-                    Common::getCurrentTimeStr(&time_str_), socket->fd_); 
+                    Common::getTscTimestamp(), socket->fd_); 
                 if (std::find(receive_sockets_.begin(), receive_sockets_.end(), socket) == receive_sockets_.end())
                     receive_sockets_.push_back(socket);  
             }
@@ -83,7 +86,7 @@ namespace Common {
             // Check for sender sockets 
             if (event.events & EPOLLOUT) {
                 logger_.log("%:% %() % EPOLLOUT socket:%\n", __FILE__,__LINE__,__FUNCTION__, 
-                    Common::getCurrentTimeStr(&time_str_), socket->fd_); 
+                    Common::getTscTimestamp(), socket->fd_); 
                 if (std::find(send_sockets_.begin(), send_sockets_.end(), socket) == send_sockets_.end())
                     send_sockets_.push_back(socket);              
             }
@@ -91,7 +94,7 @@ namespace Common {
             // Check if there's an error or if the socket is closed 
             if (event.events & (EPOLLERR | EPOLLHUP)) {
                 logger_.log("%:% %() % EPOLLERR socket:%\n", __FILE__,__LINE__,__FUNCTION__, 
-                    Common::getCurrentTimeStr(&time_str_), socket->fd_); 
+                    Common::getTscTimestamp(), socket->fd_); 
                 if (std::find(disconnected_sockets_.begin(), disconnected_sockets_.end(), socket) == disconnected_sockets_.end())
                     disconnected_sockets_.push_back(socket);              
             }
@@ -102,17 +105,17 @@ namespace Common {
         // and Nagle's algorithm disabled 
         while (have_new_connection) {
             logger_.log("%:% %() % have_new_connection\n", 
-                __FILE__,__LINE__,__FUNCTION__,Common::getCurrentTimeStr(&time_str_)); 
+                __FILE__,__LINE__,__FUNCTION__,Common::getTscTimestamp()); 
             sockaddr_storage addr; 
             socklen_t addr_len = sizeof(addr); 
             int fd = accept(listener_socket_.fd_, reinterpret_cast<sockaddr*>(&addr), &addr_len); 
             if (fd == -1) break; 
             ASSERT(setNonBlocking(fd) && setNoDelay(fd), "Failed to set non-blocking or no-delay on socket: " + 
                 std::to_string(fd)); 
-            logger_.log("%:% %() % accepted socket:%\n", __FILE__,__LINE__,__FUNCTION__,Common::getCurrentTimeStr(&time_str_), fd);
+            logger_.log("%:% %() % accepted socket:%\n", __FILE__,__LINE__,__FUNCTION__,Common::getTscTimestamp(), fd);
 
             // Create the new TCP socket  
-            TCPSocket* socket = new TCPSocket(logger_); 
+            TCPSocket* socket = new TCPSocket(logger_, socket_memory_config_); 
             socket->fd_ = fd; 
             socket->recv_callback_ = recv_callback_; 
             ASSERT(epoll_add(socket), "Unable to add socket. error: " + std::string(std::strerror(errno))); 
@@ -130,6 +133,13 @@ namespace Common {
         }
         if (recv) recv_finished_callback_(); 
         for (auto socket: send_sockets_) socket->sendAndRecv(); 
+
+        // closed or failed connections, dropped on the next poll()
+        for (auto socket: sockets_) {
+            if (UNLIKELY(socket->recv_disconnected_ || socket->send_disconnected_) &&
+                std::find(disconnected_sockets_.begin(), disconnected_sockets_.end(), socket) == disconnected_sockets_.end())
+                disconnected_sockets_.push_back(socket); 
+        }
     }
 
 }
@@ -11,27 +11,38 @@ namespace Common {
         std::vector<TCPSocket*> sockets_, receive_sockets_, send_sockets_, disconnected_sockets_; 
         std::function<void(TCPSocket* s, Nanos rx_time)> recv_callback_; 
         std::function<void()> recv_finished_callback_; // to be called when all sockets have been notified
+        std::function<void(TCPSocket* s)> disconnect_callback_; // called once per lost connection, the socket is deleted right after
         std::string time_str_; 
+        const MemoryConfig socket_memory_config_; // backing of the buffers of accepted sockets
         Logger& logger_; 
 
         auto defaultRecvCallback(TCPSocket* socket, Nanos rx_time) noexcept {
-            logger_.log("%:% %() TCPServer::defaultRecvCallback() socket:% len:% rx:%\n", 
-            __FILE__,__LINE__,__FUNCTION__,Common::getCurrentTimeStr(&time_str_), 
+            logger_.log("%:% %() % TCPServer::defaultRecvCallback() socket:% len:% rx:%\n", 
+            __FILE__,__LINE__,__FUNCTION__,Common::getTscTimestamp(), 
             socket->fd_, socket->next_rcv_valid_index_, rx_time); 
         };
 
         auto defalutRecvFinishedCallback() noexcept {
-            logger_.log("%:% %() TCPServer::defalutRecvFinishedCallback()\n", 
-            __FILE__,__LINE__,__FUNCTION__,Common::getCurrentTimeStr(&time_str_)); 
+            logger_.log("%:% %() % TCPServer::defalutRecvFinishedCallback()\n", 
+            __FILE__,__LINE__,__FUNCTION__,Common::getTscTimestamp()); 
         };
 
-        explicit TCPServer(Logger& logger) : listener_socket_(logger), logger_(logger) {
+        auto defaultDisconnectCallback(TCPSocket* socket) noexcept {
+            logger_.log("%:% %() % TCPServer::defaultDisconnectCallback() socket:%\n", 
+            __FILE__,__LINE__,__FUNCTION__,Common::getTscTimestamp(), socket->fd_); 
+        };
+
+        explicit TCPServer(Logger& logger, const MemoryConfig& socket_memory_config = {}) : 
+            listener_socket_(logger), socket_memory_config_(socket_memory_config), logger_(logger) {
             recv_callback_ = [this](auto socket, auto rx_time) {
                 defaultRecvCallback(socket, rx_time); 
             };
             recv_finished_callback_ = [this]() {
                 defalutRecvFinishedCallback(); 
             };
+            disconnect_callback_ = [this](auto socket) {
+                defaultDisconnectCallback(socket); 
+            };
         }
 
         TCPServer() = delete; 
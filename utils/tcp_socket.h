@@ -2,6 +2,7 @@
 #include <functional>
 #include "socket_utils.h"
 #include "logging.h"
+#include "memory_backing.h"
 
 namespace Common {
     constexpr size_t TCPBufferSize = 64 * 1024 * 1024; 
@@ -10,14 +11,14 @@ namespace Common {
 
         auto defaultRecvCallback(TCPSocket* socket, Nanos rx_time) noexcept {
             logger_.log("%:% %() % TCPSocket::defaultRecvCallback() socket: % len:% rx:%\n", 
-                __FILE__,__LINE__,__FUNCTION__,Common::getCurrentTimeStr(&time_str_), 
+                __FILE__,__LINE__,__FUNCTION__,Common::getTscTimestamp(), 
                 socket->fd_, socket->next_rcv_valid_index_, rx_time); 
         }
 
-        explicit TCPSocket(Logger& logger)
-            : logger_(logger) {
-            send_buffer_ = new char[TCPBufferSize]; 
-            rcv_buffer_ = new char[TCPBufferSize]; 
+        explicit TCPSocket(Logger& logger, const MemoryConfig& memory_config = {})
+            : memory_config_(memory_config), logger_(logger) {
+            send_buffer_ = static_cast<char *>(allocateBacking(TCPBufferSize, memory_config_)); 
+            rcv_buffer_ = static_cast<char *>(allocateBacking(TCPBufferSize, memory_config_)); 
             recv_callback_ = [this] (auto socket, auto rx_time) {
                 defaultRecvCallback(socket, rx_time);
             };
@@ -25,8 +26,8 @@ namespace Common {
 
         ~TCPSocket() {
             destroy(); 
-            delete[] send_buffer_; send_buffer_ = nullptr; 
-            delete[] rcv_buffer_; rcv_buffer_ = nullptr; 
+            freeBacking(send_buffer_, TCPBufferSize, memory_config_); send_buffer_ = nullptr; 
+            freeBacking(rcv_buffer_, TCPBufferSize, memory_config_); rcv_buffer_ = nullptr; 
         }
 
         TCPSocket() = delete; 
@@ -40,6 +41,7 @@ namespace Common {
         auto send(const void* data, size_t len) -> void; 
         auto sendAndRecv() noexcept -> bool; 
 
+        const MemoryConfig memory_config_; // backing of the send/receive buffers
         int fd_ = -1; 
         char* send_buffer_ = nullptr; 
         size_t next_send_valid_index_ = 0; 
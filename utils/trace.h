@@ -0,0 +1,298 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <string>
+#include <limits>
+#include <cmath>
+#include <vector>
+#include <fstream>
+#include <ostream>
+#include <algorithm>
+#include <unordered_map>
+
+#include "macros.h"
+#include "thread_utils.h"
+#include "time_utils.h"
+#include "mpsc_queue.h"
+#include "latency_histogram.h"
+
+namespace Common {
+    // Correlates every hop of one order: assigned by the trade engine when the request is sent and copied by the
+    // matching engine onto the responses and market updates that request causes.
+    typedef uint64_t TraceId;
+    constexpr auto TraceId_INVALID = std::numeric_limits<TraceId>::max();
+    inline auto traceIdToString(TraceId trace_id) -> std::string {
+        if (UNLIKELY(trace_id == TraceId_INVALID)) return "INVALID";
+        return std::to_string(trace_id);
+    }
+
+    // Unique across clients: the client id in the top 16 bits, a per-client sequence number below.
+    inline auto makeTraceId(uint64_t client_id, uint64_t seq_num) noexcept -> TraceId {
+        return (client_id << 48) | (seq_num & ((1ULL << 48) - 1));
+    }
+
+    // Same names as the TTT_MEASURE tags, in path order: request out, then the response (t) and market data branches.
+    enum class TraceHop : uint8_t {
+        T10_TradeEngine_LFQueue_write = 0,
+        T11_OrderGateway_LFQueue_read = 1,
+        T12_OrderGateway_TCP_write = 2,
+        T1_OrderServer_TCP_read = 3,
+        T2_OrderServer_LFQueue_write = 4,
+        T3_MatchingEngine_LFQueue_read = 5,
+        T4t_MatchingEngine_LFQueue_write = 6,
+        T5t_OrderServer_LFQueue_read = 7,
+        T6t_OrderServer_TCP_write = 8,
+        T7t_OrderGateway_TCP_read = 9,
+        T8t_OrderGateway_LFQueue_write = 10,
+        T9t_TradeEngine_LFQueue_read = 11,
+        T4_MatchingEngine_LFQueue_write = 12,
+        T5_MarketDataPublisher_LFQueue_read = 13,
+        T6_MarketDataPublisher_UDP_write = 14,
+        T7_MarketDataConsumer_UDP_read = 15,
+        T8_MarketDataConsumer_LFQueue_write = 16,
+        T9_TradeEngine_LFQueue_read = 17,
+        MAX = 18
+    };
+    constexpr size_t TRACE_HOP_COUNT = static_cast<size_t>(TraceHop::MAX);
+
+    inline auto traceHopToString(TraceHop hop) -> std::string {
+        switch (hop) {
+            case TraceHop::T10_TradeEngine_LFQueue_write: return "T10_TradeEngine_LFQueue_write";
+            case TraceHop::T11_OrderGateway_LFQueue_read: return "T11_OrderGateway_LFQueue_read";
+            case TraceHop::T12_OrderGateway_TCP_write: return "T12_OrderGateway_TCP_write";
+            case TraceHop::T1_OrderServer_TCP_read: return "T1_OrderServer_TCP_read";
+            case TraceHop::T2_OrderServer_LFQueue_write: return "T2_OrderServer_LFQueue_write";
+            case TraceHop::T3_MatchingEngine_LFQueue_read: return "T3_MatchingEngine_LFQueue_read";
+            case TraceHop::T4t_MatchingEngine_LFQueue_write: return "T4t_MatchingEngine_LFQueue_write";
+            case TraceHop::T5t_OrderServer_LFQueue_read: return "T5t_OrderServer_LFQueue_read";
+            case TraceHop::T6t_OrderServer_TCP_write: return "T6t_OrderServer_TCP_write";
+            case TraceHop::T7t_OrderGateway_TCP_read: return "T7t_OrderGateway_TCP_read";
+            case TraceHop::T8t_OrderGateway_LFQueue_write: return "T8t_OrderGateway_LFQueue_write";
+            case TraceHop::T9t_TradeEngine_LFQueue_read: return "T9t_TradeEngine_LFQueue_read";
+            case TraceHop::T4_MatchingEngine_LFQueue_write: return "T4_MatchingEngine_LFQueue_write";
+            case TraceHop::T5_MarketDataPublisher_LFQueue_read: return "T5_MarketDataPublisher_LFQueue_read";
+            case TraceHop::T6_MarketDataPublisher_UDP_write: return "T6_MarketDataPublisher_UDP_write";
+            case TraceHop::T7_MarketDataConsumer_UDP_read: return "T7_MarketDataConsumer_UDP_read";
+            case TraceHop::T8_MarketDataConsumer_LFQueue_write: return "T8_MarketDataConsumer_LFQueue_write";
+            case TraceHop::T9_TradeEngine_LFQueue_read: return "T9_TradeEngine_LFQueue_read";
+            case TraceHop::MAX: break;
+        }
+        return "UNKNOWN";
+    }
+
+    // Spans reported by the stitcher: every hop along both branches, then end to end.
+    struct TraceSpan {
+        TraceHop from_;
+        TraceHop to_;
+    };
+    constexpr TraceSpan TRACE_SPANS[] = {
+        {TraceHop::T10_TradeEngine_LFQueue_write, TraceHop::T11_OrderGateway_LFQueue_read},
+        {TraceHop::T11_OrderGateway_LFQueue_read, TraceHop::T12_OrderGateway_TCP_write},
+        {TraceHop::T12_OrderGateway_TCP_write, TraceHop::T1_OrderServer_TCP_read},
+        {TraceHop::T1_OrderServer_TCP_read, TraceHop::T2_OrderServer_LFQueue_write},
+        {TraceHop::T2_OrderServer_LFQueue_write, TraceHop::T3_MatchingEngine_LFQueue_read},
+        {TraceHop::T3_MatchingEngine_LFQueue_read, TraceHop::T4t_MatchingEngine_LFQueue_write},
+        {TraceHop::T4t_MatchingEngine_LFQueue_write, TraceHop::T5t_OrderServer_LFQueue_read},
+        {TraceHop::T5t_OrderServer_LFQueue_read, TraceHop::T6t_OrderServer_TCP_write},
+        {TraceHop::T6t_OrderServer_TCP_write, TraceHop::T7t_OrderGateway_TCP_read},
+        {TraceHop::T7t_OrderGateway_TCP_read, TraceHop::T8t_OrderGateway_LFQueue_write},
+        {TraceHop::T8t_OrderGateway_LFQueue_write, TraceHop::T9t_TradeEngine_LFQueue_read},
+        {TraceHop::T3_MatchingEngine_LFQueue_read, TraceHop::T4_MatchingEngine_LFQueue_write},
+        {TraceHop::T4_MatchingEngine_LFQueue_write, TraceHop::T5_MarketDataPublisher_LFQueue_read},
+        {TraceHop::T5_MarketDataPublisher_LFQueue_read, TraceHop::T6_MarketDataPublisher_UDP_write},
+        {TraceHop::T6_MarketDataPublisher_UDP_write, TraceHop::T7_MarketDataConsumer_UDP_read},
+        {TraceHop::T7_MarketDataConsumer_UDP_read, TraceHop::T8_MarketDataConsumer_LFQueue_write},
+        {TraceHop::T8_MarketDataConsumer_LFQueue_write, TraceHop::T9_TradeEngine_LFQueue_read},
+        {TraceHop::T1_OrderServer_TCP_read, TraceHop::T6t_OrderServer_TCP_write}, // exchange, order in to response out
+        {TraceHop::T1_OrderServer_TCP_read, TraceHop::T6_MarketDataPublisher_UDP_write}, // exchange, order in to market data out
+        {TraceHop::T10_TradeEngine_LFQueue_write, TraceHop::T9t_TradeEngine_LFQueue_read}, // order sent to its response seen
+        {TraceHop::T10_TradeEngine_LFQueue_write, TraceHop::T9_TradeEngine_LFQueue_read} // order sent to its market data seen
+    };
+
+#pragma pack(push, 1)
+    // On the queue and in the trace files as is.
+    struct TraceStamp {
+        TraceId trace_id_ = TraceId_INVALID;
+        uint64_t tsc_ = 0;
+        TraceHop hop_ = TraceHop::MAX;
+    };
+#pragma pack(pop)
+
+    constexpr size_t TRACE_QUEUE_SIZE = 256 * 1024;
+
+    /// Per process: hot threads push (trace id, hop, TSC) stamps onto one MPSC queue, a background thread appends them
+    /// to a binary file. The TSC is shared by every process on the host, so TraceStitcher can line up the files of the
+    /// exchange and all the clients. Until start() is called, record() is a single load and a branch.
+    class TraceCollector final {
+    public:
+        static auto instance() noexcept -> TraceCollector& {
+            static TraceCollector collector;
+            return collector;
+        }
+
+        auto start(const std::string& file_name, int core_id) noexcept {
+            if (writer_thread_) return;
+            file_.open(file_name, std::ios::binary);
+            ASSERT(file_.is_open(), "Could not open trace file: " + file_name);
+            queue_ = new MPSCQueue<TraceStamp>(TRACE_QUEUE_SIZE); // only processes that trace pay for the queue
+            running_ = true;
+            writer_thread_ = createAndStartThread(core_id, "Common/TraceCollector", [this]() {
+                writeLoop();
+            });
+            ASSERT(writer_thread_ != nullptr, "Failed to start TraceCollector thread.");
+            enabled_.store(true, std::memory_order_release);
+        }
+
+        auto record(TraceId trace_id, TraceHop hop, uint64_t tsc) noexcept {
+            if (!enabled_.load(std::memory_order_acquire) || trace_id == TraceId_INVALID)
+                return;
+            auto stamp = queue_->getNextToWriteTo();
+            *stamp = {trace_id, tsc, hop};
+            queue_->updateWriteIndex(stamp);
+        }
+
+        // Stops recording and returns once every stamp recorded so far is in the file. Producers must be done by then.
+        auto stop() noexcept {
+            enabled_.store(false, std::memory_order_release);
+            running_ = false;
+            if (writer_thread_) {
+                writer_thread_->join();
+                delete writer_thread_;
+                writer_thread_ = nullptr;
+            }
+            delete queue_;
+            queue_ = nullptr;
+            file_.close();
+        }
+
+        ~TraceCollector() {
+            stop();
+        }
+
+        TraceCollector(const TraceCollector&) = delete;
+        TraceCollector(const TraceCollector&&) = delete;
+        TraceCollector& operator=(const TraceCollector&) = delete;
+        TraceCollector& operator=(const TraceCollector&&) = delete;
+
+    private:
+        MPSCQueue<TraceStamp>* queue_ = nullptr;
+        std::atomic<bool> enabled_ = {false};
+        std::atomic<bool> running_ = {false};
+        std::ofstream file_;
+        std::thread* writer_thread_ = nullptr;
+
+        TraceCollector() = default;
+
+        auto writeLoop() noexcept -> void {
+            std::vector<TraceStamp> batch;
+            batch.reserve(4096);
+            auto flushBatch = [&]() {
+                file_.write(reinterpret_cast<const char *>(batch.data()), static_cast<std::streamsize>(batch.size() * sizeof(TraceStamp)));
+                batch.clear();
+            };
+            // keep draining after stop until the stamps already claimed are all out
+            while (running_ || queue_->size()) {
+                for (auto stamp = queue_->getNextToRead(); stamp; stamp = queue_->getNextToRead()) {
+                    batch.push_back(*stamp);
+                    queue_->updateReadIndex();
+                    if (batch.size() == batch.capacity()) flushBatch();
+                }
+                if (!batch.empty()) {
+                    flushBatch();
+                    file_.flush();
+                }
+                using namespace std::literals::chrono_literals;
+                std::this_thread::sleep_for(1ms);
+            }
+        }
+    };
+
+    /// Offline: merges the trace files of several processes into one record per trace id and reports the exact
+    /// distribution of every TRACE_SPANS entry. A response or market update seen more than once (fills, several
+    /// updates per order) keeps its first stamp for each hop.
+    class TraceStitcher final {
+    public:
+        explicit TraceStitcher(double ns_per_tick = TscClock::instance().nsPerTick()) : ns_per_tick_(ns_per_tick) {}
+
+        auto load(const std::string& file_name) -> size_t {
+            std::ifstream file(file_name, std::ios::binary);
+            ASSERT(file.is_open(), "Could not open trace file: " + file_name);
+            size_t num_stamps = 0;
+            TraceStamp stamp;
+            while (file.read(reinterpret_cast<char *>(&stamp), sizeof(stamp))) {
+                if (stamp.hop_ >= TraceHop::MAX) continue;
+                auto& tsc = traces_[stamp.trace_id_][static_cast<size_t>(stamp.hop_)];
+                if (!tsc || stamp.tsc_ < tsc) tsc = stamp.tsc_;
+                ++num_stamps;
+            }
+            return num_stamps;
+        }
+
+        auto numTraces() const noexcept { return traces_.size(); }
+
+        // One row per trace: nanoseconds of every hop after T10 (the order leaving the trade engine), empty if not seen.
+        auto writeRecords(std::ostream& os) const {
+            os << "trace_id";
+            for (size_t hop = 0; hop < TRACE_HOP_COUNT; ++hop)
+                os << ',' << traceHopToString(static_cast<TraceHop>(hop));
+            os << '\n';
+            for (const auto& [trace_id, stamps] : traces_) {
+                const auto origin = stamps[static_cast<size_t>(TraceHop::T10_TradeEngine_LFQueue_write)];
+                os << trace_id;
+                for (const auto tsc : stamps) {
+                    os << ',';
+                    if (origin && tsc) os << toNanos(tsc, origin);
+                }
+                os << '\n';
+            }
+        }
+
+        // count, p50, p90, p99, p99.9 and max in nanoseconds per span, over every trace that has both ends
+        auto writeSummary(std::ostream& os) const {
+            os << "from,to,count,p50_ns,p90_ns,p99_ns,p99_9_ns,max_ns\n";
+            std::vector<double> latencies;
+            for (const auto& span : TRACE_SPANS) {
+                latencies.clear();
+                for (const auto& [trace_id, stamps] : traces_) {
+                    const auto from = stamps[static_cast<size_t>(span.from_)], to = stamps[static_cast<size_t>(span.to_)];
+                    if (from && to && to >= from) latencies.push_back(toNanos(to, from));
+                }
+                if (latencies.empty()) continue;
+                std::sort(latencies.begin(), latencies.end());
+                os << traceHopToString(span.from_) << ',' << traceHopToString(span.to_) << ',' << latencies.size() << ','
+                   << exactPercentile(latencies, 0.5) << ',' << exactPercentile(latencies, 0.9) << ','
+                   << exactPercentile(latencies, 0.99) << ',' << exactPercentile(latencies, 0.999) << ',' << latencies.back() << '\n';
+            }
+        }
+
+        TraceStitcher(const TraceStitcher&) = delete;
+        TraceStitcher(const TraceStitcher&&) = delete;
+        TraceStitcher& operator=(const TraceStitcher&) = delete;
+        TraceStitcher& operator=(const TraceStitcher&&) = delete;
+
+    private:
+        const double ns_per_tick_;
+        std::unordered_map<TraceId, std::array<uint64_t, TRACE_HOP_COUNT>> traces_; // 0 means the hop was not seen
+
+        auto toNanos(uint64_t tsc, uint64_t origin) const noexcept -> double {
+            return static_cast<double>(static_cast<int64_t>(tsc - origin)) * ns_per_tick_;
+        }
+
+        // nearest rank on sorted samples
+        static auto exactPercentile(const std::vector<double>& sorted, double quantile) noexcept -> double {
+            const auto rank = static_cast<size_t>(std::ceil(quantile * static_cast<double>(sorted.size())));
+            return sorted[std::max<size_t>(rank, 1) - 1];
+        }
+    };
+}
+
+/// Stamps TRACE_ID's record with hop TAG at TSC. Use it per message where TTT_MEASURE(TAG) covers a whole batch.
+#define TRACE_STAMP(TAG, TRACE_ID, TSC) Common::TraceCollector::instance().record((TRACE_ID), Common::TraceHop::TAG, (TSC))
+
+/// TTT_MEASURE(TAG) that also stamps TRACE_ID's record, both from the same TSC reading.
+#define TTT_TRACE(TAG, TRACE_ID)                                                              \
+    do {                                                                                    \
+        const auto tsc = Common::rdtsc();                                                     \
+        TTT_MEASURE_AT(TAG, tsc);                                                             \
+        TRACE_STAMP(TAG, TRACE_ID, tsc);                                                      \
+    } while(false)
@@ -7,22 +7,15 @@ namespace Common {
 
     // The following limits and constraints are arbitrary and can be modified based on the capacity of the system 
     // on which the trading ecosystem is run 
-    constexpr size_t LOG_QUEUE_SIZE = 8 * 1024 * 1024; // size of the lock-free queue used by the logger (max characters number)
     constexpr size_t ME_MAX_TICKERS = 8; // number of trading instruments the exchange supports 
 
     constexpr size_t ME_MAX_CLIENT_UPDATES = 256 * 1024; // max number unprocessed order requests from all clients
     constexpr size_t ME_MAX_MARKET_UPDATES = 256 * 1024; // max number of market updates generated by the matching engine not yet published 
 
-    constexpr size_t ME_MAX_NUM_CLIENTS = 256; // max number of participan    constexpr size_t ME_MAX_TICKERS = 8;
-
-    constexpr size_t ME_MAX_CLIENT_UPDATES = 256 * 1024;
-    constexpr size_t ME_MAX_MARKET_UPDATES = 256 * 1024;
-
-    constexpr size_t ME_MAX_NUM_CLIENTS = 256;
-    constexpr size_t ME_MAX_ORDER_IDS = 1024 * 1024;
-    constexpr size_t ME_MAX_PRICE_LEVELS = 256;ts in the trading ecosystem 
+    constexpr size_t ME_MAX_NUM_CLIENTS = 256; // max number of participants in the trading ecosystem 
     constexpr size_t ME_MAX_ORDER_IDS = 1024 * 1024; // max number of orders possible for a single trading instrument 
-    constexpr size_t ME_MAX_PRICE_LEVELS = 256; // max depth of price levels for the limit order book that the matching engine maintains
+    // max number of price levels live at once in one limit order book (both sides), at any prices: sizes the level pools
+    constexpr size_t ME_MAX_PRICE_LEVELS = 16 * 1024; 
 
     typedef uint64_t OrderId; 
     constexpr auto OrderId_INVALID = std::numeric_limits<OrderId>::max(); 
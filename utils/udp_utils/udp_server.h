@@ -14,14 +14,14 @@ namespace Common {
         Logger& logger_; 
 
         auto defaultRecvCallback(UDPSocket* socket, Nanos rx_time) noexcept {
-            logger_.log("%:% %() UDPServer::defaultRecvCallback() socket:% len:% rx:%\n", 
-            __FILE__,__LINE__,__FUNCTION__,Common::getCurrentTimeStr(&time_str_), 
+            logger_.log("%:% %() % UDPServer::defaultRecvCallback() socket:% len:% rx:%\n", 
+            __FILE__,__LINE__,__FUNCTION__,Common::getTscTimestamp(), 
             socket->fd_, socket->next_rcv_valid_index_, rx_time); 
         };
 
         auto defalutRecvFinishedCallback() noexcept {
-            logger_.log("%:% %() UDPServer::defalutRecvFinishedCallback()\n", 
-            __FILE__,__LINE__,__FUNCTION__,Common::getCurrentTimeStr(&time_str_)); 
+            logger_.log("%:% %() % UDPServer::defalutRecvFinishedCallback()\n", 
+            __FILE__,__LINE__,__FUNCTION__,Common::getTscTimestamp()); 
         };
 
         explicit UDPServer(Logger& logger) : logger_(logger) {
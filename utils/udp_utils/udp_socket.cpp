@@ -33,10 +33,10 @@ namespace Common {
         std::cout << "n_rcev = " << n_rcv << " fd_ = " << fd_ << std::endl; 
         if (n_rcv > 0) {
             next_rcv_valid_index_ += n_rcv; 
-            const auto user_time = getCurrentNanos(); 
+            const auto user_time = getTscNanos(); 
             logger_.log("%:% %() % read socket:% len:% utime:%\n", 
                 __FILE__,__LINE__,__FUNCTION__,
-                Common::getCurrentTimeStr(&time_str_), fd_, next_rcv_valid_index_, user_time); 
+                Common::getTscTimestamp(), fd_, next_rcv_valid_index_, user_time); 
             recv_callback_(this, user_time);
 
             // Handle buffer overflow
@@ -58,7 +58,7 @@ namespace Common {
         //     }
         
         //     logger_.log("%: % %() % send socket: % len:%\n", 
-        //         __FILE__,__LINE__,__FUNCTION__,Common::getCurrentTimeStr(&time_str_), fd_, n);
+        //         __FILE__,__LINE__,__FUNCTION__,Common::getTscTimestamp(), fd_, n);
         //     n_send -= n; // decrements n_send by number of bytes actually sent in this iteration
         //     ASSERT(n == n_send_this_msg, "Don't support partial send lengths yet."); 
         // }
@@ -10,7 +10,7 @@ namespace Common {
 
         auto defaultRecvCallback(UDPSocket* socket, Nanos rx_time) noexcept {
             logger_.log("%:% %() % UDPSocket::defaultRecvCallback() socket: % len:% rx:%\n", 
-                __FILE__,__LINE__,__FUNCTION__,Common::getCurrentTimeStr(&time_str_), 
+                __FILE__,__LINE__,__FUNCTION__,Common::getTscTimestamp(), 
                 socket->fd_, socket->next_rcv_valid_index_, rx_time); 
         }
 
@@ -0,0 +1,147 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <span>
+#include <limits>
+#include <algorithm>
+#include "macros.h"
+
+namespace Common {
+    // Single-producer multi-consumer broadcast ring (Disruptor style): every consumer sees every element,
+    // reading it in place through its own cursor, and the producer only reuses a slot once the slowest
+    // consumer has released it. Consumers must be registered with addConsumer() before the producer starts.
+    template <typename T, size_t MaxConsumers = 4>
+    class BroadcastQueue final {
+    private:
+        // One cache line per consumer, written only by that consumer
+        struct alignas(CACHE_LINE_SIZE) ConsumerCursor {
+            std::atomic<size_t> next_read_index_ = {0};
+            size_t cached_write_index_ = 0;
+        };
+
+        // Read-only after construction, shared by all threads
+        alignas(CACHE_LINE_SIZE) std::vector<T> store_;
+        size_t mask_ = 0;
+        std::atomic<size_t> num_consumers_ = {0};
+
+        // Producer side
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> next_write_index_ = {0};
+        size_t cached_min_read_index_ = 0;
+
+        std::array<ConsumerCursor, MaxConsumers> cursors_;
+
+        static constexpr auto roundUpToPowerOfTwo(size_t n) noexcept {
+            size_t capacity = 1;
+            while (capacity < n) capacity <<= 1;
+            return capacity;
+        }
+
+        auto minReadIndex() const noexcept {
+            auto min_read_index = next_write_index_.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < num_consumers_.load(std::memory_order_acquire); ++i)
+                min_read_index = std::min(min_read_index, cursors_[i].next_read_index_.load(std::memory_order_acquire));
+            return min_read_index;
+        }
+
+    public:
+        BroadcastQueue(std::size_t num_elems) : store_(roundUpToPowerOfTwo(num_elems), T()), /*vector storage pre-allocation*/
+            mask_(store_.size() - 1) {}
+
+        BroadcastQueue() = delete;
+        BroadcastQueue(const BroadcastQueue&) = delete;
+        BroadcastQueue(const BroadcastQueue&&) = delete;
+        BroadcastQueue& operator=(const BroadcastQueue&) = delete;
+        BroadcastQueue& operator=(const BroadcastQueue&&) = delete;
+
+        // Returns the id the consumer passes to the read methods. The new cursor starts at the current write index.
+        auto addConsumer() noexcept {
+            const auto consumer_id = num_consumers_.load(std::memory_order_relaxed);
+            ASSERT(consumer_id < MaxConsumers, "Too many consumers on BroadcastQueue: " + std::to_string(consumer_id));
+            cursors_[consumer_id].next_read_index_.store(next_write_index_.load(std::memory_order_acquire), std::memory_order_relaxed);
+            cursors_[consumer_id].cached_write_index_ = cursors_[consumer_id].next_read_index_.load(std::memory_order_relaxed);
+            num_consumers_.store(consumer_id + 1, std::memory_order_release);
+            return consumer_id;
+        }
+
+        // Spins while the slowest consumer is a full ring behind
+        auto getNextToWriteTo() noexcept {
+            const auto write_index = next_write_index_.load(std::memory_order_relaxed);
+            while (UNLIKELY(write_index - cached_min_read_index_ == store_.size())) {
+                cached_min_read_index_ = minReadIndex();
+            }
+            return &store_[write_index & mask_];
+        }
+
+        auto updateWriteIndex() noexcept {
+            updateWriteIndex(1);
+        }
+
+        // Batch write, same contract as LFQueue::getWriteSpan(): up to max_elems contiguous free slots, stopping at the
+        // end of the store. Empty while the slowest consumer is a full ring behind.
+        auto getWriteSpan(size_t max_elems) noexcept -> std::span<T> {
+            const auto write_index = next_write_index_.load(std::memory_order_relaxed);
+            auto free_elems = store_.size() - (write_index - cached_min_read_index_);
+            if (free_elems < max_elems) {
+                cached_min_read_index_ = minReadIndex();
+                free_elems = store_.size() - (write_index - cached_min_read_index_);
+            }
+            const auto offset = write_index & mask_;
+            return std::span<T>(&store_[offset], std::min({max_elems, free_elems, store_.size() - offset}));
+        }
+
+        // Publishes num_elems slots claimed through getWriteSpan() to every consumer with a single release store
+        auto updateWriteIndex(size_t num_elems) noexcept {
+            next_write_index_.store(next_write_index_.load(std::memory_order_relaxed) + num_elems, std::memory_order_release);
+        }
+
+        auto getNextToRead(size_t consumer_id) noexcept -> const T* {
+            auto& cursor = cursors_[consumer_id];
+            const auto read_index = cursor.next_read_index_.load(std::memory_order_relaxed);
+            if (read_index == cursor.cached_write_index_) {
+                cursor.cached_write_index_ = next_write_index_.load(std::memory_order_acquire);
+                if (read_index == cursor.cached_write_index_)
+                    return nullptr;
+            }
+            return &store_[read_index & mask_];
+        }
+
+        auto updateReadIndex(size_t consumer_id) noexcept {
+            updateReadIndex(consumer_id, 1);
+        }
+
+        // Batch read, same contract as LFQueue::getReadSpan(): contiguous ready elements up to the end of the store
+        auto getReadSpan(size_t consumer_id, size_t max_elems = std::numeric_limits<size_t>::max()) noexcept -> std::span<const T> {
+            auto& cursor = cursors_[consumer_id];
+            const auto read_index = cursor.next_read_index_.load(std::memory_order_relaxed);
+            cursor.cached_write_index_ = next_write_index_.load(std::memory_order_acquire);
+            const auto offset = read_index & mask_;
+            return std::span<const T>(&store_[offset], std::min({max_elems, cursor.cached_write_index_ - read_index, store_.size() - offset}));
+        }
+
+        auto updateReadIndex(size_t consumer_id, size_t num_elems) noexcept {
+            auto& cursor = cursors_[consumer_id];
+            const auto read_index = cursor.next_read_index_.load(std::memory_order_relaxed);
+            if (UNLIKELY(num_elems > cursor.cached_write_index_ - read_index)) {
+                FATAL("Released more elements than were read by consumer: " + std::to_string(consumer_id));
+            }
+            cursor.next_read_index_.store(read_index + num_elems, std::memory_order_release);
+        }
+
+        // Position of the consumer's next element in the stream of everything ever written, starting at 0
+        auto readIndex(size_t consumer_id) const noexcept {
+            return cursors_[consumer_id].next_read_index_.load(std::memory_order_relaxed);
+        }
+
+        // Elements not yet released by this consumer
+        auto size(size_t consumer_id) const noexcept {
+            const auto read_index = cursors_[consumer_id].next_read_index_.load(std::memory_order_acquire);
+            return next_write_index_.load(std::memory_order_acquire) - read_index;
+        }
+
+        auto capacity() const noexcept {
+            return store_.size();
+        }
+    };
+}
@@ -0,0 +1,50 @@
+#include "thread_utils.h"
+#include "broadcast_queue.h"
+
+struct MyStruct {
+    int d_[3];
+};
+
+using namespace Common;
+
+// Every consumer reads every element in place through its own cursor; the producer waits for the slowest one.
+auto consumeFunction(BroadcastQueue<MyStruct>* bq, size_t consumer_id, int num_elems) {
+    for (int expected = 0; expected < num_elems;) {
+        const auto elems = bq->getReadSpan(consumer_id);
+        for (const auto& d : elems) {
+            ASSERT(d.d_[0] == expected, "consumer " + std::to_string(consumer_id) + " read out of order elem: " + std::to_string(d.d_[0]));
+            ++expected;
+        }
+        if (!elems.empty())
+            bq->updateReadIndex(consumer_id, elems.size());
+    }
+    std::cout << "consumer " << consumer_id << " read " << num_elems << " elems" << std::endl;
+}
+
+int main(int, char* []) {
+    constexpr int num_elems = 100 * 1000;
+    BroadcastQueue<MyStruct> bq(1024);
+    const auto c0 = bq.addConsumer(), c1 = bq.addConsumer();
+    auto ct0 = createAndStartThread(-1, "consumer0", consumeFunction, &bq, c0, num_elems);
+    auto ct1 = createAndStartThread(-1, "consumer1", consumeFunction, &bq, c1, num_elems);
+
+    // first half one element at a time, then in bursts of up to 7 published together
+    auto i = 0;
+    for (; i < num_elems / 2; i++) {
+        *(bq.getNextToWriteTo()) = MyStruct{i, i*10, i*100};
+        bq.updateWriteIndex();
+    }
+    while (i < num_elems) {
+        const auto elems = bq.getWriteSpan(std::min(7, num_elems - i));
+        for (auto& d : elems) {
+            d = MyStruct{i, i*10, i*100};
+            ++i;
+        }
+        if (!elems.empty())
+            bq.updateWriteIndex(elems.size());
+    }
+    ct0->join();
+    ct1->join();
+    std::cout << "main exiting" << std::endl;
+    return 0;
+}
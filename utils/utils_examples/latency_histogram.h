@@ -0,0 +1,293 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+
+#include "macros.h"
+#include "thread_utils.h"
+#include "time_utils.h"
+#include "perf_counters.h"
+
+namespace Common {
+    // Log-linear buckets in the style of HdrHistogram: values below 2^LATENCY_SUB_BUCKET_BITS are exact, above that
+    // each power of two is split into 2^(LATENCY_SUB_BUCKET_BITS - 1) linear buckets, so a bucket is at most ~3% wide.
+    constexpr unsigned LATENCY_SUB_BUCKET_BITS = 6;
+    constexpr size_t LATENCY_MAX_TAGS = 128;
+
+    enum class LatencyKind : uint8_t {
+        RDTSC = 0, // START_MEASURE -> END_MEASURE
+        TTT = 1 // time since the previous TTT_MEASURE point in the process
+    };
+
+    inline auto latencyKindToString(LatencyKind kind) noexcept {
+        return (kind == LatencyKind::RDTSC ? "RDTSC" : "TTT");
+    }
+
+    // Cumulative since start, in nanoseconds. Percentiles are the upper bound of the bucket they fall in.
+    struct LatencySnapshot {
+        uint64_t count_ = 0;
+        double min_ = 0, p50_ = 0, p90_ = 0, p99_ = 0, p999_ = 0, max_ = 0, mean_ = 0;
+    };
+
+    /// Fixed-size histogram of TSC tick counts. record() is a few relaxed atomic adds, so the threads sharing a tag
+    /// (every matching engine shard at one call site) can record at once; snapshot() may run concurrently on any thread.
+    class LatencyHistogram final {
+    public:
+        static constexpr size_t SUB_BUCKETS = 1 << LATENCY_SUB_BUCKET_BITS;
+        static constexpr size_t HALF_SUB_BUCKETS = SUB_BUCKETS / 2;
+        static constexpr size_t NUM_BUCKETS = (64 - LATENCY_SUB_BUCKET_BITS) * HALF_SUB_BUCKETS + SUB_BUCKETS;
+
+        static constexpr auto bucketIndex(uint64_t value) noexcept -> size_t {
+            if (value < SUB_BUCKETS) return value;
+            const auto shift = 63 - __builtin_clzll(value) - (LATENCY_SUB_BUCKET_BITS - 1);
+            return shift * HALF_SUB_BUCKETS + (value >> shift);
+        }
+
+        static constexpr auto bucketUpperBound(size_t index) noexcept -> uint64_t {
+            if (index < SUB_BUCKETS) return index;
+            const auto shift = index / HALF_SUB_BUCKETS - 1;
+            const auto mantissa = index - shift * HALF_SUB_BUCKETS;
+            return ((mantissa + 1) << shift) - 1;
+        }
+
+        auto record(uint64_t ticks) noexcept {
+            counts_[bucketIndex(ticks)].fetch_add(1, std::memory_order_relaxed);
+            sum_.fetch_add(ticks, std::memory_order_relaxed);
+            atomicFetchMax(max_, ticks);
+            atomicFetchMin(min_, ticks);
+            count_.fetch_add(1, std::memory_order_release);
+        }
+
+        auto snapshot(double ns_per_tick) const noexcept {
+            LatencySnapshot snapshot;
+            snapshot.count_ = count_.load(std::memory_order_acquire);
+            if (!snapshot.count_) return snapshot;
+
+            // one pass over the buckets for all the percentiles, targets in increasing order
+            const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+            double* results[] = {&snapshot.p50_, &snapshot.p90_, &snapshot.p99_, &snapshot.p999_};
+            size_t next = 0;
+            uint64_t seen = 0;
+            for (size_t i = 0; i < NUM_BUCKETS && next < std::size(quantiles); ++i) {
+                seen += counts_[i].load(std::memory_order_relaxed);
+                while (next < std::size(quantiles) && static_cast<double>(seen) >= quantiles[next] * static_cast<double>(snapshot.count_))
+                    *results[next++] = static_cast<double>(bucketUpperBound(i)) * ns_per_tick;
+            }
+            snapshot.min_ = static_cast<double>(min_.load(std::memory_order_relaxed)) * ns_per_tick;
+            snapshot.max_ = static_cast<double>(max_.load(std::memory_order_relaxed)) * ns_per_tick;
+            snapshot.mean_ = static_cast<double>(sum_.load(std::memory_order_relaxed)) * ns_per_tick / static_cast<double>(snapshot.count_);
+            // the true maximum is known exactly, do not report a bucket bound above it
+            for (auto result : results) *result = std::min(*result, snapshot.max_);
+            return snapshot;
+        }
+
+        auto tag() const noexcept { return tag_; }
+        auto kind() const noexcept { return kind_; }
+#if PERF_COUNTERS_ENABLED
+        auto perfCounters() noexcept -> PerfCounterStats& { return perf_counters_; }
+        auto perfCounters() const noexcept -> const PerfCounterStats& { return perf_counters_; }
+#endif
+
+        LatencyHistogram() = default;
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram(const LatencyHistogram&&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&&) = delete;
+
+    private:
+        friend class LatencyRegistry;
+
+        const char* tag_ = nullptr; // the stringified TAG, a literal
+        LatencyKind kind_ = LatencyKind::RDTSC;
+        std::atomic<uint64_t> count_ = {0};
+        std::atomic<uint64_t> sum_ = {0};
+        std::atomic<uint64_t> min_ = {UINT64_MAX};
+        std::atomic<uint64_t> max_ = {0};
+        std::array<std::atomic<uint64_t>, NUM_BUCKETS> counts_{};
+#if PERF_COUNTERS_ENABLED
+        PerfCounterStats perf_counters_; // RDTSC sections only
+#endif
+    };
+
+    /// One histogram per measurement tag in the process. The measurement macros look theirs up once per call site,
+    /// startDumping() appends a CSV snapshot of every tag periodically and once more at shutdown.
+    class LatencyRegistry final {
+    public:
+        static auto instance() noexcept -> LatencyRegistry& {
+            static LatencyRegistry registry;
+            return registry;
+        }
+
+        // Not on the hot path: called once per call site, from the static initialization in the macros below.
+        auto histogram(const char* tag, LatencyKind kind) noexcept -> LatencyHistogram& {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto num_tags = num_tags_.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < num_tags; ++i) {
+                if (histograms_[i].kind_ == kind && std::string_view(histograms_[i].tag_) == tag)
+                    return histograms_[i];
+            }
+            ASSERT(num_tags < LATENCY_MAX_TAGS, "LatencyRegistry supports at most " + std::to_string(LATENCY_MAX_TAGS) + " tags.");
+            histograms_[num_tags].tag_ = tag;
+            histograms_[num_tags].kind_ = kind;
+            num_tags_.store(num_tags + 1, std::memory_order_release);
+            return histograms_[num_tags];
+        }
+
+        // Records tsc as the calling thread's latest TTT point and returns the ticks since its previous one, 0 if there is
+        // none. Per thread: the points of other threads belong to other messages, hops across threads are for trace.h.
+        auto swapTttPoint(uint64_t tsc) noexcept -> uint64_t {
+            static thread_local uint64_t last_ttt = 0;
+            const auto previous = last_ttt;
+            last_ttt = tsc;
+            return (LIKELY(previous && tsc > previous) ? tsc - previous : 0);
+        }
+
+        auto startDumping(const std::string& file_name, int interval_ms, int core_id) noexcept {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (dump_thread_) return;
+            file_.open(file_name);
+            ASSERT(file_.is_open(), "Could not open latency file: " + file_name);
+            file_ << "time_ns,tag,kind,count,min_ns,p50_ns,p90_ns,p99_ns,p99_9_ns,max_ns,mean_ns";
+#if PERF_COUNTERS_ENABLED
+            for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+                file_ << ',' << perfCounterToString(static_cast<PerfCounter>(i)) << "_mean," << perfCounterToString(static_cast<PerfCounter>(i)) << "_max";
+            file_ << ",perf_scaled,perf_unscheduled";
+#endif
+            file_ << '\n';
+            file_ << std::fixed << std::setprecision(1);
+            running_ = true;
+            lock.unlock();
+            dump_thread_ = createAndStartThread(core_id, "Common/LatencyRegistry", [this, interval_ms]() {
+                dumpLoop(interval_ms);
+            });
+            ASSERT(dump_thread_ != nullptr, "Failed to start LatencyRegistry dump thread.");
+        }
+
+        // Appends one row per tag with at least one sample.
+        auto dump() noexcept -> void {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!file_.is_open()) return;
+            const auto& clock = TscClock::instance();
+            const auto now = clock.now();
+            const auto num_tags = num_tags_.load(std::memory_order_acquire);
+            for (size_t i = 0; i < num_tags; ++i) {
+                const auto snapshot = histograms_[i].snapshot(clock.nsPerTick());
+                if (!snapshot.count_) continue;
+                file_ << now << ',' << histograms_[i].tag_ << ',' << latencyKindToString(histograms_[i].kind_) << ',' << snapshot.count_ << ','
+                      << snapshot.min_ << ',' << snapshot.p50_ << ',' << snapshot.p90_ << ',' << snapshot.p99_ << ','
+                      << snapshot.p999_ << ',' << snapshot.max_ << ',' << snapshot.mean_;
+#if PERF_COUNTERS_ENABLED
+                // empty for TTT tags and for threads the kernel gave no counters
+                const auto& perf_counters = histograms_[i].perfCounters();
+                for (size_t j = 0; j < PERF_COUNTER_COUNT; ++j) {
+                    file_ << ',';
+                    if (perf_counters.count())
+                        file_ << perf_counters.mean(static_cast<PerfCounter>(j)) << ',' << perf_counters.max(static_cast<PerfCounter>(j));
+                    else
+                        file_ << ',';
+                }
+                // sections whose counts were scaled for multiplexing, and sections left out because the group never ran
+                file_ << ',' << perf_counters.scaled() << ',' << perf_counters.unscheduled();
+#endif
+                file_ << '\n';
+            }
+            file_.flush();
+        }
+
+        ~LatencyRegistry() {
+            if (dump_thread_) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    running_ = false;
+                }
+                stop_cv_.notify_all();
+                dump_thread_->join();
+                delete dump_thread_;
+                dump_thread_ = nullptr;
+            }
+            dump();
+            file_.close();
+        }
+
+        LatencyRegistry(const LatencyRegistry&) = delete;
+        LatencyRegistry(const LatencyRegistry&&) = delete;
+        LatencyRegistry& operator=(const LatencyRegistry&) = delete;
+        LatencyRegistry& operator=(const LatencyRegistry&&) = delete;
+
+    private:
+        std::array<LatencyHistogram, LATENCY_MAX_TAGS> histograms_;
+        std::atomic<size_t> num_tags_ = {0};
+
+        std::mutex mutex_; // registration, the file and running_
+        std::condition_variable stop_cv_;
+        bool running_ = false;
+        std::ofstream file_;
+        std::thread* dump_thread_ = nullptr;
+
+        // constructing the clock first makes it outlive the registry, whose destructor still converts ticks
+        LatencyRegistry() {
+            TscClock::instance();
+        }
+
+        auto dumpLoop(int interval_ms) noexcept -> void {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stop_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms), [this]() { return !running_; })) {
+                lock.unlock();
+                dump();
+                lock.lock();
+            }
+        }
+    };
+}
+
+#if PERF_COUNTERS_ENABLED
+/// Start latency measurement using rdtsc(), after reading this thread's hardware counters into TAG_counters.
+/// Creates variables called TAG and TAG_counters in the local scope.
+#define START_MEASURE(TAG)                                                                    \
+    Common::PerfCounterValues TAG##_counters;                                                 \
+    Common::PerfCounterGroup::forThisThread().read(TAG##_counters);                           \
+    const auto TAG = Common::rdtsc()
+
+/// End latency measurement using rdtsc(), then read the hardware counters again. Expects the variables created by
+/// START_MEASURE(TAG). The elapsed ticks go into TAG's histogram and the counter deltas into its PerfCounterStats.
+#define END_MEASURE(TAG)                                                                      \
+    do {                                                                                    \
+        const auto end = Common::rdtsc();                                                     \
+        Common::PerfCounterValues end_counters;                                               \
+        auto& perf_counter_group = Common::PerfCounterGroup::forThisThread();                \
+        perf_counter_group.read(end_counters);                                                \
+        static auto& histogram = Common::LatencyRegistry::instance().histogram(#TAG, Common::LatencyKind::RDTSC); \
+        histogram.record(end - TAG);                                                          \
+        if (LIKELY(perf_counter_group.available())) histogram.perfCounters().record(TAG##_counters, end_counters); \
+    } while(false)
+#else
+/// Start latency measurement using rdtsc(). Creates a variable called TAG in the local scope.
+#define START_MEASURE(TAG) const auto TAG = Common::rdtsc()
+
+/// End latency measurement using rdtsc(). Expects a variable called TAG to already exist in the local scope.
+/// The elapsed ticks go into TAG's histogram, looked up once per call site.
+#define END_MEASURE(TAG)                                                                      \
+    do {                                                                                    \
+        const auto end = Common::rdtsc();                                                     \
+        static auto& histogram = Common::LatencyRegistry::instance().histogram(#TAG, Common::LatencyKind::RDTSC); \
+        histogram.record(end - TAG);                                                          \
+    } while(false)
+#endif
+
+/// Mark a point on the tick-to-trade path, read at TSC. TAG's histogram gets the ticks since the previous TTT point on
+/// the same thread, so e.g. T2_OrderServer_LFQueue_write measures the hop from T1_OrderServer_TCP_read.
+#define TTT_MEASURE_AT(TAG, TSC)                                                              \
+    do {                                                                                    \
+        static auto& histogram = Common::LatencyRegistry::instance().histogram(#TAG, Common::LatencyKind::TTT); \
+        const auto since_previous = Common::LatencyRegistry::instance().swapTttPoint(TSC);    \
+        if (LIKELY(since_previous)) histogram.record(since_previous);                          \
+    } while(false)
+
+#define TTT_MEASURE(TAG) TTT_MEASURE_AT(TAG, Common::rdtsc())
@@ -0,0 +1,75 @@
+#include <random>
+#include <algorithm>
+#include <iostream>
+#include "latency_histogram.h"
+
+// Feeds known tick counts through END_MEASURE's histogram, checks the percentiles against the exact ones
+// from the sorted samples, then times the macros themselves and dumps the registry to CSV.
+
+using namespace Common;
+
+constexpr size_t NUM_SAMPLES = 1000 * 1000;
+
+int main(int, char* []) {
+    auto& histogram = LatencyRegistry::instance().histogram("latency_histogram_example_samples", LatencyKind::RDTSC);
+    std::mt19937_64 rng(42);
+    std::lognormal_distribution<double> latency(7.0, 1.0); // ~1000 ticks median, long tail
+    std::vector<uint64_t> samples;
+    samples.reserve(NUM_SAMPLES);
+    for (size_t i = 0; i < NUM_SAMPLES; ++i) {
+        samples.push_back(static_cast<uint64_t>(latency(rng)));
+        histogram.record(samples.back());
+    }
+    std::sort(samples.begin(), samples.end());
+
+    const auto snapshot = histogram.snapshot(1.0); // in ticks
+    const std::pair<double, double> checks[] = {{0.5, snapshot.p50_}, {0.9, snapshot.p90_}, {0.99, snapshot.p99_}, {0.999, snapshot.p999_}};
+    for (const auto& [quantile, reported] : checks) {
+        const auto exact = static_cast<double>(samples[static_cast<size_t>(quantile * NUM_SAMPLES) - 1]);
+        std::cout << "p" << quantile * 100 << " exact: " << exact << " histogram: " << reported << std::endl;
+        ASSERT(reported >= exact && reported <= exact * 1.04, "percentile outside the bucket precision");
+    }
+    ASSERT(snapshot.max_ == static_cast<double>(samples.back()) && snapshot.count_ == NUM_SAMPLES, "max or count mismatch");
+
+    const auto start = rdtsc();
+    for (size_t i = 0; i < NUM_SAMPLES; ++i) {
+        START_MEASURE(latency_histogram_example_measure);
+        END_MEASURE(latency_histogram_example_measure);
+        TTT_MEASURE(latency_histogram_example_ttt);
+    }
+    std::cout << "START_MEASURE + END_MEASURE + TTT_MEASURE: "
+              << static_cast<double>(rdtsc() - start) / NUM_SAMPLES << " ticks per iteration" << std::endl;
+
+    // TTT hops are per thread: another thread's points must not cut into this thread's hop
+    auto& registry = LatencyRegistry::instance();
+    registry.swapTttPoint(1000 * 1000);
+    auto other = createAndStartThread(-1, "latency_histogram_example_other", [&registry]() {
+        registry.swapTttPoint(1000 * 1000 + 400);
+    });
+    other->join();
+    ASSERT(registry.swapTttPoint(1000 * 1000 + 500) == 500, "TTT hop mixed points of two threads");
+    std::cout << "TTT hops are per thread" << std::endl;
+
+    // several shards record into one call site's histogram: no sample may be lost
+    auto& shared = registry.histogram("latency_histogram_example_shared", LatencyKind::RDTSC);
+    constexpr size_t NUM_WRITERS = 4, SAMPLES_PER_WRITER = 250 * 1000;
+    std::vector<std::thread*> writers;
+    for (size_t w = 0; w < NUM_WRITERS; ++w) {
+        writers.push_back(createAndStartThread(-1, "latency_histogram_example_writer", [&shared, w]() {
+            for (size_t i = 0; i < SAMPLES_PER_WRITER; ++i)
+                shared.record(w * SAMPLES_PER_WRITER + i + 1);
+        }));
+    }
+    for (auto writer : writers) {
+        writer->join();
+        delete writer;
+    }
+    const auto shared_snapshot = shared.snapshot(1.0);
+    ASSERT(shared_snapshot.count_ == NUM_WRITERS * SAMPLES_PER_WRITER && shared_snapshot.min_ == 1.0 &&
+           shared_snapshot.max_ == static_cast<double>(NUM_WRITERS * SAMPLES_PER_WRITER), "concurrent writers lost samples");
+    ASSERT(shared_snapshot.mean_ == static_cast<double>(NUM_WRITERS * SAMPLES_PER_WRITER + 1) / 2, "concurrent writers lost part of the sum");
+    std::cout << NUM_WRITERS << " concurrent writers: " << shared_snapshot.count_ << " samples, none lost" << std::endl;
+
+    LatencyRegistry::instance().startDumping("latency_histogram_example.csv", 1000, -1);
+    return 0; // the registry writes its final snapshot on exit
+}
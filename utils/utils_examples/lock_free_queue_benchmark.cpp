@@ -0,0 +1,120 @@
+#include <atomic>
+#include <chrono>
+#include "thread_utils.h"
+#include "lock_free_queue.h"
+
+// Producer/consumer round trip through LFQueue, comparing the original shared-counter ring with the SPSC ring,
+// one element at a time and through the batch (span) API.
+// Pin the two threads to different cores (argv[1], argv[2]) to see the cache-line traffic between them.
+
+struct BenchMsg {
+    size_t seq_;
+    char payload_[40];
+};
+
+using namespace Common;
+
+constexpr size_t QUEUE_SIZE = 64 * 1024;
+constexpr size_t NUM_MESSAGES = 10 * 1000 * 1000;
+constexpr size_t BATCH_SIZE = 64;
+
+template<LFQueueMode Mode, bool Batched>
+auto consumeFunction(LFQueue<BenchMsg, Mode>* lfq, size_t* checksum) {
+    size_t expected = 0;
+    while (expected < NUM_MESSAGES) {
+        if constexpr (Batched) {
+            const auto msgs = lfq->getReadSpan();
+            for (const auto& msg : msgs) {
+                if (UNLIKELY(msg.seq_ != expected))
+                    FATAL("Out of order element: " + std::to_string(msg.seq_));
+                *checksum += msg.seq_;
+                ++expected;
+            }
+            if (!msgs.empty())
+                lfq->updateReadIndex(msgs.size());
+            continue;
+        }
+        const auto msg = lfq->getNextToRead();
+        if (!msg) continue;
+        if (UNLIKELY(msg->seq_ != expected))
+            FATAL("Out of order element: " + std::to_string(msg->seq_));
+        *checksum += msg->seq_;
+        lfq->updateReadIndex();
+        ++expected;
+    }
+}
+
+template<LFQueueMode Mode, bool Batched = false>
+auto runBenchmark(const char* name, int producer_core, int consumer_core) {
+    LFQueue<BenchMsg, Mode> lfq(QUEUE_SIZE);
+    size_t checksum = 0;
+    auto ct = createAndStartThread(consumer_core, std::string("Consumer/") + name, consumeFunction<Mode, Batched>, &lfq, &checksum);
+    if (producer_core >= 0)
+        setThreadCore(producer_core);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < NUM_MESSAGES;) {
+        if constexpr (Batched) {
+            const auto slots = lfq.getWriteSpan(std::min(BATCH_SIZE, NUM_MESSAGES - i));
+            for (auto& slot : slots)
+                slot.seq_ = i++;
+            if (!slots.empty())
+                lfq.updateWriteIndex(slots.size());
+            continue;
+        }
+        if constexpr (Mode == LFQueueMode::SHARED_COUNTER) {
+            // the original ring does not check for space, so the producer has to
+            while (lfq.size() >= lfq.capacity() - 1);
+        }
+        auto next_write = lfq.getNextToWriteTo();
+        next_write->seq_ = i++;
+        lfq.updateWriteIndex();
+    }
+    ct->join();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    delete ct;
+
+    ASSERT(checksum == NUM_MESSAGES * (NUM_MESSAGES - 1) / 2, "Checksum mismatch.");
+    std::cout << name << ": " << NUM_MESSAGES << " msgs in " << elapsed / 1000000 << " ms, "
+              << static_cast<double>(elapsed) / NUM_MESSAGES << " ns/msg" << std::endl;
+}
+
+// size() polled from a third thread while both ends of an SPSC ring move, untimed: it must never exceed the capacity,
+// as it would if the difference of the two indexes underflowed or was taken over a read index gone stale meanwhile.
+auto checkSizeWhileRunning() {
+    LFQueue<BenchMsg, LFQueueMode::SPSC_RING> lfq(QUEUE_SIZE);
+    size_t checksum = 0;
+    std::atomic<bool> done = false;
+    size_t num_samples = 0;
+    auto watcher = createAndStartThread(-1, "Watcher/SPSC_RING", [&lfq, &done, &num_samples]() {
+        while (!done.load(std::memory_order_acquire)) {
+            const auto size = lfq.size();
+            if (UNLIKELY(size > lfq.capacity()))
+                FATAL("size() underflowed: " + std::to_string(size));
+            ++num_samples;
+        }
+    });
+    auto ct = createAndStartThread(-1, "Consumer/SPSC_RING", consumeFunction<LFQueueMode::SPSC_RING, false>, &lfq, &checksum);
+    for (size_t i = 0; i < NUM_MESSAGES; ++i) {
+        auto next_write = lfq.getNextToWriteTo();
+        next_write->seq_ = i;
+        lfq.updateWriteIndex();
+    }
+    ct->join();
+    done.store(true, std::memory_order_release);
+    watcher->join();
+    delete ct;
+    delete watcher;
+    std::cout << "SPSC_RING size() sampled " << num_samples << " times under load, never above capacity" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    const int producer_core = (argc > 1 ? atoi(argv[1]) : -1);
+    const int consumer_core = (argc > 2 ? atoi(argv[2]) : -1);
+
+    runBenchmark<LFQueueMode::SHARED_COUNTER>("SHARED_COUNTER", producer_core, consumer_core);
+    runBenchmark<LFQueueMode::SPSC_RING>("SPSC_RING", producer_core, consumer_core);
+    runBenchmark<LFQueueMode::SPSC_RING, true>("SPSC_RING_BATCH", producer_core, consumer_core);
+    checkSizeWhileRunning();
+    return 0;
+}
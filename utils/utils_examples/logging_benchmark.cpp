@@ -0,0 +1,27 @@
+#include "logging.h"
+
+// Hot-path cost of a typical log statement (format string, a few numbers, a short string) in both Logger modes,
+// measured in TSC ticks per log() call on the calling thread.
+
+using namespace Common;
+
+constexpr size_t NUM_LOGS = 20 * 1000; // fits in either queue, so the writer thread never applies back-pressure
+
+auto runBenchmark(const char* name, LogMode mode) {
+    Logger logger(std::string("logging_benchmark_") + name + ".log", mode);
+    const std::string order_str = "MEOrder[ticker:1 cid:7 oid:12345 side:BUY price:100 qty:10]";
+    uint64_t total_ticks = 0;
+    for (size_t i = 0; i < NUM_LOGS; ++i) {
+        const auto start = rdtsc();
+        logger.log("%:% %() seq:% price:% Processing %\n", __FILE__, __LINE__, __FUNCTION__, i, 100.25, order_str);
+        total_ticks += rdtsc() - start;
+    }
+    std::cout << name << ": " << NUM_LOGS << " log() calls, " << static_cast<double>(total_ticks) / NUM_LOGS
+              << " ticks/call" << std::endl;
+}
+
+int main(int, char* []) {
+    runBenchmark("CHARACTER", LogMode::CHARACTER);
+    runBenchmark("BINARY", LogMode::BINARY);
+    return 0;
+}
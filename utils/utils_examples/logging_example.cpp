@@ -9,10 +9,14 @@ int main (int, char **) {
     double d = 34.56; 
     const char* s = "test C-string"; 
     std::string ss = "test string"; 
-    Logger logger("logging_example.log"); 
-    logger.log("Logging a char:% an int:% and an unsigned:%\n", c, i, ul); 
-    logger.log("Logging a float:% and a double:%\n", f, d); 
-    logger.log("Logging a C-string:'%'\n", s); 
-    logger.log("Logging a string:%\n", ss); 
+    // both modes should produce the same text
+    for (auto mode : {LogMode::BINARY, LogMode::CHARACTER}) {
+        Logger logger(mode == LogMode::BINARY ? "logging_example.log" : "logging_example_character.log", mode); 
+        logger.log("Logging a char:% an int:% and an unsigned:%\n", c, i, ul); 
+        logger.log("Logging a float:% and a double:%\n", f, d); 
+        logger.log("Logging a C-string:'%'\n", s); 
+        logger.log("Logging a string:%\n", ss); 
+        logger.log("Logging a literal 100%% and no arguments\n"); 
+    }
     return 0; 
 }
\ No newline at end of file
@@ -7,6 +7,9 @@
 #define LIKELY(x) __builtin_expect(!!(x), 1)
 #define UNLIKELY(x) __builtin_expect(!!(x), 0)
 
+// size of a cache line, used to keep data written by different threads on separate lines
+constexpr size_t CACHE_LINE_SIZE = 64;
+
 inline auto ASSERT(bool cond, const std::string& msg) noexcept {
     if (UNLIKELY(!cond)) {
         std::cerr << "ASSERT: " << msg << std::endl; 
@@ -0,0 +1,64 @@
+#include <chrono>
+#include <random>
+#include <iostream>
+#include "mem_pool.h"
+
+// Order-book style add/cancel churn against both MemPool modes: the pool is filled to a resting depth,
+// then every op either adds an order or cancels a random live one, which fragments the linear-scan pool.
+// The last run places the free-list pool on huge pages, locked and prefaulted (see memory_backing.h).
+
+struct BenchOrder { // same footprint as Exchange::MEOrder
+    uint32_t ticker_id_;
+    uint32_t client_id_;
+    uint64_t client_order_id_;
+    uint64_t market_order_id_;
+    int8_t side_;
+    int64_t price_;
+    uint32_t qty_;
+    uint64_t priority_;
+    BenchOrder* prev_order_;
+    BenchOrder* next_order_;
+};
+
+using namespace Common;
+
+constexpr size_t POOL_SIZE = 1024 * 1024;
+constexpr size_t RESTING_ORDERS = POOL_SIZE / 2;
+constexpr size_t NUM_OPS = 5 * 1000 * 1000;
+
+template<MemPoolMode Mode>
+auto runBenchmark(const char* name, const MemoryConfig& memory_config = {}) {
+    MemPool<BenchOrder, Mode> pool(POOL_SIZE, memory_config);
+    std::vector<BenchOrder*> live;
+    live.reserve(POOL_SIZE);
+    std::mt19937_64 rng(42);
+
+    for (size_t i = 0; i < RESTING_ORDERS; ++i)
+        live.push_back(pool.allocate(BenchOrder{1, 1, i, i, 1, 100, 10, i, nullptr, nullptr}));
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < NUM_OPS; ++i) {
+        // keep the depth around RESTING_ORDERS, adds and cancels equally likely
+        if ((rng() & 1) && live.size() < POOL_SIZE - 1) {
+            live.push_back(pool.allocate(BenchOrder{1, 1, i, i, 1, 100, 10, i, nullptr, nullptr}));
+        } else if (!live.empty()) {
+            const auto idx = rng() % live.size();
+            pool.deallocate(live[idx]);
+            live[idx] = live.back();
+            live.pop_back();
+        }
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << name << ": " << NUM_OPS << " ops in " << elapsed / 1000000 << " ms, "
+              << static_cast<double>(elapsed) / NUM_OPS << " ns/op, in use: " << pool.inUse()
+              << " peak in use: " << pool.peakInUse() << " / " << pool.capacity() << std::endl;
+}
+
+int main(int, char* []) {
+    std::cout << "sizeof(BenchOrder): " << sizeof(BenchOrder) << std::endl;
+    runBenchmark<MemPoolMode::LINEAR_SCAN>("LINEAR_SCAN");
+    runBenchmark<MemPoolMode::FREE_LIST>("FREE_LIST");
+    runBenchmark<MemPoolMode::FREE_LIST>("FREE_LIST/HOT_PATH_MEMORY", HOT_PATH_MEMORY);
+    return 0;
+}
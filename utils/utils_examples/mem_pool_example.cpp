@@ -1,3 +1,4 @@
+#include <sys/wait.h>
 #include "mem_pool.h"
 
 struct CustomStruct {
@@ -25,5 +26,25 @@ int main(int, char** ) {
             struct_pool.deallocate(s_ret); 
         }
     }
+
+    // a double deallocate, a pointer from outside the pool and one into the middle of a block must all be FATAL
+    auto expectFatal = [](const char* what, auto&& fn) {
+        const auto pid = fork();
+        ASSERT(pid >= 0, "fork() failed");
+        if (pid == 0) {
+            fn();
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_FAILURE, std::string(what) + " was not caught");
+        std::cout << what << " caught" << std::endl;
+    };
+    const auto s_ret = struct_pool.allocate(CustomStruct{1, 2, 3});
+    struct_pool.deallocate(s_ret);
+    expectFatal("double deallocate", [&] { struct_pool.deallocate(s_ret); });
+    CustomStruct outside{};
+    expectFatal("foreign deallocate", [&] { struct_pool.deallocate(&outside); });
+    expectFatal("misaligned deallocate", [&] { struct_pool.deallocate(reinterpret_cast<const CustomStruct *>(&s_ret->d_[1])); });
     return 0; 
 }
\ No newline at end of file
@@ -0,0 +1,220 @@
+#pragma once
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <cctype>
+#include <cstdlib>
+#include <new>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <linux/mman.h>
+#include <sys/syscall.h>
+#include "macros.h"
+
+namespace Common {
+    enum class PageSize : uint8_t {
+        DEFAULT = 0,
+        HUGE_2MB = 1,
+        HUGE_1GB = 2
+    };
+
+    // mlock() so the pages are never swapped out
+    enum class MemoryLock : uint8_t {
+        NONE = 0,
+        BEST_EFFORT = 1, // a failed mlock() only warns, e.g. RLIMIT_MEMLOCK too low on a dev box, unless requireMemoryLock()
+        REQUIRED = 2 // a failed mlock() is FATAL
+    };
+
+    // Process-wide opt-in that turns every BEST_EFFORT lock into a REQUIRED one, for a production box where
+    // RLIMIT_MEMLOCK has been raised and running with swappable hot-path memory is worse than not starting.
+    // Set from main() before any component is constructed.
+    inline std::atomic<bool> memory_lock_required = false;
+
+    inline auto requireMemoryLock(bool required = true) noexcept {
+        memory_lock_required.store(required, std::memory_order_relaxed);
+    }
+
+    constexpr int NUMA_NODE_ANY = -1; // no binding
+    constexpr int NUMA_NODE_LOCAL = -2; // node of the owner thread's core, resolved by onCore(); binds nothing if left unresolved
+
+    // How a large structure is backed. The default is plain heap memory, i.e. what the structure used before.
+    struct MemoryConfig {
+        PageSize page_size_ = PageSize::DEFAULT;
+        MemoryLock lock_ = MemoryLock::NONE;
+        bool prefault_ = false; // touch every page at allocation instead of on first use
+        int numa_node_ = NUMA_NODE_ANY;
+
+        constexpr auto isDefault() const noexcept {
+            return page_size_ == PageSize::DEFAULT && lock_ == MemoryLock::NONE && !prefault_ && numa_node_ == NUMA_NODE_ANY;
+        }
+
+        constexpr auto operator==(const MemoryConfig&) const noexcept -> bool = default;
+    };
+
+    // For structures touched on every order: 2MB pages, locked, prefaulted, on the owner thread's node. The lock is
+    // best effort since these add up to hundreds of MB per process, far over the default RLIMIT_MEMLOCK of a
+    // non-root user; requireMemoryLock() makes it strict.
+    constexpr MemoryConfig HOT_PATH_MEMORY = {PageSize::HUGE_2MB, MemoryLock::BEST_EFFORT, true, NUMA_NODE_LOCAL};
+
+    // Same placement as config, but neither locked nor prefaulted: for large tables indexed by id, where most pages
+    // are never touched and committing all of them up front would only pin memory.
+    constexpr auto sparseTable(MemoryConfig config) noexcept {
+        config.lock_ = MemoryLock::NONE;
+        config.prefault_ = false;
+        return config;
+    }
+
+    // NUMA node of a cpu from sysfs (the cpuN directory holds a nodeK link), NUMA_NODE_ANY if unknown.
+    inline auto numaNodeOfCore(int core_id) noexcept {
+        int numa_node = NUMA_NODE_ANY;
+        if (core_id < 0) return numa_node;
+        auto dir = opendir(("/sys/devices/system/cpu/cpu" + std::to_string(core_id)).c_str());
+        if (!dir) return numa_node;
+        while (auto entry = readdir(dir)) {
+            if (std::strncmp(entry->d_name, "node", 4) == 0 && std::isdigit(static_cast<unsigned char>(entry->d_name[4]))) {
+                numa_node = std::atoi(entry->d_name + 4);
+                break;
+            }
+        }
+        closedir(dir);
+        return numa_node;
+    }
+
+    // Resolves NUMA_NODE_LOCAL to the node of core_id, the core the owning thread will be pinned to. The structure
+    // is usually built on another thread before its owner starts, so the allocating thread's node says nothing.
+    // An unpinned owner (core_id -1) can run anywhere, the structure is then left unbound.
+    inline auto onCore(MemoryConfig config, int core_id) noexcept {
+        if (config.numa_node_ == NUMA_NODE_LOCAL)
+            config.numa_node_ = numaNodeOfCore(core_id);
+        return config;
+    }
+
+    inline auto pageBytes(PageSize page_size) noexcept -> size_t {
+        switch (page_size) {
+            case PageSize::HUGE_2MB: return 2 * 1024 * 1024;
+            case PageSize::HUGE_1GB: return 1024 * 1024 * 1024;
+            case PageSize::DEFAULT: break;
+        }
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    // Bytes actually mapped for a request, the same value has to be passed to munmap()
+    inline auto mappedBytes(size_t bytes, const MemoryConfig& config) noexcept {
+        const auto page = pageBytes(config.page_size_);
+        return (bytes + page - 1) / page * page;
+    }
+
+    // Raw syscall rather than libnuma so that nothing extra has to be linked
+    inline auto bindToNumaNode(void* addr, size_t bytes, int numa_node) noexcept {
+        constexpr int MPOL_BIND_MODE = 2;
+        unsigned long node_mask = 1UL << numa_node;
+        return syscall(SYS_mbind, addr, bytes, MPOL_BIND_MODE, &node_mask, sizeof(node_mask) * 8, 0) == 0;
+    }
+
+    // Maps memory according to config. Huge pages fall back to regular pages (with a THP hint) when none are
+    // reserved and a failed mbind() only warns, so a misconfigured box still runs, just slower. A failed mlock()
+    // warns or is FATAL as config.lock_ and requireMemoryLock() say.
+    inline auto allocateBacking(size_t bytes, const MemoryConfig& config) noexcept -> void* {
+        if (config.isDefault())
+            return ::operator new(bytes);
+
+        const auto len = mappedBytes(bytes, config);
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        if (config.page_size_ != PageSize::DEFAULT)
+            flags |= MAP_HUGETLB | (config.page_size_ == PageSize::HUGE_1GB ? MAP_HUGE_1GB : MAP_HUGE_2MB);
+
+        auto addr = mmap(nullptr, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (addr == MAP_FAILED && config.page_size_ != PageSize::DEFAULT) {
+            std::cerr << "allocateBacking() no huge pages available for " << len << " bytes, using regular pages." << std::endl;
+            addr = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (addr != MAP_FAILED)
+                madvise(addr, len, MADV_HUGEPAGE);
+        }
+        ASSERT(addr != MAP_FAILED, "mmap() failed for " + std::to_string(len) + " bytes error: " + std::string(std::strerror(errno)));
+
+        // binding has to happen before the first touch, which mlock() and prefault_ both are
+        if (config.numa_node_ >= 0 && !bindToNumaNode(addr, len, config.numa_node_))
+            std::cerr << "allocateBacking() mbind() to node " << config.numa_node_ << " failed error: " << std::strerror(errno) << std::endl;
+        if (config.lock_ != MemoryLock::NONE && mlock(addr, len) != 0) {
+            const auto error = "allocateBacking() mlock() failed for " + std::to_string(len) + " bytes error: " + std::string(std::strerror(errno));
+            if (config.lock_ == MemoryLock::REQUIRED || memory_lock_required.load(std::memory_order_relaxed))
+                FATAL(error);
+            std::cerr << error << std::endl;
+        }
+        if (config.prefault_) {
+            const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            for (size_t i = 0; i < len; i += page)
+                static_cast<volatile char *>(addr)[i] = 0;
+        }
+        return addr;
+    }
+
+    inline auto freeBacking(void* ptr, size_t bytes, const MemoryConfig& config) noexcept {
+        if (!ptr) return;
+        if (config.isDefault()) {
+            ::operator delete(ptr);
+            return;
+        }
+        munmap(ptr, mappedBytes(bytes, config));
+    }
+
+    // std allocator over allocateBacking(), so std::vector based structures (MemPool) can be placed per config.
+    template<typename T>
+    class BackingAllocator {
+    public:
+        using value_type = T;
+
+        BackingAllocator() noexcept = default;
+        explicit BackingAllocator(const MemoryConfig& config) noexcept : config_(config) {}
+        template<typename U>
+        BackingAllocator(const BackingAllocator<U>& other) noexcept : config_(other.config()) {}
+
+        auto allocate(size_t n) -> T* {
+            return static_cast<T *>(allocateBacking(n * sizeof(T), config_));
+        }
+
+        auto deallocate(T* ptr, size_t n) noexcept {
+            freeBacking(ptr, n * sizeof(T), config_);
+        }
+
+        auto config() const noexcept -> const MemoryConfig& { return config_; }
+
+        template<typename U>
+        auto operator==(const BackingAllocator<U>& other) const noexcept { return config_ == other.config(); }
+
+    private:
+        MemoryConfig config_;
+    };
+
+    // Owns a single (large) T, e.g. a std::array hash map, living in memory placed per config.
+    template<typename T>
+    class BackedObject final {
+    public:
+        explicit BackedObject(const MemoryConfig& config = {}) : config_(config) {
+            object_ = new(allocateBacking(sizeof(T), config_)) T(); // value-initialized, hash maps start out all nullptr
+        }
+
+        ~BackedObject() {
+            object_->~T();
+            freeBacking(object_, sizeof(T), config_);
+            object_ = nullptr;
+        }
+
+        BackedObject(const BackedObject&) = delete;
+        BackedObject(const BackedObject&&) = delete;
+        BackedObject& operator=(const BackedObject&) = delete;
+        BackedObject& operator=(const BackedObject&&) = delete;
+
+        auto operator->() noexcept -> T* { return object_; }
+        auto operator->() const noexcept -> const T* { return object_; }
+        auto operator*() noexcept -> T& { return *object_; }
+        auto operator*() const noexcept -> const T& { return *object_; }
+
+    private:
+        const MemoryConfig config_;
+        T* object_ = nullptr;
+    };
+}
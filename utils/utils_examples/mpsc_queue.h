@@ -0,0 +1,94 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include "macros.h"
+
+namespace Common {
+    // Multi-producer single-consumer ring for fan-in paths (several order server readers or trade engines
+    // into one matching engine, several components into one log writer).
+    // Every slot carries a sequence number: a producer claims a position with one fetch_add on the write index,
+    // waits until the slot's sequence says it was released, fills it and publishes by bumping the sequence.
+    // The consumer owns the read index and only ever checks/stores slot sequences, so it never loops on a CAS.
+    template <typename T>
+    class MPSCQueue final {
+    private:
+        struct Slot {
+            T object_;
+            std::atomic<size_t> sequence_ = {0};
+        };
+
+        // Read-only after construction, shared by all threads
+        alignas(CACHE_LINE_SIZE) std::vector<Slot> store_;
+        size_t mask_ = 0;
+
+        // Contended by the producers
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> next_write_index_ = {0};
+
+        // Owned by the consumer, atomic only so that size() can be read from other threads
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> next_read_index_ = {0};
+
+        static constexpr auto roundUpToPowerOfTwo(size_t n) noexcept {
+            size_t capacity = 1;
+            while (capacity < n) capacity <<= 1;
+            return capacity;
+        }
+
+    public:
+        MPSCQueue(std::size_t num_elems) : store_(roundUpToPowerOfTwo(num_elems)), /*vector storage pre-allocation*/
+            mask_(store_.size() - 1) {
+            ASSERT(reinterpret_cast<const Slot *>(&(store_[0].object_)) == &(store_[0]),
+                "T object should be first member of Slot.");
+            for (size_t i = 0; i < store_.size(); ++i)
+                store_[i].sequence_.store(i, std::memory_order_relaxed); // slot i is free for position i
+        }
+
+        MPSCQueue() = delete;
+        MPSCQueue(const MPSCQueue&) = delete;
+        MPSCQueue(const MPSCQueue&&) = delete;
+        MPSCQueue& operator=(const MPSCQueue&) = delete;
+        MPSCQueue& operator=(const MPSCQueue&&) = delete;
+
+        // Claims the next slot for the calling producer, spinning while the ring is full (back-pressure).
+        // The slot stays invisible to the consumer until updateWriteIndex() is called with the returned pointer.
+        auto getNextToWriteTo() noexcept -> T* {
+            const auto write_index = next_write_index_.fetch_add(1, std::memory_order_relaxed);
+            auto& slot = store_[write_index & mask_];
+            while (UNLIKELY(slot.sequence_.load(std::memory_order_acquire) != write_index));
+            return &slot.object_;
+        }
+
+        // Publishes the slot returned by getNextToWriteTo(). Producers may publish out of order,
+        // the consumer still sees elements in claim order.
+        auto updateWriteIndex(T* elem) noexcept {
+            auto slot = reinterpret_cast<Slot *>(elem);
+            slot->sequence_.store(slot->sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        auto getNextToRead() const noexcept -> const T* {
+            const auto read_index = next_read_index_.load(std::memory_order_relaxed);
+            const auto& slot = store_[read_index & mask_];
+            return (slot.sequence_.load(std::memory_order_acquire) == read_index + 1) ? &slot.object_ : nullptr;
+        }
+
+        auto updateReadIndex() noexcept {
+            const auto read_index = next_read_index_.load(std::memory_order_relaxed);
+            auto& slot = store_[read_index & mask_];
+            if (UNLIKELY(slot.sequence_.load(std::memory_order_relaxed) != read_index + 1)) {
+                FATAL("Read an invalid element in: " + std::to_string(pthread_self()));
+            }
+            slot.sequence_.store(read_index + store_.size(), std::memory_order_release); // free for the next lap
+            next_read_index_.store(read_index + 1, std::memory_order_relaxed);
+        }
+
+        // Includes slots that are claimed but not yet published
+        auto size() const noexcept {
+            const auto read_index = next_read_index_.load(std::memory_order_acquire); // read first so the difference cannot underflow
+            return next_write_index_.load(std::memory_order_acquire) - read_index;
+        }
+
+        auto capacity() const noexcept {
+            return store_.size();
+        }
+    };
+}
@@ -0,0 +1,76 @@
+#include <array>
+#include <chrono>
+#include "thread_utils.h"
+#include "mpsc_queue.h"
+
+// Contention benchmark for MPSCQueue: 1, 2, 4 and 8 producers feeding one consumer.
+// Optional argv[1] is the first core to pin to: the consumer takes it, producers take the following ones.
+
+struct BenchMsg {
+    size_t producer_;
+    size_t seq_;
+    char payload_[32];
+};
+
+using namespace Common;
+
+constexpr size_t QUEUE_SIZE = 64 * 1024;
+constexpr size_t NUM_MESSAGES = 4 * 1000 * 1000;
+constexpr size_t MAX_PRODUCERS = 8;
+
+auto produceFunction(MPSCQueue<BenchMsg>* q, size_t producer, size_t num_messages, std::atomic<bool>* go) {
+    while (!go->load(std::memory_order_acquire));
+    for (size_t i = 0; i < num_messages; ++i) {
+        auto next_write = q->getNextToWriteTo();
+        next_write->producer_ = producer;
+        next_write->seq_ = i;
+        q->updateWriteIndex(next_write);
+    }
+}
+
+auto consumeFunction(MPSCQueue<BenchMsg>* q, size_t num_producers) {
+    std::array<size_t, MAX_PRODUCERS> expected{};
+    for (size_t n = 0; n < NUM_MESSAGES;) {
+        const auto msg = q->getNextToRead();
+        if (!msg) continue;
+        // per-producer FIFO must hold even though producers interleave
+        if (UNLIKELY(msg->producer_ >= num_producers || msg->seq_ != expected[msg->producer_]))
+            FATAL("Out of order element from producer: " + std::to_string(msg->producer_));
+        ++expected[msg->producer_];
+        q->updateReadIndex();
+        ++n;
+    }
+}
+
+auto runBenchmark(size_t num_producers, int first_core) {
+    MPSCQueue<BenchMsg> q(QUEUE_SIZE);
+    std::atomic<bool> go = {false};
+    const auto per_producer = NUM_MESSAGES / num_producers;
+
+    auto ct = createAndStartThread(first_core, "Consumer", consumeFunction, &q, num_producers);
+    std::vector<std::thread*> producers;
+    for (size_t i = 0; i < num_producers; ++i)
+        producers.push_back(createAndStartThread(first_core >= 0 ? first_core + 1 + static_cast<int>(i) : -1,
+                                                 "Producer-" + std::to_string(i), produceFunction, &q, i, per_producer, &go));
+
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto t : producers) {
+        t->join();
+        delete t;
+    }
+    ct->join();
+    delete ct;
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << num_producers << " producer(s): " << NUM_MESSAGES << " msgs in " << elapsed / 1000000 << " ms, "
+              << static_cast<double>(elapsed) / NUM_MESSAGES << " ns/msg" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    const int first_core = (argc > 1 ? atoi(argv[1]) : -1);
+
+    for (size_t num_producers = 1; num_producers <= MAX_PRODUCERS; num_producers *= 2)
+        runBenchmark(num_producers, first_core);
+    return 0;
+}
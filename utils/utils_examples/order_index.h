@@ -0,0 +1,102 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "macros.h"
+#include "memory_backing.h"
+
+namespace Common {
+    /// Live orders by a 64-bit key, in an open-addressing table of {key, pointer} slots sized once for the maximum
+    /// number of live entries (at most half full). Linear probing keeps a lookup to one or two cache lines, and
+    /// erase() shifts the rest of the probe run back into the hole instead of leaving a tombstone, so probe lengths
+    /// depend only on the live entries however many inserts and erases came before. A slot with a null value is free.
+    template<typename T>
+    class OrderIndex final {
+    public:
+        explicit OrderIndex(size_t max_entries, const MemoryConfig& memory_config = {}) :
+            max_entries_(max_entries), shift_(64 - log2Capacity(max_entries)), mask_((1ULL << (64 - shift_)) - 1),
+            slots_(mask_ + 1, Slot{}, BackingAllocator<Slot>(memory_config)) {}
+
+        auto size() const noexcept { return size_; }
+        auto capacity() const noexcept { return slots_.size(); }
+
+        auto find(uint64_t key) const noexcept -> T* {
+            for (auto idx = home(key);; idx = (idx + 1) & mask_) {
+                const auto &slot = slots_[idx];
+                if (!slot.value_ || slot.key_ == key) return slot.value_;
+            }
+        }
+
+        // Replaces the value if key is present.
+        auto insert(uint64_t key, T* value) noexcept {
+            auto idx = home(key);
+            while (slots_[idx].value_ && slots_[idx].key_ != key)
+                idx = (idx + 1) & mask_;
+            if (!slots_[idx].value_) {
+                ASSERT(size_ < max_entries_, "OrderIndex full at " + std::to_string(size_) + " entries.");
+                ++size_;
+            }
+            slots_[idx] = {key, value};
+        }
+
+        auto erase(uint64_t key) noexcept -> bool {
+            auto hole = home(key);
+            while (slots_[hole].value_ && slots_[hole].key_ != key)
+                hole = (hole + 1) & mask_;
+            if (!slots_[hole].value_) return false;
+
+            // backward shift: every later entry of the run that may sit at or before the hole moves into it
+            for (auto idx = (hole + 1) & mask_; slots_[idx].value_; idx = (idx + 1) & mask_) {
+                if (((idx - home(slots_[idx].key_)) & mask_) >= ((idx - hole) & mask_)) {
+                    slots_[hole] = slots_[idx];
+                    hole = idx;
+                }
+            }
+            slots_[hole] = {};
+            --size_;
+            return true;
+        }
+
+        // Longest probe run from a key's home slot to its entry, for benchmarks.
+        auto maxProbeLength() const noexcept {
+            size_t max_probe = 0;
+            for (size_t idx = 0; idx < slots_.size(); ++idx) {
+                if (slots_[idx].value_)
+                    max_probe = std::max<size_t>(max_probe, ((idx - home(slots_[idx].key_)) & mask_) + 1);
+            }
+            return max_probe;
+        }
+
+        OrderIndex() = delete;
+        OrderIndex(const OrderIndex&) = delete;
+        OrderIndex(const OrderIndex&&) = delete;
+        OrderIndex& operator=(const OrderIndex&) = delete;
+        OrderIndex& operator=(const OrderIndex&&) = delete;
+
+    private:
+        struct Slot {
+            uint64_t key_ = 0;
+            T* value_ = nullptr;
+        };
+
+        const size_t max_entries_;
+        const unsigned shift_;
+        const uint64_t mask_;
+        size_t size_ = 0;
+        std::vector<Slot, BackingAllocator<Slot>> slots_;
+
+        // Smallest power of two holding max_entries at a load factor of at most 1/2.
+        static auto log2Capacity(size_t max_entries) noexcept -> unsigned {
+            unsigned bits = 1;
+            while ((1ULL << bits) < 2 * max_entries) ++bits;
+            return bits;
+        }
+
+        // Fibonacci hashing: sequential order ids of one client land far apart, the top bits pick the slot.
+        auto home(uint64_t key) const noexcept -> uint64_t {
+            return (key * 0x9E3779B97F4A7C15ULL) >> shift_;
+        }
+    };
+}
@@ -0,0 +1,124 @@
+#include <random>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <unordered_map>
+#include "order_index.h"
+#include "time_utils.h"
+
+// MEOrderBook's (client id, client order id) index under cancel churn: NUM_LIVE orders rest, then every step cancels
+// a random one, looks up another and adds a new order with the next id of a random client. The same seeded sequence
+// runs once on OrderIndex and once on a std::unordered_map, each timed on its own: every lookup must return the same
+// order in both runs, and OrderIndex's longest probe run must stay short however long the churn goes on.
+
+using namespace Common;
+
+struct BenchOrder {
+    uint64_t key_ = 0;
+};
+
+constexpr size_t MAX_ORDERS = 1024 * 1024; // ME_MAX_ORDER_IDS
+constexpr size_t NUM_LIVE = MAX_ORDERS / 2;
+constexpr size_t NUM_CLIENTS = 256; // ME_MAX_NUM_CLIENTS
+constexpr size_t NUM_CHURN = 5 * 1000 * 1000;
+
+auto clientOrderKey(uint64_t client_id, uint64_t client_order_id) noexcept -> uint64_t {
+    return (client_id << 48) | client_order_id;
+}
+
+// The baseline behind OrderIndex's interface.
+class UnorderedMapIndex final {
+public:
+    explicit UnorderedMapIndex(size_t max_entries) {
+        map_.reserve(max_entries);
+    }
+
+    auto find(uint64_t key) const noexcept -> BenchOrder* {
+        const auto itr = map_.find(key);
+        return (itr == map_.end() ? nullptr : itr->second);
+    }
+
+    auto insert(uint64_t key, BenchOrder* value) noexcept {
+        map_.emplace(key, value);
+    }
+
+    auto erase(uint64_t key) noexcept -> bool {
+        return map_.erase(key) != 0;
+    }
+
+private:
+    std::unordered_map<uint64_t, BenchOrder*> map_;
+};
+
+// Fills index untimed, then times each operation of the churn. found gets the position in the order pool of what
+// every lookup returned, -1 for none, for the two runs to be compared.
+template<typename Index>
+auto churn(Index& index, const std::string& name, std::vector<int64_t>& found) {
+    std::vector<BenchOrder> orders(MAX_ORDERS);
+    std::vector<BenchOrder*> free_orders, live_orders;
+    for (auto &order : orders) free_orders.push_back(&order);
+    std::vector<uint64_t> next_order_id(NUM_CLIENTS, 1);
+    std::mt19937_64 rng(42);
+    found.clear();
+    found.reserve(NUM_CHURN);
+
+    uint64_t insert_ticks = 0, erase_ticks = 0, find_ticks = 0;
+    auto addOrder = [&]() {
+        const auto client_id = rng() % NUM_CLIENTS;
+        auto order = free_orders.back();
+        free_orders.pop_back();
+        order->key_ = clientOrderKey(client_id, next_order_id[client_id]++);
+        live_orders.push_back(order);
+        const auto start = rdtsc();
+        index.insert(order->key_, order);
+        insert_ticks += rdtsc() - start;
+    };
+
+    for (size_t i = 0; i < NUM_LIVE; ++i) addOrder();
+    insert_ticks = 0; // only the churn is timed
+
+    for (size_t i = 0; i < NUM_CHURN; ++i) {
+        const auto idx = rng() % live_orders.size();
+        auto order = live_orders[idx];
+        live_orders[idx] = live_orders.back();
+        live_orders.pop_back();
+        auto start = rdtsc();
+        const auto erased = index.erase(order->key_);
+        erase_ticks += rdtsc() - start;
+        ASSERT(erased, name + ": erase of a live order failed");
+        free_orders.push_back(order);
+
+        // half the lookups are of orders gone already, like cancels of filled orders
+        const auto key = (i & 1 ? live_orders[rng() % live_orders.size()]->key_ : order->key_);
+        start = rdtsc();
+        const auto result = index.find(key);
+        find_ticks += rdtsc() - start;
+        found.push_back(result ? result - orders.data() : -1);
+
+        addOrder();
+    }
+
+    const auto ns_per_tick = TscClock::instance().nsPerTick();
+    std::cout << name << " after " << NUM_CHURN << " cancel/add pairs: "
+              << "insert " << static_cast<double>(insert_ticks) * ns_per_tick / NUM_CHURN
+              << " ns, erase " << static_cast<double>(erase_ticks) * ns_per_tick / NUM_CHURN
+              << " ns, find " << static_cast<double>(find_ticks) * ns_per_tick / NUM_CHURN << " ns" << std::endl;
+}
+
+int main(int, char* []) {
+    std::vector<int64_t> index_found, map_found;
+    {
+        OrderIndex<BenchOrder> index(MAX_ORDERS);
+        churn(index, "OrderIndex", index_found);
+        std::cout << index.size() << " orders in " << index.capacity() << " slots ("
+                  << index.capacity() * 16 / (1024 * 1024) << " MiB), max probe " << index.maxProbeLength() << std::endl;
+    }
+    {
+        UnorderedMapIndex map(MAX_ORDERS);
+        churn(map, "std::unordered_map", map_found);
+    }
+
+    for (size_t i = 0; i < NUM_CHURN; ++i)
+        ASSERT(index_found[i] == map_found[i], "lookup " + std::to_string(i) + " disagrees with std::unordered_map");
+    return 0;
+}
@@ -0,0 +1,268 @@
+#pragma once
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <iostream>
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "macros.h"
+
+// Build with -DPERF_COUNTERS_ENABLED=1 to read the hardware counters around every START_MEASURE/END_MEASURE section.
+// Otherwise nothing below is referenced by the measurement macros and they cost exactly what they did before.
+#ifndef PERF_COUNTERS_ENABLED
+#define PERF_COUNTERS_ENABLED 0
+#endif
+
+namespace Common {
+    // Counted in user space only, by the thread that opened them.
+    enum class PerfCounter : uint8_t {
+        INSTRUCTIONS = 0,
+        CYCLES = 1,
+        L1D_MISSES = 2,
+        LLC_MISSES = 3,
+        BRANCH_MISSES = 4,
+        DTLB_MISSES = 5,
+        MAX = 6
+    };
+    constexpr size_t PERF_COUNTER_COUNT = static_cast<size_t>(PerfCounter::MAX);
+
+    inline auto perfCounterToString(PerfCounter counter) -> std::string {
+        switch (counter) {
+            case PerfCounter::INSTRUCTIONS: return "instructions";
+            case PerfCounter::CYCLES: return "cycles";
+            case PerfCounter::L1D_MISSES: return "l1d_misses";
+            case PerfCounter::LLC_MISSES: return "llc_misses";
+            case PerfCounter::BRANCH_MISSES: return "branch_misses";
+            case PerfCounter::DTLB_MISSES: return "dtlb_misses";
+            case PerfCounter::MAX: break;
+        }
+        return "UNKNOWN";
+    }
+
+    /// Counter values plus the group's enabled and running times (ns). The kernel multiplexes a group that does not fit
+    /// on the PMU next to the other events of the cpu: while it is off, time_running_ stops and so do the counts.
+    struct PerfCounterValues {
+        std::array<uint64_t, PERF_COUNTER_COUNT> counts_{};
+        uint64_t time_enabled_ = 0;
+        uint64_t time_running_ = 0;
+    };
+
+    /// One group of counters per thread, opened with perf_event_open on first use and read with rdpmc, so a read is
+    /// a few dozen cycles per counter and no system call. When the kernel refuses the group (perf_event_paranoid,
+    /// no PMU in a VM), available() is false, read() returns zeros and nothing is recorded for the thread.
+    class PerfCounterGroup final {
+    public:
+        static auto forThisThread() noexcept -> PerfCounterGroup& {
+            thread_local PerfCounterGroup group;
+            return group;
+        }
+
+        auto available() const noexcept { return available_; }
+
+        auto read(PerfCounterValues& values) const noexcept {
+            for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+                values.counts_[i] = (LIKELY(pages_[i]) ? readCounter(pages_[i]) : 0);
+            if (LIKELY(pages_[0]))
+                readTimes(pages_[0], values.time_enabled_, values.time_running_);
+        }
+
+        /// Totals since the group was opened, through read() on the leader (PERF_FORMAT_GROUP with both total times):
+        /// the same values the rdpmc path computes, for a cross-check or an end of run summary. False if unavailable.
+        auto readTotals(PerfCounterValues& values) const noexcept {
+            if (!available_) return false;
+            struct {
+                uint64_t nr_;
+                uint64_t time_enabled_;
+                uint64_t time_running_;
+                uint64_t counts_[PERF_COUNTER_COUNT];
+            } group_read;
+            if (::read(fds_[0], &group_read, sizeof(group_read)) != static_cast<ssize_t>(sizeof(group_read)) || group_read.nr_ != PERF_COUNTER_COUNT)
+                return false;
+            std::copy(std::begin(group_read.counts_), std::end(group_read.counts_), values.counts_.begin());
+            values.time_enabled_ = group_read.time_enabled_;
+            values.time_running_ = group_read.time_running_;
+            return true;
+        }
+
+        ~PerfCounterGroup() {
+            for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+                if (pages_[i]) munmap(pages_[i], page_size_);
+                if (fds_[i] != -1) close(fds_[i]);
+            }
+        }
+
+        PerfCounterGroup(const PerfCounterGroup&) = delete;
+        PerfCounterGroup(const PerfCounterGroup&&) = delete;
+        PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+        PerfCounterGroup& operator=(const PerfCounterGroup&&) = delete;
+
+    private:
+        std::array<int, PERF_COUNTER_COUNT> fds_;
+        std::array<perf_event_mmap_page*, PERF_COUNTER_COUNT> pages_{};
+        const size_t page_size_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        bool available_ = false;
+
+        static constexpr uint64_t cacheEvent(uint64_t cache, uint64_t result) noexcept {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+        }
+
+        PerfCounterGroup() {
+            fds_.fill(-1);
+            const std::pair<uint32_t, uint64_t> events[PERF_COUNTER_COUNT] = {
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                {PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+                {PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+                {PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_MISS)}
+            };
+            for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+                perf_event_attr attr;
+                memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = events[i].first;
+                attr.config = events[i].second;
+                attr.disabled = (i == 0); // the leader starts the whole group once every member is in
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                // one group, so all the counters are scheduled on the PMU together or not at all
+                fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, (i == 0 ? -1 : fds_[0]), 0));
+                if (fds_[i] == -1) {
+                    std::cerr << "perf_event_open failed for " << perfCounterToString(static_cast<PerfCounter>(i))
+                              << ": " << strerror(errno) << ", hardware counters disabled on this thread" << std::endl;
+                    return;
+                }
+                auto page = mmap(nullptr, page_size_, PROT_READ, MAP_SHARED, fds_[i], 0);
+                if (page == MAP_FAILED) return;
+                pages_[i] = static_cast<perf_event_mmap_page*>(page);
+                if (!pages_[i]->cap_user_rdpmc) {
+                    std::cerr << "rdpmc not permitted (see /sys/bus/event_source/devices/cpu/rdpmc), hardware counters disabled on this thread" << std::endl;
+                    return;
+                }
+            }
+            ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            available_ = true;
+        }
+
+        // The seqlock protocol from linux/perf_event.h: the kernel bumps lock around updating index and offset.
+        static auto readCounter(const volatile perf_event_mmap_page* page) noexcept -> uint64_t {
+            uint32_t seq;
+            uint64_t count;
+            do {
+                seq = page->lock;
+                std::atomic_signal_fence(std::memory_order_acquire);
+                const auto index = page->index;
+                count = static_cast<uint64_t>(page->offset);
+                if (LIKELY(page->cap_user_rdpmc && index)) { // index 0: the group is not on the PMU right now
+                    const auto shift = 64 - page->pmc_width;
+                    count += static_cast<uint64_t>(static_cast<int64_t>(__builtin_ia32_rdpmc(static_cast<int>(index - 1)) << shift) >> shift);
+                }
+                std::atomic_signal_fence(std::memory_order_acquire);
+            } while (UNLIKELY(page->lock != seq));
+            return count;
+        }
+
+        // Same protocol: the page holds both times as of the last context switch, extended to now from the TSC when the
+        // group has been enabled but not running since (time_running_ only moves on while the group is on the PMU).
+        static auto readTimes(const volatile perf_event_mmap_page* page, uint64_t& time_enabled, uint64_t& time_running) noexcept -> void {
+            uint32_t seq;
+            uint64_t tsc = 0, time_offset = 0;
+            uint32_t time_mult = 0, index = 0;
+            uint16_t time_shift = 0;
+            do {
+                seq = page->lock;
+                std::atomic_signal_fence(std::memory_order_acquire);
+                time_enabled = page->time_enabled;
+                time_running = page->time_running;
+                index = page->index;
+                if (LIKELY(page->cap_user_time)) {
+                    tsc = __builtin_ia32_rdtsc();
+                    time_offset = page->time_offset;
+                    time_mult = page->time_mult;
+                    time_shift = page->time_shift;
+                }
+                std::atomic_signal_fence(std::memory_order_acquire);
+            } while (UNLIKELY(page->lock != seq));
+
+            if (LIKELY(time_mult)) {
+                const auto quot = tsc >> time_shift;
+                const auto rem = tsc & ((1ULL << time_shift) - 1);
+                const auto delta = time_offset + quot * time_mult + ((rem * time_mult) >> time_shift);
+                time_enabled += delta;
+                if (index) // on the PMU right now, so running too
+                    time_running += delta;
+            }
+        }
+    };
+
+    // Raise value to at least candidate. The load is enough when candidate is not a new maximum, which is nearly
+    // always, so the CAS only runs on a new extreme and retries only against another writer's.
+    inline auto atomicFetchMax(std::atomic<uint64_t>& value, uint64_t candidate) noexcept {
+        auto current = value.load(std::memory_order_relaxed);
+        while (UNLIKELY(candidate > current) && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {}
+    }
+
+    inline auto atomicFetchMin(std::atomic<uint64_t>& value, uint64_t candidate) noexcept {
+        auto current = value.load(std::memory_order_relaxed);
+        while (UNLIKELY(candidate < current) && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {}
+    }
+
+    /// Sum and worst case of every counter over the sections of one tag. Like LatencyHistogram, record() may run on
+    /// several threads at once, e.g. every matching engine shard timing the same call site.
+    /// A section during which the group was off the PMU part of the time has its deltas scaled up by enabled / running,
+    /// as perf stat does, and is counted in scaled(). One during which it never ran has no counts at all: it is left out
+    /// of the stats and counted in unscheduled(), so a tag whose group cannot be scheduled shows up instead of reading 0.
+    class PerfCounterStats final {
+    public:
+        auto record(const PerfCounterValues& start, const PerfCounterValues& end) noexcept {
+            const auto time_enabled = end.time_enabled_ - start.time_enabled_;
+            const auto time_running = end.time_running_ - start.time_running_;
+            if (UNLIKELY(!time_running && time_enabled)) {
+                unscheduled_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            const auto is_scaled = (time_running < time_enabled);
+            if (UNLIKELY(is_scaled))
+                scaled_.fetch_add(1, std::memory_order_relaxed);
+            for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i) {
+                auto delta = end.counts_[i] - start.counts_[i];
+                if (UNLIKELY(is_scaled))
+                    delta = static_cast<uint64_t>(static_cast<double>(delta) * static_cast<double>(time_enabled) / static_cast<double>(time_running));
+                sums_[i].fetch_add(delta, std::memory_order_relaxed);
+                atomicFetchMax(max_[i], delta);
+            }
+            count_.fetch_add(1, std::memory_order_release);
+        }
+
+        auto count() const noexcept { return count_.load(std::memory_order_acquire); }
+
+        auto mean(PerfCounter counter) const noexcept {
+            const auto n = count();
+            return (n ? static_cast<double>(sums_[static_cast<size_t>(counter)].load(std::memory_order_relaxed)) / static_cast<double>(n) : 0.0);
+        }
+
+        auto max(PerfCounter counter) const noexcept {
+            return max_[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+        }
+
+        auto scaled() const noexcept { return scaled_.load(std::memory_order_relaxed); }
+        auto unscheduled() const noexcept { return unscheduled_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> count_ = {0};
+        std::atomic<uint64_t> scaled_ = {0};
+        std::atomic<uint64_t> unscheduled_ = {0};
+        std::array<std::atomic<uint64_t>, PERF_COUNTER_COUNT> sums_{};
+        std::array<std::atomic<uint64_t>, PERF_COUNTER_COUNT> max_{};
+    };
+}
@@ -0,0 +1,76 @@
+#define PERF_COUNTERS_ENABLED 1 // normally -DPERF_COUNTERS_ENABLED=1 for the whole build
+
+#include <random>
+#include <vector>
+#include <iostream>
+#include "latency_histogram.h"
+
+// Two sections with the same instruction count, one walking a buffer far larger
+// than the caches in random order and one walking it sequentially: the first should show the cache and dTLB misses.
+// Where the kernel gives no counters (a VM without a PMU, perf_event_paranoid), only the latency columns are filled.
+
+using namespace Common;
+
+constexpr size_t BUFFER_SIZE = 64 * 1024 * 1024 / sizeof(uint64_t);
+constexpr size_t NUM_LOADS = 1000;
+constexpr size_t NUM_SECTIONS = 10 * 1000;
+
+int main(int, char* []) {
+    std::vector<uint64_t> buffer(BUFFER_SIZE, 1);
+    std::mt19937_64 rng(42);
+    std::vector<size_t> random_offsets(NUM_LOADS * NUM_SECTIONS);
+    for (auto& offset : random_offsets) offset = rng() % BUFFER_SIZE;
+
+    uint64_t sum = 0;
+    for (size_t section = 0; section < NUM_SECTIONS; ++section) {
+        const auto offsets = &random_offsets[section * NUM_LOADS];
+        START_MEASURE(perf_counters_example_random);
+        for (size_t i = 0; i < NUM_LOADS; ++i) sum += buffer[offsets[i]];
+        END_MEASURE(perf_counters_example_random);
+
+        const auto base = (section * NUM_LOADS) % (BUFFER_SIZE - NUM_LOADS);
+        START_MEASURE(perf_counters_example_sequential);
+        for (size_t i = 0; i < NUM_LOADS; ++i) sum += buffer[base + i];
+        END_MEASURE(perf_counters_example_sequential);
+    }
+    std::cout << "sum: " << sum << std::endl;
+
+    const auto& group = PerfCounterGroup::forThisThread();
+    std::cout << "hardware counters " << (group.available() ? "available" : "unavailable") << std::endl;
+    for (const auto tag : {"perf_counters_example_random", "perf_counters_example_sequential"}) {
+        const auto& histogram = LatencyRegistry::instance().histogram(tag, LatencyKind::RDTSC);
+        const auto& perf_counters = histogram.perfCounters();
+        std::cout << tag << " sections: " << histogram.snapshot(1.0).count_ << " p50 ticks: " << histogram.snapshot(1.0).p50_;
+        for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+            std::cout << ' ' << perfCounterToString(static_cast<PerfCounter>(i)) << ": " << perf_counters.mean(static_cast<PerfCounter>(i));
+        std::cout << " scaled: " << perf_counters.scaled() << " unscheduled: " << perf_counters.unscheduled() << std::endl;
+        ASSERT(!group.available() || perf_counters.count() + perf_counters.unscheduled() == NUM_SECTIONS, "counter deltas not recorded");
+    }
+
+    // multiplexing, with made-up readings: counted half the time it was enabled, then not at all
+    PerfCounterStats stats;
+    PerfCounterValues start_values, end_values;
+    end_values.counts_.fill(100);
+    end_values.time_enabled_ = 1000;
+    end_values.time_running_ = 500;
+    stats.record(start_values, end_values);
+    end_values.time_running_ = 0;
+    stats.record(start_values, end_values);
+    ASSERT(stats.count() == 1 && stats.mean(PerfCounter::CYCLES) == 200.0 && stats.scaled() == 1 && stats.unscheduled() == 1,
+           "multiplexed sections not scaled / flagged");
+    std::cout << "multiplexed section scaled to " << stats.mean(PerfCounter::CYCLES) << " cycles, unscheduled one flagged" << std::endl;
+
+    // the whole run through read(): a group sharing the PMU with other events ran only part of the time it was enabled
+    PerfCounterValues values;
+    if (group.readTotals(values))
+        std::cout << "group on the PMU " << 100.0 * static_cast<double>(values.time_running_) / static_cast<double>(std::max<uint64_t>(values.time_enabled_, 1))
+                  << "% of the time it was enabled" << std::endl;
+
+    // rdpmc for every counter at both ends of an empty section
+    const auto start = rdtsc();
+    for (size_t i = 0; i < NUM_SECTIONS; ++i) group.read(values);
+    std::cout << "PerfCounterGroup::read: " << static_cast<double>(rdtsc() - start) / NUM_SECTIONS << " ticks" << std::endl;
+
+    LatencyRegistry::instance().startDumping("perf_counters_example.csv", 1000, -1);
+    return 0;
+}
@@ -0,0 +1,229 @@
+#pragma once
+#include <map>
+#include <array>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+
+#include "macros.h"
+
+namespace Common {
+    /// One side's price levels in a contiguous window of NUM_SLOTS ticks starting at base(): slot (price - base) holds
+    /// the level, a bit per slot marks it occupied and a summary bit per 64-slot word marks the word non-empty.
+    /// insert()/erase() are O(1), and the nearest occupied level above or below any price is found with at most two
+    /// tzcnt/lzcnt per bitmap level instead of a walk over the levels. Prices are Common::Price ticks, so the tick size is 1.
+    template<typename T, size_t NUM_SLOTS>
+    class PriceLadder final {
+    public:
+        static_assert(NUM_SLOTS && NUM_SLOTS % 64 == 0, "PriceLadder needs a multiple of 64 slots.");
+        static constexpr size_t NUM_WORDS = NUM_SLOTS / 64;
+        static constexpr size_t NUM_SUMMARY_WORDS = (NUM_WORDS + 63) / 64;
+        static constexpr size_t NONE = NUM_SLOTS;
+
+        PriceLadder() = default;
+
+        auto base() const noexcept { return base_; }
+        auto size() const noexcept { return size_; }
+        auto empty() const noexcept { return !size_; }
+
+        // Moves the window. Only while empty: occupied slots would change price.
+        auto rebase(int64_t base) noexcept {
+            ASSERT(empty(), "PriceLadder rebased while holding " + std::to_string(size_) + " levels.");
+            base_ = base;
+        }
+
+        // Forgets every level at once, without touching what the slots point to.
+        auto clear() noexcept {
+            summary_.fill(0);
+            words_.fill(0);
+            slots_.fill(nullptr);
+            size_ = 0;
+        }
+
+        auto contains(int64_t price) const noexcept {
+            return static_cast<uint64_t>(price - base_) < NUM_SLOTS;
+        }
+
+        // price must be contains()
+        auto at(int64_t price) const noexcept -> T* {
+            return slots_[index(price)];
+        }
+
+        auto insert(int64_t price, T* value) noexcept {
+            const auto idx = index(price);
+            ASSERT(!slots_[idx], "PriceLadder slot already occupied at price " + std::to_string(price));
+            slots_[idx] = value;
+            words_[idx >> 6] |= (1ULL << (idx & 63));
+            summary_[idx >> 12] |= (1ULL << ((idx >> 6) & 63));
+            ++size_;
+        }
+
+        auto erase(int64_t price) noexcept {
+            const auto idx = index(price);
+            slots_[idx] = nullptr;
+            words_[idx >> 6] &= ~(1ULL << (idx & 63));
+            if (!words_[idx >> 6])
+                summary_[idx >> 12] &= ~(1ULL << ((idx >> 6) & 63));
+            --size_;
+        }
+
+        // Occupied level with the lowest price above price, nullptr if there is none in the window.
+        auto higher(int64_t price) const noexcept -> T* {
+            if (price < base_) return lowest();
+            return slotOrNull(findFrom(static_cast<size_t>(price - base_) + 1));
+        }
+
+        // Occupied level with the highest price below price, nullptr if there is none in the window.
+        auto lower(int64_t price) const noexcept -> T* {
+            if (price <= base_) return nullptr;
+            return slotOrNull(findTo(std::min<size_t>(static_cast<size_t>(price - base_) - 1, NUM_SLOTS - 1)));
+        }
+
+        auto lowest() const noexcept -> T* { return slotOrNull(findFrom(0)); }
+        auto highest() const noexcept -> T* { return slotOrNull(findTo(NUM_SLOTS - 1)); }
+
+        PriceLadder(const PriceLadder&) = delete;
+        PriceLadder(const PriceLadder&&) = delete;
+        PriceLadder& operator=(const PriceLadder&) = delete;
+        PriceLadder& operator=(const PriceLadder&&) = delete;
+
+    private:
+        int64_t base_ = 0;
+        size_t size_ = 0;
+        std::array<uint64_t, NUM_SUMMARY_WORDS> summary_{};
+        std::array<uint64_t, NUM_WORDS> words_{};
+        std::array<T*, NUM_SLOTS> slots_{};
+
+        auto index(int64_t price) const noexcept {
+            return static_cast<size_t>(price - base_);
+        }
+
+        auto slotOrNull(size_t idx) const noexcept -> T* {
+            return (idx == NONE ? nullptr : slots_[idx]);
+        }
+
+        // First occupied slot at or after first.
+        auto findFrom(size_t first) const noexcept -> size_t {
+            if (first >= NUM_SLOTS) return NONE;
+            const auto word = first >> 6;
+            const auto bits = words_[word] & (~0ULL << (first & 63));
+            if (bits) return (word << 6) + __builtin_ctzll(bits);
+
+            const auto next_word = word + 1;
+            if (next_word >= NUM_WORDS) return NONE;
+            auto summary_word = next_word >> 6;
+            auto summary_bits = summary_[summary_word] & (~0ULL << (next_word & 63));
+            while (!summary_bits) {
+                if (++summary_word >= NUM_SUMMARY_WORDS) return NONE;
+                summary_bits = summary_[summary_word];
+            }
+            const auto found_word = (summary_word << 6) + __builtin_ctzll(summary_bits);
+            return (found_word << 6) + __builtin_ctzll(words_[found_word]);
+        }
+
+        // Last occupied slot at or before last, last < NUM_SLOTS.
+        auto findTo(size_t last) const noexcept -> size_t {
+            const auto word = last >> 6;
+            const auto bits = words_[word] & (~0ULL >> (63 - (last & 63)));
+            if (bits) return (word << 6) + 63 - __builtin_clzll(bits);
+
+            if (!word) return NONE;
+            const auto prev_word = word - 1;
+            auto summary_word = prev_word >> 6;
+            auto summary_bits = summary_[summary_word] & (~0ULL >> (63 - (prev_word & 63)));
+            while (!summary_bits) {
+                if (!summary_word) return NONE;
+                summary_bits = summary_[--summary_word];
+            }
+            const auto found_word = (summary_word << 6) + 63 - __builtin_clzll(summary_bits);
+            return (found_word << 6) + 63 - __builtin_clzll(words_[found_word]);
+        }
+    };
+
+    /// Every live price level of one side, any number and at any distance from each other: a PriceLadder window for
+    /// the levels around the touch, an ordered map for the ones outside it. recentre() moves the window when the
+    /// touch has left it, so the map only ever holds far-away levels and the usual order costs no allocation.
+    /// T needs a price_ member.
+    template<typename T, size_t NUM_SLOTS>
+    class PriceLevelIndex final {
+    public:
+        PriceLevelIndex() = default;
+
+        auto size() const noexcept { return ladder_.size() + overflow_.size(); }
+        auto empty() const noexcept { return ladder_.empty() && overflow_.empty(); }
+        auto overflowSize() const noexcept { return overflow_.size(); }
+
+        // Forgets every level, for a book cleared with its levels returned to their pool.
+        auto clear() noexcept {
+            ladder_.clear();
+            overflow_.clear();
+        }
+
+        auto at(int64_t price) const noexcept -> T* {
+            if (LIKELY(ladder_.contains(price))) return ladder_.at(price);
+            const auto itr = overflow_.find(price);
+            return (itr == overflow_.end() ? nullptr : itr->second);
+        }
+
+        auto insert(int64_t price, T* value) noexcept {
+            if (UNLIKELY(empty())) ladder_.rebase(price - static_cast<int64_t>(NUM_SLOTS / 2));
+            if (LIKELY(ladder_.contains(price))) {
+                ladder_.insert(price, value);
+            } else {
+                overflow_.emplace(price, value);
+            }
+        }
+
+        auto erase(int64_t price) noexcept {
+            if (LIKELY(ladder_.contains(price))) {
+                ladder_.erase(price);
+            } else {
+                overflow_.erase(price);
+            }
+        }
+
+        // Live level with the lowest price above price, nullptr if there is none.
+        auto higher(int64_t price) const noexcept -> T* {
+            const auto from_ladder = ladder_.higher(price);
+            if (LIKELY(overflow_.empty())) return from_ladder;
+            const auto itr = overflow_.upper_bound(price);
+            if (itr == overflow_.end()) return from_ladder;
+            return (!from_ladder || itr->first < from_ladder->price_ ? itr->second : from_ladder);
+        }
+
+        // Live level with the highest price below price, nullptr if there is none.
+        auto lower(int64_t price) const noexcept -> T* {
+            const auto from_ladder = ladder_.lower(price);
+            if (LIKELY(overflow_.empty())) return from_ladder;
+            auto itr = overflow_.lower_bound(price);
+            if (itr == overflow_.begin()) return from_ladder;
+            --itr;
+            return (!from_ladder || itr->first > from_ladder->price_ ? itr->second : from_ladder);
+        }
+
+        // Centres the window on price if price is outside it. Call with the best price after it changed.
+        auto recentre(int64_t price) noexcept {
+            if (LIKELY(ladder_.contains(price))) return;
+            for (auto level = ladder_.lowest(); level; level = ladder_.lowest()) {
+                overflow_.emplace(level->price_, level);
+                ladder_.erase(level->price_);
+            }
+            ladder_.rebase(price - static_cast<int64_t>(NUM_SLOTS / 2));
+            auto itr = overflow_.lower_bound(ladder_.base());
+            const auto window_end = overflow_.lower_bound(ladder_.base() + static_cast<int64_t>(NUM_SLOTS));
+            while (itr != window_end) {
+                ladder_.insert(itr->first, itr->second);
+                itr = overflow_.erase(itr);
+            }
+        }
+
+        PriceLevelIndex(const PriceLevelIndex&) = delete;
+        PriceLevelIndex(const PriceLevelIndex&&) = delete;
+        PriceLevelIndex& operator=(const PriceLevelIndex&) = delete;
+        PriceLevelIndex& operator=(const PriceLevelIndex&&) = delete;
+
+    private:
+        PriceLadder<T, NUM_SLOTS> ladder_;
+        std::map<int64_t, T*> overflow_; // only touched for levels outside the window
+    };
+}
@@ -0,0 +1,179 @@
+#include <map>
+#include <random>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include "price_ladder.h"
+#include "time_utils.h"
+
+// Positioning a new price level in one side of a deep book: MEOrderBook's walk over the circular list of levels
+// (best first) against the PriceLadder lookup of the next better level. Each round fills DEPTH levels of a bid side
+// in random order, then churns: remove a random level and add a random missing price. Both sides must end up with
+// the same sorted list.
+// Then checks PriceLevelIndex against a std::map over prices far wider than its window, recentring on the best bid
+// as the order books do.
+
+using namespace Common;
+
+struct BenchLevel { // the linkage of Exchange::MEOrdersAtPrice
+    int64_t price_ = 0;
+    BenchLevel* prev_entry_ = nullptr;
+    BenchLevel* next_entry_ = nullptr;
+};
+
+constexpr size_t LADDER_SLOTS = 4096;
+constexpr int64_t BASE_PRICE = 100 * 1000;
+constexpr size_t NUM_CHURN = 200 * 1000;
+
+class BidSide final {
+public:
+    BidSide(bool use_ladder) : use_ladder_(use_ladder), levels_(LADDER_SLOTS) {
+        ladder_.rebase(BASE_PRICE - static_cast<int64_t>(LADDER_SLOTS) + 1); // every bid price at or below BASE_PRICE
+        for (size_t i = 0; i < LADDER_SLOTS; ++i)
+            levels_[i].price_ = ladder_.base() + static_cast<int64_t>(i);
+    }
+
+    auto add(int64_t price) noexcept {
+        auto level = &levels_[static_cast<size_t>(price - ladder_.base())];
+        if (!best_) {
+            best_ = level;
+            level->prev_entry_ = level->next_entry_ = level;
+        } else if (use_ladder_) {
+            const auto better = ladder_.higher(price);
+            const auto target = (better ? better : best_->prev_entry_);
+            linkAfter(target, level);
+            if (!better) best_ = level;
+        } else { // bids are best (highest) first: walk to the first level priced below the new one
+            auto target = best_;
+            while (target->price_ > price && target->next_entry_ != best_)
+                target = target->next_entry_;
+            if (target->price_ > price) {
+                linkAfter(target, level); // new worst
+            } else {
+                linkAfter(target->prev_entry_, level);
+                if (target == best_) best_ = level;
+            }
+        }
+        ladder_.insert(price, level); // kept in both modes, it also tells which prices are live
+    }
+
+    auto remove(int64_t price) noexcept {
+        auto level = ladder_.at(price);
+        ladder_.erase(price);
+        if (level->next_entry_ == level) {
+            best_ = nullptr;
+        } else {
+            level->prev_entry_->next_entry_ = level->next_entry_;
+            level->next_entry_->prev_entry_ = level->prev_entry_;
+            if (level == best_) best_ = level->next_entry_;
+        }
+        level->prev_entry_ = level->next_entry_ = nullptr;
+    }
+
+    auto live(int64_t price) const noexcept { return ladder_.at(price) != nullptr; }
+
+    auto prices() const {
+        std::vector<int64_t> prices;
+        for (auto level = best_; level; level = (level->next_entry_ == best_ ? nullptr : level->next_entry_))
+            prices.push_back(level->price_);
+        return prices;
+    }
+
+private:
+    const bool use_ladder_;
+    std::vector<BenchLevel> levels_;
+    PriceLadder<BenchLevel, LADDER_SLOTS> ladder_;
+    BenchLevel* best_ = nullptr;
+
+    static auto linkAfter(BenchLevel* target, BenchLevel* level) noexcept -> void {
+        level->prev_entry_ = target;
+        level->next_entry_ = target->next_entry_;
+        target->next_entry_->prev_entry_ = level;
+        target->next_entry_ = level;
+    }
+};
+
+auto runBenchmark(bool use_ladder, size_t depth) {
+    BidSide side(use_ladder);
+    std::mt19937_64 rng(42);
+    const auto range = static_cast<int64_t>(depth * 2); // half the prices in the range live at any time
+    auto randomPrice = [&]() { return BASE_PRICE - static_cast<int64_t>(rng() % range); };
+
+    for (size_t added = 0; added < depth;) {
+        const auto price = randomPrice();
+        if (!side.live(price)) {
+            side.add(price);
+            ++added;
+        }
+    }
+
+    uint64_t add_ticks = 0;
+    for (size_t i = 0; i < NUM_CHURN; ++i) {
+        auto price = randomPrice();
+        while (!side.live(price)) price = randomPrice();
+        side.remove(price);
+        while (side.live(price)) price = randomPrice();
+        const auto start = rdtsc();
+        side.add(price);
+        add_ticks += rdtsc() - start;
+    }
+
+    const auto prices = side.prices();
+    ASSERT(prices.size() == depth && std::is_sorted(prices.rbegin(), prices.rend()), "bid levels not sorted best first");
+    return std::make_pair(static_cast<double>(add_ticks) * TscClock::instance().nsPerTick() / NUM_CHURN, prices);
+}
+
+auto checkLevelIndex() {
+    constexpr int64_t PRICE_RANGE = 20 * LADDER_SLOTS;
+    std::vector<BenchLevel> levels(PRICE_RANGE);
+    for (int64_t i = 0; i < PRICE_RANGE; ++i)
+        levels[static_cast<size_t>(i)].price_ = BASE_PRICE + i;
+
+    PriceLevelIndex<BenchLevel, LADDER_SLOTS> index;
+    std::map<int64_t, BenchLevel*> expected;
+    std::mt19937_64 rng(7);
+    for (size_t i = 0; i < NUM_CHURN; ++i) {
+        const auto price = BASE_PRICE + static_cast<int64_t>(rng() % PRICE_RANGE);
+        const auto itr = expected.find(price);
+        ASSERT(index.at(price) == (itr == expected.end() ? nullptr : itr->second), "wrong level at " + std::to_string(price));
+        if (itr != expected.end()) {
+            index.erase(price);
+            expected.erase(itr);
+        } else {
+            index.insert(price, &levels[static_cast<size_t>(price - BASE_PRICE)]);
+            expected[price] = &levels[static_cast<size_t>(price - BASE_PRICE)];
+        }
+        if (!expected.empty())
+            index.recentre(expected.rbegin()->first);
+
+        const auto probe = BASE_PRICE + static_cast<int64_t>(rng() % PRICE_RANGE);
+        const auto above = expected.upper_bound(probe);
+        const auto below = expected.lower_bound(probe);
+        ASSERT(index.higher(probe) == (above == expected.end() ? nullptr : above->second), "wrong level above " + std::to_string(probe));
+        ASSERT(index.lower(probe) == (below == expected.begin() ? nullptr : std::prev(below)->second), "wrong level below " + std::to_string(probe));
+        ASSERT(index.size() == expected.size(), "wrong level count");
+    }
+    std::cout << "level index: " << index.size() << " levels, " << index.overflowSize() << " outside the window, matches std::map" << std::endl;
+
+    // a CLEAR (snapshot recovery) returns every level to the pool, then the book is rebuilt around another price
+    index.clear();
+    ASSERT(index.empty() && !index.overflowSize(), "levels left after clear()");
+    for (int64_t price = BASE_PRICE; price < BASE_PRICE + PRICE_RANGE; price += 997)
+        ASSERT(!index.at(price) && !index.higher(price) && !index.lower(price), "cleared level still found near " + std::to_string(price));
+    auto &level = levels[static_cast<size_t>(PRICE_RANGE / 2)];
+    index.insert(level.price_, &level);
+    ASSERT(index.size() == 1 && index.at(level.price_) == &level && !index.higher(level.price_) && !index.lower(level.price_) &&
+           index.higher(BASE_PRICE) == &level && index.lower(BASE_PRICE + PRICE_RANGE) == &level, "wrong book after clear() and add");
+    std::cout << "level index: clear() then add leaves only the new level" << std::endl;
+}
+
+int main(int, char* []) {
+    for (const size_t depth : {10, 100, 500, 1000, 2000}) {
+        const auto [list_ns, list_prices] = runBenchmark(false, depth);
+        const auto [ladder_ns, ladder_prices] = runBenchmark(true, depth);
+        ASSERT(list_prices == ladder_prices, "list and ladder disagree on the book");
+        std::cout << "depth " << depth << " levels: list walk " << list_ns << " ns/add, ladder " << ladder_ns << " ns/add" << std::endl;
+    }
+    checkLevelIndex();
+    return 0;
+}
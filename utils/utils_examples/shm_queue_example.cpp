@@ -0,0 +1,73 @@
+#include <sys/wait.h>
+#include "shm_queue.h"
+
+struct MyStruct {
+    int d_[3];
+};
+
+using namespace Common;
+
+// Producer and consumer are separate processes sharing one /dev/shm ring.
+// The first consumer is SIGKILLed half way, so it never gets to release its pid slot: the producer has to
+// detect the dead peer from the pid alone. A second consumer is refused while the first one is alive, and the
+// restarted consumer takes over the dead slot and picks up from the read index left in the segment.
+auto consumeFunction(const std::string& name, size_t queue_size, int from, int to, bool hang) {
+    ShmLFQueue<MyStruct> sq(name, queue_size, ShmQueueRole::CONSUMER);
+    for (int expected = from; expected < to;) {
+        const auto elems = sq.getReadSpan(to - expected);
+        for (const auto& d : elems) {
+            if (UNLIKELY(d.d_[0] != expected)) FATAL("consumer read out of order elem: " + std::to_string(d.d_[0]));
+            ++expected;
+        }
+        if (!elems.empty())
+            sq.updateReadIndex(elems.size());
+    }
+    std::cout << "consumer pid " << getpid() << " read elems [" << from << ", " << to << ")" << std::endl;
+    while (hang)
+        pause();
+}
+
+int main(int, char* []) {
+    constexpr int num_elems = 1000 * 1000;
+    constexpr size_t queue_size = 1024;
+    const std::string name = "/shm_queue_example";
+    ShmLFQueue<MyStruct>::remove(name);
+
+    auto spawnConsumer = [&](int from, int to, bool hang) {
+        const auto pid = fork();
+        ASSERT(pid >= 0, "fork() failed");
+        if (pid == 0) {
+            consumeFunction(name, queue_size, from, to, hang);
+            _exit(0);
+        }
+        return pid;
+    };
+
+    ShmLFQueue<MyStruct> sq(name, queue_size, ShmQueueRole::PRODUCER);
+    auto consumer_pid = spawnConsumer(0, num_elems / 2, true);
+    for (auto i = 0; i < num_elems; i++) {
+        if (i == num_elems / 2) {
+            while (sq.size())
+                std::this_thread::yield();
+            ASSERT(sq.isPeerAlive(), "consumer reported dead while still running");
+
+            // a second consumer must not be able to claim the slot of a live one
+            int status = 0;
+            waitpid(spawnConsumer(num_elems / 2, num_elems, false), &status, 0);
+            ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_FAILURE, "second live consumer was not refused");
+            std::cout << "second consumer refused while pid " << consumer_pid << " is alive" << std::endl;
+
+            kill(consumer_pid, SIGKILL);
+            waitpid(consumer_pid, nullptr, 0);
+            ASSERT(!sq.isPeerAlive(), "SIGKILLed consumer still reported alive");
+            std::cout << "consumer pid " << consumer_pid << " SIGKILLed, detected dead, restarting it" << std::endl;
+            consumer_pid = spawnConsumer(num_elems / 2, num_elems, false);
+        }
+        *(sq.getNextToWriteTo()) = MyStruct{i, i*10, i*100};
+        sq.updateWriteIndex();
+    }
+    waitpid(consumer_pid, nullptr, 0);
+    std::cout << "main exiting, elems left: " << sq.size() << std::endl;
+    ShmLFQueue<MyStruct>::remove(name);
+    return 0;
+}
@@ -100,7 +100,7 @@ namespace Common {
         std::string time_str; 
         const auto ip = t_ip.empty() ? getIfaceIP(iface) : t_ip; 
         logger.log("%:% %() % ip:% iface:% port:% is_udp:% is_blocking: % is_listening: % ttl:% SO_time:%\n", 
-            __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str), ip, iface, 
+            __FILE__, __LINE__, __FUNCTION__, Common::getTscTimestamp(), ip, iface, 
             port, is_udp, is_blocking, is_listening, ttl, needs_so_timestamp); 
         
         addrinfo hints{}; 
@@ -48,10 +48,10 @@ namespace Common {
                 memcpy(&time_kernel, CMSG_DATA(cmsg), sizeof(time_kernel)); 
                 kernel_time = time_kernel.tv_sec * NANOS_TO_SECS + time_kernel.tv_usec * NANOS_TO_MICROS;
             }
-            const auto user_time = getCurrentNanos(); 
+            const auto user_time = getTscNanos(); 
             logger_.log("%:% %() % read socket:% len:% utime:% ktime:% diff:%\n", 
                 __FILE__,__LINE__,__FUNCTION__,
-                Common::getCurrentTimeStr(&time_str_), fd_, next_rcv_valid_index_, 
+                Common::getTscTimestamp(), fd_, next_rcv_valid_index_, 
                 user_time, kernel_time, (user_time-kernel_time)); 
             recv_callback_(this, kernel_time);
 
@@ -59,6 +59,8 @@ namespace Common {
             // if (next_rcv_valid_index_ >= TCPBufferSize) {
             //     next_rcv_valid_index_ = 0;
             // }
+        } else if (n_rcv == 0 && io.iov_len) { // orderly shutdown by the peer
+            recv_disconnected_ = true; 
         }
 
         // Send data over a socket in chunks 
@@ -73,7 +75,7 @@ namespace Common {
                 break; 
             }
             logger_.log("%: % %() % send socket: % len:%\n", 
-                __FILE__,__LINE__,__FUNCTION__,Common::getCurrentTimeStr(&time_str_), fd_, n);
+                __FILE__,__LINE__,__FUNCTION__,Common::getTscTimestamp(), fd_, n);
             n_send -= n; // decrements n_send by number of bytes actually sent in this iteration
             ASSERT(n == n_send_this_msg, "Don't support partial send lengths yet."); 
         }
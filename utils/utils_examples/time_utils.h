@@ -3,6 +3,13 @@
 #include <chrono> 
 #include <ctime> 
 #include <string> 
+#include <atomic> 
+#include <ostream> 
+#include <tuple> 
+
+#include "macros.h"
+#include "perf_utils.h"
+#include "thread_utils.h"
 
 namespace Common {
     typedef int64_t Nanos; 
@@ -17,11 +24,164 @@ namespace Common {
             std::chrono::system_clock::now().time_since_epoch()).count();
     }
 
+    // inline auto& getCurrentTimeStr(std::string* time_str) {
+    //     const auto time = std::chrono::system_clock::to_time_t(
+    //         std::chrono::system_clock::now()); 
+    //     time_str->assign(ctime(&time)); 
+    //     if(!time_str->empty()) time_str->at(time_str->length()-1) = '\0'; 
+    //     return *time_str;
+    // }
+
+    /// Format current timestamp to a human readable string.
+    /// String formatting is inefficient.
     inline auto& getCurrentTimeStr(std::string* time_str) {
-        const auto time = std::chrono::system_clock::to_time_t(
-            std::chrono::system_clock::now()); 
-        time_str->assign(ctime(&time)); 
-        if(!time_str->empty()) time_str->at(time_str->length()-1) = '\0'; 
+        const auto clock = std::chrono::system_clock::now();
+        const auto time = std::chrono::system_clock::to_time_t(clock);
+
+        char nanos_str[24];
+        sprintf(nanos_str, "%.8s.%09ld", ctime(&time) + 11, std::chrono::duration_cast<std::chrono::nanoseconds>(clock.time_since_epoch()).count() % NANOS_TO_SECS);
+        time_str->assign(nanos_str);
         return *time_str;
     }
-}
\ No newline at end of file
+
+
+    /// Converts invariant-TSC ticks to epoch nanoseconds: base_ns + (tsc - base_tsc) * ns_per_tick.
+    /// Calibrated against system_clock on first use; startDriftCorrection() re-anchors it periodically
+    /// from a background thread. Readers go through a seqlock, so conversion never blocks.
+    class TscClock final {
+    public:
+        static auto instance() noexcept -> TscClock& {
+            static TscClock clock;
+            return clock;
+        }
+
+        auto toNanos(uint64_t tsc) const noexcept -> Nanos {
+            uint64_t seq, base_tsc;
+            Nanos base_ns;
+            double ns_per_tick;
+            do {
+                seq = seq_.load(std::memory_order_acquire);
+                base_tsc = base_tsc_.load(std::memory_order_relaxed);
+                base_ns = base_ns_.load(std::memory_order_relaxed);
+                ns_per_tick = ns_per_tick_.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+            } while (UNLIKELY((seq & 1) || seq != seq_.load(std::memory_order_relaxed)));
+            return base_ns + static_cast<Nanos>(static_cast<double>(static_cast<int64_t>(tsc - base_tsc)) * ns_per_tick);
+        }
+
+        auto now() const noexcept {
+            return toNanos(rdtsc());
+        }
+
+        auto nsPerTick() const noexcept {
+            return ns_per_tick_.load(std::memory_order_relaxed);
+        }
+
+        /// Re-anchors to system_clock every interval_ms, refining the tick rate over the whole span since calibration.
+        auto startDriftCorrection(int core_id, int interval_ms) noexcept {
+            if (drift_thread_) return;
+            drift_thread_ = createAndStartThread(core_id, "Common/TscClock", [this, interval_ms]() {
+                driftCorrectionLoop(interval_ms);
+            });
+            ASSERT(drift_thread_ != nullptr, "Failed to start TscClock drift correction thread.");
+            drift_thread_->detach();
+        }
+
+        TscClock(const TscClock&) = delete;
+        TscClock(const TscClock&&) = delete;
+        TscClock& operator=(const TscClock&) = delete;
+        TscClock& operator=(const TscClock&&) = delete;
+
+    private:
+        std::atomic<uint64_t> seq_ = {0};
+        std::atomic<uint64_t> base_tsc_ = {0};
+        std::atomic<Nanos> base_ns_ = {0};
+        std::atomic<double> ns_per_tick_ = {1.0};
+        uint64_t first_tsc_ = 0;
+        Nanos first_ns_ = 0;
+        std::thread* drift_thread_ = nullptr;
+
+        // Calibration blocks the first caller for this long, at startup
+        static constexpr Nanos CALIBRATION_NANOS = 10 * NANOS_TO_MILLIS;
+
+        TscClock() {
+            std::tie(first_tsc_, first_ns_) = samplePair();
+            auto [tsc, ns] = samplePair();
+            while (ns - first_ns_ < CALIBRATION_NANOS)
+                std::tie(tsc, ns) = samplePair();
+            reanchor(tsc, ns, static_cast<double>(ns - first_ns_) / static_cast<double>(tsc - first_tsc_));
+        }
+
+        // system_clock reading paired with the TSC at the middle of the tightest of a few attempts
+        static auto samplePair() noexcept -> std::pair<uint64_t, Nanos> {
+            uint64_t best_window = UINT64_MAX, best_tsc = 0;
+            Nanos best_ns = 0;
+            for (int i = 0; i < 5; ++i) {
+                const auto before = rdtsc();
+                const auto ns = getCurrentNanos();
+                const auto after = rdtsc();
+                if (after - before < best_window) {
+                    best_window = after - before;
+                    best_tsc = before + (after - before) / 2;
+                    best_ns = ns;
+                }
+            }
+            return {best_tsc, best_ns};
+        }
+
+        auto driftCorrectionLoop(int interval_ms) noexcept -> void {
+            while (true) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+                const auto [tsc, ns] = samplePair();
+                reanchor(tsc, ns, static_cast<double>(ns - first_ns_) / static_cast<double>(tsc - first_tsc_));
+            }
+        }
+
+        auto reanchor(uint64_t tsc, Nanos ns, double ns_per_tick) noexcept -> void {
+            seq_.fetch_add(1, std::memory_order_acq_rel);
+            base_tsc_.store(tsc, std::memory_order_relaxed);
+            base_ns_.store(ns, std::memory_order_relaxed);
+            ns_per_tick_.store(ns_per_tick, std::memory_order_relaxed);
+            seq_.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    /// Epoch nanoseconds from the TSC clock, a fraction of the cost of getCurrentNanos().
+    inline auto getTscNanos() noexcept {
+        return TscClock::instance().now();
+    }
+
+    /// Raw TSC reading that the Logger formats as a time of day (like getCurrentTimeStr()) on its own thread.
+    struct TscTimestamp {
+        uint64_t tsc_ = 0;
+    };
+
+    /// Raw TSC reading that the Logger formats as epoch nanoseconds on its own thread.
+    struct TscNanos {
+        uint64_t tsc_ = 0;
+    };
+
+    inline auto getTscTimestamp() noexcept {
+        return TscTimestamp{rdtsc()};
+    }
+
+    /// HH:MM:SS.nnnnnnnnn in local time, same layout as getCurrentTimeStr().
+    inline auto writeTimeOfDay(std::ostream& os, Nanos epoch_ns) {
+        const time_t secs = epoch_ns / NANOS_TO_SECS;
+        tm local_tm;
+        localtime_r(&secs, &local_tm);
+        char time_str[24];
+        snprintf(time_str, sizeof(time_str), "%02d:%02d:%02d.%09ld", local_tm.tm_hour, local_tm.tm_min, local_tm.tm_sec,
+                 static_cast<long>(epoch_ns % NANOS_TO_SECS));
+        os << time_str;
+    }
+
+    inline auto& operator<<(std::ostream& os, const TscTimestamp& timestamp) {
+        writeTimeOfDay(os, TscClock::instance().toNanos(timestamp.tsc_));
+        return os;
+    }
+
+    inline auto& operator<<(std::ostream& os, const TscNanos& nanos) {
+        return os << TscClock::instance().toNanos(nanos.tsc_);
+    }
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "trace.h"
+
+// Three threads stamp the hops of the same orders with known TSC offsets, as the trade engine, order gateway and order
+// server would. After stop() the file is stitched back and every order must come out whole with the expected spans.
+
+using namespace Common;
+
+constexpr uint64_t NUM_TRACES = 100 * 1000;
+
+int main(int, char* []) {
+    TraceCollector::instance().start("trace_example.bin", -1);
+
+    const auto base = rdtsc();
+    auto stampHops = [base](TraceHop first, TraceHop last) {
+        for (uint64_t seq = 0; seq < NUM_TRACES; ++seq) {
+            const auto trace_id = makeTraceId(1, seq);
+            for (auto hop = static_cast<uint8_t>(first); hop <= static_cast<uint8_t>(last); ++hop) // 100 ticks per hop
+                TraceCollector::instance().record(trace_id, static_cast<TraceHop>(hop), base + seq * 10000 + hop * 100);
+        }
+    };
+    std::vector<std::thread*> threads;
+    threads.push_back(createAndStartThread(-1, "trace_example/client", [&]() {
+        stampHops(TraceHop::T10_TradeEngine_LFQueue_write, TraceHop::T12_OrderGateway_TCP_write);
+    }));
+    threads.push_back(createAndStartThread(-1, "trace_example/exchange", [&]() {
+        stampHops(TraceHop::T1_OrderServer_TCP_read, TraceHop::T6t_OrderServer_TCP_write);
+    }));
+    threads.push_back(createAndStartThread(-1, "trace_example/response", [&]() {
+        stampHops(TraceHop::T7t_OrderGateway_TCP_read, TraceHop::T9t_TradeEngine_LFQueue_read);
+    }));
+    for (auto thread : threads) {
+        thread->join();
+        delete thread;
+    }
+
+    const auto start = rdtsc();
+    for (uint64_t i = 0; i < NUM_TRACES; ++i)
+        TTT_TRACE(T4_MatchingEngine_LFQueue_write, makeTraceId(2, i));
+    std::cout << "TTT_TRACE: " << static_cast<double>(rdtsc() - start) / NUM_TRACES << " ticks per call" << std::endl;
+    TraceCollector::instance().stop();
+
+    TraceStitcher stitcher(1.0); // report in ticks
+    const auto num_stamps = stitcher.load("trace_example.bin");
+    std::cout << num_stamps << " stamps, " << stitcher.numTraces() << " traces" << std::endl;
+    ASSERT(num_stamps == NUM_TRACES * (static_cast<size_t>(TraceHop::T9t_TradeEngine_LFQueue_read) + 2), "stamps lost");
+    ASSERT(stitcher.numTraces() == 2 * NUM_TRACES, "traces lost");
+
+    std::stringstream summary;
+    stitcher.writeSummary(summary);
+    std::cout << summary.str();
+    ASSERT(summary.str().find("T10_TradeEngine_LFQueue_write,T9t_TradeEngine_LFQueue_read,100000,1100,1100,1100,1100,1100\n") != std::string::npos,
+           "unexpected end-to-end span");
+    return 0;
+}
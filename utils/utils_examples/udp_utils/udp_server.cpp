@@ -65,7 +65,7 @@ namespace Common {
             if (event.events & EPOLLIN) {
                 // Receiver sockets
                 logger_.log("%:% %() % EPOLLIN socket:%\n", __FILE__,__LINE__,__FUNCTION__, 
-                    Common::getCurrentTimeStr(&time_str_), socket->fd_); 
+                    Common::getTscTimestamp(), socket->fd_); 
                 if (std::find(receive_sockets_.begin(), receive_sockets_.end(), socket) == receive_sockets_.end())
                     receive_sockets_.push_back(socket);  
             }
@@ -73,7 +73,7 @@ namespace Common {
             // Sender sockets
             if (event.events & EPOLLOUT) {
                 logger_.log("%:% %() % EPOLLOUT socket:%\n", __FILE__, __LINE__, __FUNCTION__,
-                            Common::getCurrentTimeStr(&time_str_), socket->fd_);
+                            Common::getTscTimestamp(), socket->fd_);
                 if (std::find(send_sockets_.begin(), send_sockets_.end(), socket) == send_sockets_.end())
                     send_sockets_.push_back(socket);
             }